@@ -0,0 +1,118 @@
+/*
+ * Copyright 2020 © Centre Interdisciplinaire de développement en Cartographie des Océans (CIDCO), Tous droits réservés
+ */
+
+#ifndef SOUNDING_HPP
+#define SOUNDING_HPP
+
+#include <cstdint>
+#include <Eigen/Dense>
+
+/*!
+ * \brief Sounding computed by the sonar in real time, such as a beam of a Kongsberg XYZ 88 datagram
+ *
+ * The sonar has already raytraced the beam and compensated roll and pitch: the sounding is a vector in the
+ * surface frame of the vessel, which is horizontal and oriented by the heading (x forward, y to starboard, z down).
+ * x and y are measured from the position reference point, since the sonar already added the horizontal offsets
+ * of its transducers. z is measured from the transmit transducer.
+ */
+class Sounding {
+public:
+
+    /**
+     * Creates a sounding
+     *
+     * @param microEpoch timestamp of the ping
+     * @param id beam id
+     * @param heading heading of the vessel at transmit time, in degrees, which orients the surface frame
+     * @param transducerDepth depth of the transmit transducer below the water line, from which the sonar raytraced (meters)
+     * @param alongTrack x, forward from the position reference point (meters)
+     * @param acrossTrack y, to starboard of the position reference point (meters)
+     * @param depth z, below the transmit transducer (meters)
+     * @param quality quality flag
+     * @param intensity intensity
+     */
+    Sounding(uint64_t microEpoch, long id, double heading, double transducerDepth, double alongTrack, double acrossTrack, double depth, uint32_t quality, int32_t intensity) :
+    timestamp(microEpoch),
+    id(id),
+    heading(heading),
+    transducerDepth(transducerDepth),
+    vector(alongTrack, acrossTrack, depth),
+    quality(quality),
+    intensity(intensity) {
+    }
+
+    /**Returns the timestamp of the ping*/
+    uint64_t getTimestamp() {
+        return timestamp;
+    }
+
+    /**Returns the beam id*/
+    long getId() {
+        return id;
+    }
+
+    /**Returns the heading at transmit time (degrees)*/
+    double getHeading() {
+        return heading;
+    }
+
+    /**Returns the depth of the transmit transducer below the water line (meters)*/
+    double getTransducerDepth() {
+        return transducerDepth;
+    }
+
+    /**Returns the sounding in the surface frame of the vessel (meters)*/
+    Eigen::Vector3d & getVector() {
+        return vector;
+    }
+
+    /**Returns the across track distance, positive to starboard (meters)*/
+    double getAcrossTrack() {
+        return vector(1);
+    }
+
+    /**Returns the quality flag*/
+    uint32_t getQuality() {
+        return quality;
+    }
+
+    /**Returns the intensity*/
+    int32_t getIntensity() {
+        return intensity;
+    }
+
+    /**Orders soundings by timestamp, then from port to starboard*/
+    static bool sortByTimestamp(Sounding & s1, Sounding & s2) {
+        if (s1.getTimestamp() != s2.getTimestamp()) {
+            return s1.getTimestamp() < s2.getTimestamp();
+        }
+
+        return s1.getAcrossTrack() < s2.getAcrossTrack();
+    }
+
+private:
+
+    /**Timestamp of the ping (micro-second)*/
+    uint64_t timestamp;
+
+    /**Beam id*/
+    long id;
+
+    /**Heading at transmit time (degrees)*/
+    double heading;
+
+    /**Depth of the transmit transducer below the water line (meters)*/
+    double transducerDepth;
+
+    /**Sounding in the surface frame of the vessel (meters)*/
+    Eigen::Vector3d vector;
+
+    /**Quality flag*/
+    uint32_t quality;
+
+    /**Intensity*/
+    int32_t intensity;
+};
+
+#endif /* SOUNDING_HPP */
@@ -0,0 +1,121 @@
+/*
+* Copyright 2020 © Centre Interdisciplinaire de développement en Cartographie des Océans (CIDCO), Tous droits réservés
+*/
+
+#ifndef SWATHBATCH_HPP
+#define SWATHBATCH_HPP
+
+#include <cstdint>
+#include <vector>
+
+/*!
+* \brief Beams of a single swath, stored column-wise
+*
+* Parsers keep one batch and refill it for every swath: once the columns have grown to the largest swath, decoding a swath no longer allocates.
+* Angles follow the processPing() conventions (degrees, beam angle NEGATIVE to port, tilt angle POSITIVE forward).
+*/
+class SwathBatch {
+public:
+
+    /**Creates an empty batch*/
+    SwathBatch() : timestamp(0), surfaceSoundSpeed(0) {
+    }
+
+    /**Destroys the batch*/
+    ~SwathBatch() {
+    }
+
+    /**
+    * Empties the batch, keeping its memory
+    *
+    * @param microEpoch timestamp of the swath
+    * @param sss surface sound speed
+    */
+    void clear(uint64_t microEpoch, double sss) {
+        timestamp = microEpoch;
+        surfaceSoundSpeed = sss;
+
+        ids.clear();
+        beamAngles.clear();
+        tiltAngles.clear();
+        twoWayTravelTimes.clear();
+        qualities.clear();
+        intensities.clear();
+    }
+
+    /**
+    * Makes room for a number of beams
+    *
+    * @param nbBeams the number of beams
+    */
+    void reserve(unsigned int nbBeams) {
+        ids.reserve(nbBeams);
+        beamAngles.reserve(nbBeams);
+        tiltAngles.reserve(nbBeams);
+        twoWayTravelTimes.reserve(nbBeams);
+        qualities.reserve(nbBeams);
+        intensities.reserve(nbBeams);
+    }
+
+    /**
+    * Appends a beam
+    *
+    * @param id beam id
+    * @param beamAngle beam angle in degrees
+    * @param tiltAngle tilt angle in degrees
+    * @param twoWayTravelTime two-way travel time in seconds
+    * @param quality quality flag
+    * @param intensity intensity
+    */
+    void add(long id, double beamAngle, double tiltAngle, double twoWayTravelTime, uint32_t quality, int32_t intensity) {
+        ids.push_back(id);
+        beamAngles.push_back(beamAngle);
+        tiltAngles.push_back(tiltAngle);
+        twoWayTravelTimes.push_back(twoWayTravelTime);
+        qualities.push_back(quality);
+        intensities.push_back(intensity);
+    }
+
+    /**Returns the number of beams*/
+    unsigned int size() {
+        return ids.size();
+    }
+
+    /**Returns the timestamp of the swath*/
+    uint64_t getTimestamp() {
+        return timestamp;
+    }
+
+    /**Returns the surface sound speed of the swath*/
+    double getSurfaceSoundSpeed() {
+        return surfaceSoundSpeed;
+    }
+
+    /**Beam ids*/
+    std::vector<long> ids;
+
+    /**Beam angles (degrees)*/
+    std::vector<double> beamAngles;
+
+    /**Tilt angles (degrees)*/
+    std::vector<double> tiltAngles;
+
+    /**Two-way travel times (seconds)*/
+    std::vector<double> twoWayTravelTimes;
+
+    /**Quality flags*/
+    std::vector<uint32_t> qualities;
+
+    /**Intensities*/
+    std::vector<int32_t> intensities;
+
+private:
+
+    /**Timestamp of the swath (micro-second)*/
+    uint64_t timestamp;
+
+    /**Surface sound speed*/
+    double surfaceSoundSpeed;
+};
+
+#endif /* SWATHBATCH_HPP */
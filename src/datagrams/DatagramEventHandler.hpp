@@ -11,11 +11,22 @@
 
 #include "../sidescan/SidescanPing.hpp"
 
+#include "../watercolumn/WaterColumnRecord.hpp"
+
+#include "../SwathBatch.hpp"
+
+#include "../utils/Arena.hpp"
+
 /*!
 * \brief Datagram event handler class
 * \author Guillaume Morissette
 *
 * Provides virtual methods to treat the sonar datagrams' contents
+*
+* Ownership of the objects passed by pointer (properties, sound velocity profiles, sidescan pings):
+* - Without an arena, they are heap-allocated and belong to the handler, which must delete them.
+* - With an arena attached (see setArena()), they are carved from the arena and belong to it. The handler must not delete them,
+*   and they stay valid until the arena is reset. Handlers that keep them past a reset must copy them.
 */
 class DatagramEventHandler{
 public:
@@ -38,7 +49,7 @@ public:
          * @param properties
          */
         virtual void processFileProperties(std::map<std::string,std::string> * properties){
-            delete properties;
+            if(!arena) delete properties;
         }
         
         /**
@@ -46,7 +57,7 @@ public:
          * @param properties
          */
         virtual void processChannelProperties(unsigned int channelNumber,std::string channelName,unsigned int channelType,std::map<std::string,std::string> * properties){
-            delete properties;
+            if(!arena) delete properties;
         }        
         
 	/**
@@ -90,16 +101,71 @@ public:
 	*/
 	virtual void processSwathStart(double surfaceSoundSpeed){};
 
+	/**
+	* Processes all the beams of a swath at once. Called after processSwathStart() by parsers that decode whole swaths
+	* By default, hands each beam to processPing()
+	*
+	* @param swath the beams of the swath. Only valid during the call
+	*/
+	virtual void processSwath(SwathBatch & swath){
+		for(unsigned int i=0;i<swath.size();i++){
+			processPing(swath.getTimestamp(),swath.ids[i],swath.beamAngles[i],swath.tiltAngles[i],swath.twoWayTravelTimes[i],swath.qualities[i],swath.intensities[i]);
+		}
+	};
+
+	/**
+	* Processes a sounding the sonar computed in real time, such as a beam of a Kongsberg XYZ 88 datagram
+	* The sounding is in the surface frame of the vessel: horizontal, oriented by the heading, x forward, y to starboard, z down
+	*
+	* @param microEpoch Timestamp of the ping
+	* @param id Beam id
+	* @param heading Heading of the vessel at transmit time (degrees), which orients the surface frame
+	* @param transducerDepth Depth of the transmit transducer below the water line (meters)
+	* @param alongTrack x from the position reference point (meters)
+	* @param acrossTrack y from the position reference point (meters)
+	* @param depth z below the transmit transducer (meters)
+	* @param quality Quality flag
+	* @param intensity Intensity flag
+	*/
+	virtual void processSounding(uint64_t microEpoch,long id,double heading,double transducerDepth,double alongTrack,double acrossTrack,double depth,uint32_t quality,int32_t intensity){};
+
 	/**
 	* Processes a sound velocity profile, from a SSP profiler or CTD profiler
 	* @param svp Sound velocity profile
 	*/
-	virtual void processSoundVelocityProfile(SoundVelocityProfile * svp){ delete svp;};
+	virtual void processSoundVelocityProfile(SoundVelocityProfile * svp){ if(!arena) delete svp;};
 
-        
-        
-        virtual void processSidescanData(SidescanPing * ping){}
-        
+        /**
+         * Processes a sidescan ping
+         * @param ping Sidescan ping
+         */
+        virtual void processSidescanData(SidescanPing * ping){ if(!arena) delete ping;}
+
+        /**
+         * Returns true if the handler processes water column records. Otherwise, the parsers seek past them without reading them
+         */
+        virtual bool wantsWaterColumn(){ return false;}
+
+        /**
+         * Processes a water column record. Called only if wantsWaterColumn() returns true
+         * @param record the record. Its samples are decoded when asked for, from the datagram: it is only valid during the call
+         */
+        virtual void processWaterColumn(WaterColumnRecord & record){}
+
+        /**
+         * Attaches an arena from which the parsers will carve the objects they emit. NULL detaches it
+         * The handler decides when to reset it, typically once the objects of a datagram (or of a whole file) have been consumed
+         * @param a the arena
+         */
+        void setArena(Arena * a){ arena = a;}
+
+        /**Returns the attached arena, or NULL if emitted objects are heap-allocated*/
+        Arena * getArena(){ return arena;}
+
+protected:
+
+        /**Arena owning the emitted objects, if any*/
+        Arena * arena = NULL;
 };
 
 
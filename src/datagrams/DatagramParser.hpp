@@ -6,7 +6,11 @@
 #define DATAGRAMPARSER_HPP
 
 #include <cstdint>
+#include <utility>
+#include <memory>
 #include "DatagramEventHandler.hpp"
+#include "../utils/InputStream.hpp"
+#include "../utils/Stats.hpp"
 
 /*!
 * \brief Datagram parser class
@@ -28,6 +32,7 @@ public:
 
 	/**
 	* Read a file and change the datagram parser depending on the information
+	* The file may be compressed with gzip or zstd (see InputStream)
 	*
 	* @param filename name of the file to read
 	*/
@@ -39,6 +44,34 @@ public:
 	virtual std::string getName(int tag){return "";};
 protected:
 
+	/**
+	* Builds an object to be passed to the processor: in the processor's arena if it has one, on the heap otherwise
+	*
+	* @param args the arguments passed to the constructor of T
+	*/
+	template<typename T, typename... Args>
+	T * create(Args&&... args){
+		Arena * arena = processor.getArena();
+
+		if(arena){
+			return arena->create<T>(std::forward<Args>(args)...);
+		}
+
+		return new T(std::forward<Args>(args)...);
+	}
+
+	/**
+	* Disposes of an object built with create() that ends up not being passed to the processor
+	*
+	* @param object the object
+	*/
+	template<typename T>
+	void discard(T * object){
+		if(!processor.getArena()){
+			delete object;
+		}
+	}
+
 	/**The datagram processor*/
 	DatagramEventHandler & processor;
 };
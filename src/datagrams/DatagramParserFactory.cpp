@@ -9,18 +9,29 @@
 
 /**
 * Creates the appropriate parser for the given file. Throws exception for unknown formats
+* Files compressed with gzip or zstd are recognized by their .gz or .zst suffix, as in line.all.gz
 * @param filename the name of the file
 */
 DatagramParser * DatagramParserFactory::build(std::string & fileName,DatagramEventHandler & handler){
         DatagramParser * parser;
 
-        if(StringUtils::ends_with_ci(fileName.c_str(),".all")){
+        //a compressed file keeps the extension of its format before its own
+        std::string name = fileName;
+
+        if(StringUtils::ends_with_ci(name.c_str(),".gz")){
+                name.resize(name.size()-3);
+        }
+        else if(StringUtils::ends_with_ci(name.c_str(),".zst")){
+                name.resize(name.size()-4);
+        }
+
+        if(StringUtils::ends_with_ci(name.c_str(),".all")){
                 parser = new KongsbergParser(handler);
         }
-        else if(StringUtils::ends_with_ci(fileName.c_str(),".xtf")){
+        else if(StringUtils::ends_with_ci(name.c_str(),".xtf")){
                 parser = new XtfParser(handler);
         }
-        else if(StringUtils::ends_with_ci(fileName.c_str(),".s7k")){
+        else if(StringUtils::ends_with_ci(name.c_str(),".s7k")){
                 parser = new S7kParser(handler);
         }
         else{
@@ -17,21 +17,31 @@ KongsbergParser::~KongsbergParser(){
 }
 
 void KongsbergParser::parse(std::string & filename, bool ignoreChecksum){
-  FILE * file = fopen(filename.c_str(),"rb");
+  STATS_STAGE(STATS_PARSING);
+
+  std::unique_ptr<InputStream> file(InputStream::open(filename));
 
   if(file){
-    while(!feof(file)){
+    while(!file->eof()){
       //Read datagramHeader
       KongsbergHeader hdr;
-      int elementsRead = fread (&hdr,sizeof(KongsbergHeader),1,file);
+      int elementsRead = file->read(&hdr,sizeof(KongsbergHeader),1);
 
       if(elementsRead == 1){
         //Check for starting character in datagram
         if(hdr.stx==STX){
+          if(hdr.type=='k' && !processor.wantsWaterColumn()){
+            //Nobody wants the water column, which is most of the file: skip it without reading it
+            processor.processDatagramTag(hdr.type);
+            STATS_DATAGRAM(*this,hdr.type);
+            file->skip(hdr.size-sizeof(KongsbergHeader)+sizeof(uint32_t));
+            continue;
+          }
+
           //Allocate memory for the datagram's content
           unsigned char * buffer = (unsigned char*)malloc(hdr.size-sizeof(KongsbergHeader)+sizeof(uint32_t));
 
-          elementsRead = fread(buffer,hdr.size-sizeof(KongsbergHeader)+sizeof(uint32_t),1,file);
+          elementsRead = file->read(buffer,hdr.size-sizeof(KongsbergHeader)+sizeof(uint32_t),1);
 
           processDatagram(hdr,buffer);
 
@@ -44,8 +54,6 @@ void KongsbergParser::parse(std::string & filename, bool ignoreChecksum){
         }
       }
     }
-
-    fclose(file);
   }
   else{
     throw new Exception("Couldn't open file " + filename);
@@ -201,6 +209,7 @@ void KongsbergParser::processDatagram(KongsbergHeader & hdr,unsigned char * data
   */
 
   processor.processDatagramTag(hdr.type);
+  STATS_DATAGRAM(*this,hdr.type);
 
   switch(hdr.type){
     case 'A':
@@ -236,6 +245,14 @@ void KongsbergParser::processDatagram(KongsbergHeader & hdr,unsigned char * data
     processSoundSpeedProfile(hdr,datagram);
     break;
 
+    case 'X':
+    processXYZ88(hdr,datagram);
+    break;
+
+    case 'k':
+    processWaterColumn(hdr,datagram);
+    break;
+
     case 'Y':
     //processSeabedImageData(hdr,datagram);
     break;
@@ -276,7 +293,7 @@ void KongsbergParser::processAttitudeDatagram(KongsbergHeader & hdr,unsigned cha
 }
 
 void KongsbergParser::processSoundSpeedProfile(KongsbergHeader & hdr,unsigned char * datagram){
-  SoundVelocityProfile * svp = new SoundVelocityProfile();
+  SoundVelocityProfile * svp = create<SoundVelocityProfile>();
   uint64_t microEpoch = convertTime(hdr.date,hdr.time);
 
   KongsbergSoundSpeedProfile * ssp = (KongsbergSoundSpeedProfile*) datagram;
@@ -319,21 +336,22 @@ void KongsbergParser::processPositionDatagram(KongsbergHeader & hdr,unsigned cha
   double longitude = (double)p->longitude/(double)LON_FACTOR;
   double latitude  = (double)p->lattitude/(double)LAT_FACTOR;
 
-  std::string inputDatagram(p->inputDatagram);
+  NmeaSentence inputDatagram(p->inputDatagram, p->inputDatagramBytes);
+  NmeaGGK ggk;
+  NmeaGGA gga;
 
   double height = std::numeric_limits<double>::quiet_NaN();
 
   //Extract ellipsoidal height from input datagram
-  if(inputDatagram.find("GGK") != std::string::npos){
-    height = NmeaUtils::extractHeightFromGGK(inputDatagram);
-
+  if(NmeaUtils::extractGGK(inputDatagram, ggk)){
+    height = ggk.ellipsoidalHeight;
   }
-  else if(inputDatagram.find("GGA") != std::string::npos){
-    height = NmeaUtils::extractHeightFromGGA(inputDatagram);
+  else if(NmeaUtils::extractGGA(inputDatagram, gga)){
+    height = gga.orthometricHeight + gga.geoidSeparation;
   }
   else{
     //NO POSITION, whine about this
-    std::cerr << "No ellipsoidal height found in input datagram: " << inputDatagram << std::endl;
+    std::cerr << "No ellipsoidal height found in input datagram: " << p->inputDatagram << std::endl;
   }
 
   if(!std::isnan(height)){
@@ -353,24 +371,75 @@ void KongsbergParser::processRawRangeAndBeam78(KongsbergHeader & hdr,unsigned ch
   KongsbergRangeAndBeam78 * data = (KongsbergRangeAndBeam78*)datagram;
 
   uint64_t microEpoch = convertTime(hdr.date,hdr.time);
+  double surfaceSoundSpeed = (double)data->surfaceSoundSpeed / (double)10;
 
-  processor.processSwathStart((double)data->surfaceSoundSpeed / (double)10);
+  processor.processSwathStart(surfaceSoundSpeed);
 
-  std::map<int,KongsbergRangeAndBeam78TxEntry*>  txEntries;
+  //Sector numbers fit in a byte, so tilt angles are looked up in a flat table. NaN marks a missing sector
+  double tiltAngles[256];
+  std::fill(tiltAngles,tiltAngles+256,std::numeric_limits<double>::quiet_NaN());
 
   KongsbergRangeAndBeam78TxEntry* tx = (KongsbergRangeAndBeam78TxEntry*) (((unsigned char *)data)+sizeof(KongsbergRangeAndBeam78));
 
   for(unsigned int i=0;i< data->nbTxPackets; i++){
-    txEntries[tx[i].txSectorNumber] = &tx[i];
-    //printf("Tilt: %0.2f\n",(double)tx[i].tiltAngle/(double)100);
+    tiltAngles[tx[i].txSectorNumber] = (double)tx[i].tiltAngle/(double)100;
   }
 
   KongsbergRangeAndBeam78RxEntry * rx = (KongsbergRangeAndBeam78RxEntry*)    ((((unsigned char *)data)+sizeof(KongsbergRangeAndBeam78)) + (data->nbTxPackets * sizeof(KongsbergRangeAndBeam78TxEntry)));
 
+  swath.clear(microEpoch,surfaceSoundSpeed);
+  swath.reserve(data->nbRxPackets);
+
   for(unsigned int i=0;i<data->nbRxPackets;i++){
+    double tiltAngle = tiltAngles[rx[i].txSectorNumber];
+
+    if(std::isnan(tiltAngle)){
+      //beam refers to a sector that isn't in the datagram
+      continue;
+    }
+
     //We'll hack-in the the beam angle as ID...Hail Satan!
-    processor.processPing(microEpoch,rx[i].beamAngle,(double)rx[i].beamAngle/(double)100,(double)txEntries[rx[i].txSectorNumber]->tiltAngle/(double)100,rx[i].twoWayTravelTime,rx[i].qualityFactor,rx[i].reflectivity * 0.5);
+    //Kongsberg beam angles are positive to port, pings are positive to starboard
+    swath.add(rx[i].beamAngle,-(double)rx[i].beamAngle/(double)100,tiltAngle,rx[i].twoWayTravelTime,rx[i].qualityFactor,rx[i].reflectivity * 0.5);
   }
+
+  processor.processSwath(swath);
+}
+
+void KongsbergParser::processXYZ88(KongsbergHeader & hdr,unsigned char * datagram){
+  KongsbergXYZ88 * data = (KongsbergXYZ88*)datagram;
+
+  uint64_t microEpoch = convertTime(hdr.date,hdr.time);
+  double heading = (double)data->heading/(double)100;
+  double transducerDepth = data->transducerDepth;
+
+  KongsbergXYZ88Entry * beams = (KongsbergXYZ88Entry*)(((unsigned char *)data)+sizeof(KongsbergXYZ88));
+
+  for(unsigned int i=0;i<data->nbBeams;i++){
+    if(beams[i].detectionInfo & 0x80){
+      //invalid detection
+      continue;
+    }
+
+    //same intensity scale as the raw range and beam 78 datagram
+    processor.processSounding(microEpoch,i,heading,transducerDepth,beams[i].alongTrack,beams[i].acrossTrack,beams[i].depth,beams[i].qualityFactor,beams[i].reflectivity * 0.5);
+  }
+}
+
+void KongsbergParser::processWaterColumn(KongsbergHeader & hdr,unsigned char * datagram){
+  //datagram content, without the header, the ETX and the checksum
+  unsigned int headerSize = sizeof(KongsbergHeader)-sizeof(uint32_t);
+  unsigned int trailerSize = sizeof(uint8_t)+sizeof(uint16_t);
+
+  if(hdr.size < headerSize+sizeof(KongsbergWaterColumn)+trailerSize){
+    return;
+  }
+
+  unsigned int length = hdr.size-headerSize-trailerSize;
+
+  waterColumn.wrap(convertTime(hdr.date,hdr.time),hdr.counter,datagram,length);
+
+  processor.processWaterColumn(waterColumn);
 }
 
 #endif
\ No newline at end of file
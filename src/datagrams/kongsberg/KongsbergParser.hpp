@@ -11,12 +11,16 @@
 #include <iostream>
 #include <cmath>
 #include <map>
+#include <limits>
+#include <algorithm>
 
 #include "../DatagramParser.hpp"
 #include "../../utils/NmeaUtils.hpp"
 #include "../../utils/TimeUtils.hpp"
 #include "../../utils/Exception.hpp"
 #include "KongsbergTypes.hpp"
+#include "../../SwathBatch.hpp"
+#include "KongsbergWaterColumnRecord.hpp"
 
 /*!
 * \brief Kongsberg parser class extention of Datagram parser class
@@ -120,6 +124,22 @@ protected:
   */
   void processRawRangeAndBeam78(KongsbergHeader & hdr,unsigned char * datagram);
 
+  /**
+  * Processes the soundings of an XYZ 88 datagram, already raytraced by the sonar
+  *
+  * @param hdr the Kongsberg header
+  * @param datagram the datagram
+  */
+  void processXYZ88(KongsbergHeader & hdr,unsigned char * datagram);
+
+  /**
+  * Processes a water column datagram
+  *
+  * @param hdr the Kongsberg header
+  * @param datagram the datagram
+  */
+  void processWaterColumn(KongsbergHeader & hdr,unsigned char * datagram);
+
   /**
   * Returns the timestamp in microsecond
   *
@@ -128,6 +148,12 @@ protected:
   */
   uint64_t convertTime(uint32_t datagramDate,uint32_t datagramTime);
 
+  /**Beams of the swath being decoded, reused from one swath to the next*/
+  SwathBatch swath;
+
+  /**View of the water column datagram being decoded, reused from one datagram to the next*/
+  KongsbergWaterColumnRecord waterColumn;
+
   /**
   * Returns a human readable name for a given datagram tag
   */
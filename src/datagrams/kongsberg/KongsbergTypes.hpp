@@ -114,5 +114,70 @@ typedef struct{
 #pragma pack()
 
 
+#pragma pack(1)
+typedef struct{
+    uint16_t		heading; //in 0.01 degrees
+    uint16_t		soundSpeed; //at the transducer, in dm/s
+    float		transducerDepth; //transmit transducer depth re water level, in meters
+    uint16_t		nbBeams;
+    uint16_t		nbValidDetections;
+    float		samplingFrequency; //in Hz
+    uint8_t		scanningInfo;
+    uint8_t		spare[3];
+} KongsbergXYZ88;
+#pragma pack()
+
+#pragma pack(1)
+typedef struct{
+    float		depth; //z, from the transmit transducer, in meters
+    float		acrossTrack; //y, in meters
+    float		alongTrack; //x, in meters
+    uint16_t		detectionWindowLength; //in samples
+    uint8_t		qualityFactor;
+    int8_t		incidenceAngleAdjustment; //in 0.1 degrees
+    uint8_t		detectionInfo; //bit 7 set for an invalid detection
+    int8_t		realTimeCleaningInfo;
+    int16_t		reflectivity; //in 0.1 dB
+} KongsbergXYZ88Entry;
+#pragma pack()
+
+#pragma pack(1)
+typedef struct{
+    uint16_t		nbDatagrams; //datagrams of the ping
+    uint16_t		datagramNumber; //1 to nbDatagrams
+    uint16_t		nbTxSectors;
+    uint16_t		totalNbBeams; //beams of the ping
+    uint16_t		nbBeams; //beams in this datagram
+    uint16_t		soundSpeed; //in dm/s
+    uint32_t		samplingFrequency; //in 0.01 Hz
+    int16_t		txTimeHeave; //in cm
+    uint8_t		tvgFunction;
+    int8_t		tvgOffset; //in dB
+    uint8_t		scanningInfo;
+    uint8_t		spare[3];
+} KongsbergWaterColumn;
+#pragma pack()
+
+#pragma pack(1)
+typedef struct{
+    int16_t		tiltAngle; //in 0.01 degrees
+    uint16_t		centreFrequency; //in 10 Hz
+    uint8_t		txSectorNumber;
+    uint8_t		spare;
+} KongsbergWaterColumnTxEntry;
+#pragma pack()
+
+#pragma pack(1)
+typedef struct{
+    int16_t		beamAngle; //in 0.01 degrees
+    uint16_t		startRangeSampleNumber;
+    uint16_t		nbSamples;
+    uint16_t		detectedRange; //in samples
+    uint8_t		txSectorNumber;
+    uint8_t		beamNumber;
+    //followed by nbSamples amplitudes, int8_t in 0.5 dB
+} KongsbergWaterColumnRxEntry;
+#pragma pack()
+
 
 #endif // KONGSBERGTYPES_HPP
@@ -0,0 +1,152 @@
+/*
+* Copyright 2020 © Centre Interdisciplinaire de développement en Cartographie des Océans (CIDCO), Tous droits réservés
+*/
+
+#ifndef KONGSBERGWATERCOLUMNRECORD_HPP
+#define KONGSBERGWATERCOLUMNRECORD_HPP
+
+#include <cstdint>
+#include <vector>
+#include "KongsbergTypes.hpp"
+#include "../../watercolumn/WaterColumnRecord.hpp"
+
+/*!
+* \brief View of a Kongsberg water column datagram ('k')
+*
+* A ping is split over several datagrams, each one a record with some of the beams. The beams follow each other
+* with their samples: wrapping a datagram hops over the beam headers to locate them, without reading the samples.
+* The parser keeps one record and wraps every datagram with it: once its index has grown to the largest
+* datagram, viewing a datagram no longer allocates.
+*/
+class KongsbergWaterColumnRecord : public WaterColumnRecord {
+public:
+
+    /**Creates a record viewing nothing*/
+    KongsbergWaterColumnRecord() : header(NULL), tx(NULL), end(NULL) {
+    }
+
+    /**
+    * Views a water column datagram, decodes its header and locates its beams
+    *
+    * @param microEpoch timestamp of the ping
+    * @param counter ping counter of the datagram header
+    * @param datagram the datagram, after the Kongsberg header
+    * @param length number of bytes of the datagram
+    */
+    void wrap(uint64_t microEpoch, uint16_t counter, unsigned char * datagram, unsigned int length) {
+        header = (KongsbergWaterColumn *) datagram;
+        tx = (KongsbergWaterColumnTxEntry *) (datagram + sizeof (KongsbergWaterColumn));
+        end = datagram + length;
+
+        timestamp = microEpoch;
+        pingNumber = counter;
+        nbBeams = header->nbBeams;
+        soundSpeed = (double) header->soundSpeed / (double) 10;
+        samplingFrequency = (double) header->samplingFrequency / (double) 100;
+
+        index();
+    }
+
+    /**Returns the number of datagrams of the ping*/
+    unsigned int getNumberOfDatagrams() {
+        return header->nbDatagrams;
+    }
+
+    /**Returns the number of this datagram in the ping, from 1*/
+    unsigned int getDatagramNumber() {
+        return header->datagramNumber;
+    }
+
+    /**Returns the number of beams of the ping, over all its datagrams*/
+    unsigned int getTotalNumberOfBeams() {
+        return header->totalNbBeams;
+    }
+
+    /**Returns the beam number of a beam in the ping*/
+    unsigned int getBeamNumber(unsigned int beam) {
+        return getBeam(beam)->beamNumber;
+    }
+
+    double getBeamAngle(unsigned int beam) {
+        return (double) getBeam(beam)->beamAngle / (double) 100;
+    }
+
+    /**Returns the tilt angle of the sector of a beam (degrees), NaN if the sector is not in the datagram*/
+    double getTiltAngle(unsigned int beam) {
+        uint8_t sector = getBeam(beam)->txSectorNumber;
+
+        for (unsigned int i = 0; i < header->nbTxSectors; i++) {
+            if (tx[i].txSectorNumber == sector) {
+                return (double) tx[i].tiltAngle / (double) 100;
+            }
+        }
+
+        return std::numeric_limits<double>::quiet_NaN();
+    }
+
+    /**Returns the detected range of a beam in samples, 0 if there is no detection*/
+    unsigned int getDetectedRange(unsigned int beam) {
+        return getBeam(beam)->detectedRange;
+    }
+
+    unsigned int getFirstSample(unsigned int beam) {
+        return getBeam(beam)->startRangeSampleNumber;
+    }
+
+    unsigned int getNumberOfSamples(unsigned int beam) {
+        return getBeam(beam)->nbSamples;
+    }
+
+    /**Decodes the samples of a beam, in dB*/
+    void getAmplitudes(unsigned int beam, std::vector<float> & amplitudes) {
+        KongsbergWaterColumnRxEntry * rx = getBeam(beam);
+        int8_t * samples = (int8_t *) (rx + 1);
+
+        amplitudes.resize(rx->nbSamples);
+
+        for (unsigned int i = 0; i < rx->nbSamples; i++) {
+            amplitudes[i] = samples[i] * 0.5f;
+        }
+    }
+
+private:
+
+    /**Returns the header of a beam*/
+    KongsbergWaterColumnRxEntry * getBeam(unsigned int beam) {
+        return beams[beam];
+    }
+
+    /**Locates the beams, dropping those that run past the end of the datagram*/
+    void index() {
+        beams.clear();
+
+        unsigned char * p = (unsigned char *) (tx + header->nbTxSectors);
+
+        for (unsigned int i = 0; i < header->nbBeams && p + sizeof (KongsbergWaterColumnRxEntry) <= end; i++) {
+            KongsbergWaterColumnRxEntry * rx = (KongsbergWaterColumnRxEntry *) p;
+            p += sizeof (KongsbergWaterColumnRxEntry) + rx->nbSamples;
+
+            if (p > end) {
+                break;
+            }
+
+            beams.push_back(rx);
+        }
+
+        nbBeams = beams.size();
+    }
+
+    /**Header of the datagram*/
+    KongsbergWaterColumn * header;
+
+    /**Transmit sectors*/
+    KongsbergWaterColumnTxEntry * tx;
+
+    /**End of the datagram*/
+    unsigned char * end;
+
+    /**Header of each beam*/
+    std::vector<KongsbergWaterColumnRxEntry *> beams;
+};
+
+#endif /* KONGSBERGWATERCOLUMNRECORD_HPP */
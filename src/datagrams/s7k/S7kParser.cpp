@@ -18,15 +18,17 @@ S7kParser::~S7kParser() {
 }
 
 void S7kParser::parse(std::string & filename, bool ignoreChecksum) {
-    FILE * file = fopen(filename.c_str(), "rb");
+    STATS_STAGE(STATS_PARSING);
+
+    std::unique_ptr<InputStream> file(InputStream::open(filename));
 
     if (file) {
         S7kDataRecordFrame drf;
 
-        while (!feof(file)) {
+        while (!file->eof()) {
 
             //Read the DRF
-            int nbItemsRead = fread(&drf, sizeof (S7kDataRecordFrame), 1, file);
+            int nbItemsRead = file->read(&drf, sizeof (S7kDataRecordFrame), 1);
 
             //Check that we read the required amount of data
             if (nbItemsRead == 1) {
@@ -36,10 +38,19 @@ void S7kParser::parse(std::string & filename, bool ignoreChecksum) {
                     processDataRecordFrame(drf);
 
                     int dataSectionSize = drf.Size - sizeof (S7kDataRecordFrame); // includes checksum
+
+                    if ((drf.RecordTypeIdentifier == 7018 || drf.RecordTypeIdentifier == 7042) && !processor.wantsWaterColumn()) {
+                        //Nobody wants the water column, which is most of the file: skip it without reading it
+                        processor.processDatagramTag(drf.RecordTypeIdentifier);
+                        STATS_DATAGRAM(*this, drf.RecordTypeIdentifier);
+                        file->skip(dataSectionSize);
+                        continue;
+                    }
+
                     unsigned char * data = (unsigned char*) malloc(dataSectionSize);
 
                     //Now read in the data section and the checksum
-                    nbItemsRead = fread(data, dataSectionSize, 1, file);
+                    nbItemsRead = file->read(data, dataSectionSize, 1);
 
                     //We can haz data
                     if (nbItemsRead == 1) {
@@ -50,6 +61,7 @@ void S7kParser::parse(std::string & filename, bool ignoreChecksum) {
 
                         if (ignoreChecksum || checksum == computedChecksum) {
                             processor.processDatagramTag(drf.RecordTypeIdentifier);
+                            STATS_DATAGRAM(*this, drf.RecordTypeIdentifier);
 
                             //Process data according to record type
                             if (drf.RecordTypeIdentifier == 1016) {
@@ -73,6 +85,12 @@ void S7kParser::parse(std::string & filename, bool ignoreChecksum) {
                             } else if (drf.RecordTypeIdentifier == 1010) {
                                 //CTD
                                 processCtdDatagram(drf, data);
+                            } else if (drf.RecordTypeIdentifier == 7018) {
+                                //Beamformed water column
+                                processBeamformedDatagram(drf, data, dataSectionSize - sizeof (uint32_t));
+                            } else if (drf.RecordTypeIdentifier == 7042) {
+                                //Compressed water column
+                                processCompressedWaterColumnDatagram(drf, data, dataSectionSize - sizeof (uint32_t));
                             }
                             //TODO: process other stuff
 
@@ -99,6 +117,8 @@ void S7kParser::parse(std::string & filename, bool ignoreChecksum) {
             //zero bytes means EOF. Nothing to do
         }
 
+        file.reset();
+
         if (foundAttitudePackets1012and1013) {
             //Sort and interpolate attitudes form 1012 and 1013 packets
             process1012and1013Attiudes();
@@ -457,10 +477,38 @@ void S7kParser::processPitchRollDatagram(S7kDataRecordFrame & drf, unsigned char
 void S7kParser::processSonarSettingsDatagram(S7kDataRecordFrame & drf, unsigned char * data) {
     S7kSonarSettings * settings = (S7kSonarSettings*) data;
 
-    S7kSonarSettings * settingsCopy = (S7kSonarSettings *) malloc(sizeof (S7kSonarSettings));
-    memcpy(settingsCopy, settings, sizeof (S7kSonarSettings));
+    pingSettings.add(*settings, S7kSonarSettingsTable::getDevice(drf));
+}
+
+void S7kParser::processBeamformedDatagram(S7kDataRecordFrame & drf, unsigned char * data, unsigned int length) {
+    if (length < sizeof (S7kBeamformedRTH)) {
+        return;
+    }
+
+    //the sonar settings of the ping give the sampling rate and the sound speed
+    double sampleRate = std::numeric_limits<double>::quiet_NaN();
+    double soundVelocity = std::numeric_limits<double>::quiet_NaN();
+
+    S7kSonarSettings * settings = pingSettings.find(((S7kBeamformedRTH *) data)->pingNumber, S7kSonarSettingsTable::getDevice(drf));
+
+    if (settings) {
+        sampleRate = settings->sampleRate;
+        soundVelocity = settings->soundVelocity;
+    }
+
+    beamformed.wrap(extractMicroEpoch(drf), data, length, sampleRate, soundVelocity);
+
+    processor.processWaterColumn(beamformed);
+}
+
+void S7kParser::processCompressedWaterColumnDatagram(S7kDataRecordFrame & drf, unsigned char * data, unsigned int length) {
+    if (length < sizeof (S7kCompressedWaterColumnRTH)) {
+        return;
+    }
+
+    compressedWaterColumn.wrap(extractMicroEpoch(drf), data, length);
 
-    pingSettings.push_back(settingsCopy);
+    processor.processWaterColumn(compressedWaterColumn);
 }
 
 void S7kParser::processPositionDatagram(S7kDataRecordFrame & drf, unsigned char * data) {
@@ -483,15 +531,7 @@ void S7kParser::processPingDatagram(S7kDataRecordFrame & drf, unsigned char * da
     double tiltAngle = swath->transmissionAngle*R2D;
     double samplingRate = swath->samplingRate;
 
-    S7kSonarSettings * settings = NULL;
-
-    for (auto i = pingSettings.begin(); i != pingSettings.end(); i++) {
-        if ((*i)->sequentialNumber == swath->pingNumber) {
-            settings = (*i);
-            pingSettings.remove((*i));
-            break;
-        }
-    }
+    S7kSonarSettings * settings = pingSettings.find(swath->pingNumber, S7kSonarSettingsTable::getDevice(drf));
 
     if (settings) {
         double surfaceSoundVelocity = settings->soundVelocity;
@@ -504,35 +544,31 @@ void S7kParser::processPingDatagram(S7kDataRecordFrame & drf, unsigned char * da
             double intensity = swath->dataFieldSize > 22 ? ping->signalStrength : 0;
             processor.processPing(microEpoch, (long) ping->beamDescriptor, (double) ping->receptionAngle*R2D, tiltAngle, twoWayTravelTime, ping->quality, intensity);
         }
-
-        free(settings);
     } else {
         fprintf(stderr, "No settings for ping #%d\n", swath->pingNumber);
     }
 }
 
 void S7kParser::process1012and1013Attiudes() {
-    std::sort(headingV.begin(), headingV.end(), &Attitude::sortByTimestamp);
-    std::sort(pitchRollV.begin(), pitchRollV.end(), &Attitude::sortByTimestamp);
-
+    headingV.sort();
+    TimestampSort::sort(pitchRollV);
 
-    unsigned int headingIndex = 0;
 
     for (auto pitchRoll = pitchRollV.begin(); pitchRoll != pitchRollV.end(); pitchRoll++) {
+        Attitude * beforeHeading;
+        Attitude * afterHeading;
 
-        while (headingIndex + 1 < headingV.size() && headingV[headingIndex + 1].getTimestamp() < (*pitchRoll).getTimestamp()) {
-            headingIndex++;
-        }
+        if (!headingV.getBracket((*pitchRoll).getTimestamp(), beforeHeading, afterHeading)) {
+            //No more headings available
+            if (headingV.size() < 2 || (*pitchRoll).getTimestamp() > headingV.getTimestamp(headingV.size() - 1)) {
+                break;
+            }
 
-        //No more headings available
-        if (headingIndex >= headingV.size() - 1) {
-            break;
+            //No heading before this pitch and roll
+            continue;
         }
 
-        Attitude & beforeHeading = headingV[headingIndex];
-        Attitude & afterHeading = headingV[headingIndex + 1];
-
-        Attitude * interpolatedHeading = Interpolator::interpolateAttitude(beforeHeading, afterHeading, (*pitchRoll).getTimestamp());
+        Attitude * interpolatedHeading = Interpolator::interpolateAttitude(*beforeHeading, *afterHeading, (*pitchRoll).getTimestamp());
 
         processor.processAttitude((*pitchRoll).getTimestamp(), interpolatedHeading->getHeading(), (*pitchRoll).getPitch(), (*pitchRoll).getRoll());
 
@@ -552,7 +588,7 @@ uint64_t S7kParser::extractMicroEpoch(S7kDataRecordFrame & drf) {
 void S7kParser::processCtdDatagram(S7kDataRecordFrame & drf, unsigned char * data) {
     S7kCtdRTH * ctd = (S7kCtdRTH*) data;
 
-    SoundVelocityProfile * svp = new SoundVelocityProfile();
+    SoundVelocityProfile * svp = create<SoundVelocityProfile>();
 
     uint64_t timestamp = extractMicroEpoch(drf);
 
@@ -581,6 +617,9 @@ void S7kParser::processCtdDatagram(S7kDataRecordFrame & drf, unsigned char * dat
 
         processor.processSoundVelocityProfile(svp);
     }
+    else {
+        discard(svp);
+    }
 }
 
 
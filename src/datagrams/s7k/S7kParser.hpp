@@ -8,12 +8,15 @@
 #include <cstdio>
 #include "../DatagramParser.hpp"
 #include "S7kTypes.hpp"
+#include "S7kSonarSettingsTable.hpp"
+#include "S7kWaterColumnRecord.hpp"
 #include "../../utils/TimeUtils.hpp"
 #include "../../utils/Constants.hpp"
-#include <list>
 #include <queue>
 #include "../../svp/SoundVelocityProfile.hpp"
 #include "../../Attitude.hpp"
+#include "../../utils/TimeSeries.hpp"
+#include "../../utils/TimestampSort.hpp"
 
 /*!
  * \brief S7k parser class extention of Datagram parser
@@ -107,6 +110,24 @@ protected:
      */
     void processCtdDatagram(S7kDataRecordFrame & drf,unsigned char * data);
 
+    /**
+     * Processes a 7018 beamformed water column record
+     *
+     * @param drf the S7k data record frame
+     * @param data the datagram
+     * @param length number of bytes of the datagram, without the checksum
+     */
+    void processBeamformedDatagram(S7kDataRecordFrame & drf, unsigned char * data, unsigned int length);
+
+    /**
+     * Processes a 7042 compressed water column record
+     *
+     * @param drf the S7k data record frame
+     * @param data the datagram
+     * @param length number of bytes of the datagram, without the checksum
+     */
+    void processCompressedWaterColumnDatagram(S7kDataRecordFrame & drf, unsigned char * data, unsigned int length);
+
     /**
      * Returns a human readable name for a given datagram tag
      */
@@ -133,12 +154,15 @@ private:
     
     void process1012and1013Attiudes();
 
-    //TODO Use a map instead
-    /**List of ping settings*/
-    std::list<S7kSonarSettings *> pingSettings;
+    /**Sonar settings waiting for their detections, by ping number*/
+    S7kSonarSettingsTable pingSettings;
+
+    /**Views of the water column record being decoded, reused from one record to the next*/
+    S7kBeamformedRecord beamformed;
+    S7kCompressedWaterColumnRecord compressedWaterColumn;
     
     bool foundAttitudePackets1012and1013 = false;
-    std::vector<Attitude> headingV;
+    TimeSeries<Attitude> headingV;
     std::vector<Attitude> pitchRollV;
     
     uint64_t initialHeadingTimestamp;
@@ -0,0 +1,145 @@
+/*
+* Copyright 2020 © Centre Interdisciplinaire de développement en Cartographie des Océans (CIDCO), Tous droits réservés
+*/
+
+#ifndef S7KSONARSETTINGSTABLE_HPP
+#define S7KSONARSETTINGSTABLE_HPP
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+#include "S7kTypes.hpp"
+
+/*!
+* \brief Holds the 7000 sonar settings records until their 7027 detections and water column records show up
+*
+* Settings are stored by value in a table allocated once, at the slot given by their ping number.
+* Since ping numbers are sequential, a slot gets reused exactly capacity pings later:
+* settings are overwritten instead of piling up.
+* The sonar heads of a multi-head system number their pings alike, so a slot keeps the settings of each device.
+*/
+class S7kSonarSettingsTable {
+public:
+
+    /**
+    * Creates the table
+    *
+    * @param capacity maximum number of pings between settings and their detections. Rounded up to a power of two
+    */
+    S7kSonarSettingsTable(unsigned int capacity = 256) : count(0) {
+        unsigned int size = 1;
+
+        while (size < capacity) {
+            size <<= 1;
+        }
+
+        mask = size - 1;
+        slots.resize(size);
+        clear();
+    }
+
+    /**Destroys the table*/
+    ~S7kSonarSettingsTable() {
+    }
+
+    /**
+    * Returns the device a record comes from, telling apart the heads of a multi-head system
+    *
+    * @param drf the record frame
+    */
+    static uint64_t getDevice(S7kDataRecordFrame & drf) {
+        return ((uint64_t) drf.DeviceIdentifier << 16) | drf.SystemEnumerator;
+    }
+
+    /**
+    * Keeps a copy of the settings, replacing those of an older ping in its slot
+    *
+    * @param settings the sonar settings record
+    * @param device the device of the record
+    */
+    void add(S7kSonarSettings & settings, uint64_t device) {
+        std::vector<Entry> & slot = slots[settings.sequentialNumber & mask];
+
+        if (!slot.empty() && slot.front().settings.sequentialNumber != settings.sequentialNumber) {
+            count -= slot.size();
+            slot.clear();
+        }
+
+        Entry * entry = NULL;
+
+        for (auto i = slot.begin(); i != slot.end(); i++) {
+            if (i->device == device) {
+                entry = &(*i);
+                break;
+            }
+        }
+
+        if (!entry) {
+            slot.push_back(Entry());
+            entry = &slot.back();
+            entry->device = device;
+            count++;
+        }
+
+        memcpy(&entry->settings, &settings, sizeof (S7kSonarSettings));
+    }
+
+    /**
+    * Returns the settings of a ping. They stay in the table until their slot is reused, since the ping's
+    * detections and water column records may each need them, in any order
+    *
+    * @param pingNumber the ping number
+    * @param device the device of the ping
+    * @return the settings, NULL if none are held for this ping
+    */
+    S7kSonarSettings * find(uint32_t pingNumber, uint64_t device) {
+        std::vector<Entry> & slot = slots[pingNumber & mask];
+
+        for (auto i = slot.begin(); i != slot.end(); i++) {
+            if (i->device == device && i->settings.sequentialNumber == pingNumber) {
+                return &i->settings;
+            }
+        }
+
+        return NULL;
+    }
+
+    /**Returns the number of settings held*/
+    unsigned int size() {
+        return count;
+    }
+
+    /**Returns the number of pings a settings record is kept for*/
+    unsigned int getCapacity() {
+        return slots.size();
+    }
+
+    /**Forgets all settings*/
+    void clear() {
+        for (auto i = slots.begin(); i != slots.end(); i++) {
+            i->clear();
+        }
+
+        count = 0;
+    }
+
+private:
+
+    /**Settings of a device*/
+    typedef struct {
+        uint64_t device;
+        S7kSonarSettings settings;
+    } Entry;
+
+    /**The slots, indexed by ping number modulo their count, each holding the settings of one ping for its devices.
+    Cleared slots keep their storage, so a file is read without allocating once every head was seen*/
+    std::vector<std::vector<Entry> > slots;
+
+    /**Ping number mask giving the slot*/
+    uint32_t mask;
+
+    /**Number of settings held*/
+    unsigned int count;
+};
+
+#endif /* S7KSONARSETTINGSTABLE_HPP */
@@ -337,4 +337,47 @@ typedef struct{
 #pragma pack()
 
 
+#pragma pack(1)
+typedef struct{ // 7018 beamformed data
+    uint64_t sonarId;
+    uint32_t pingNumber;
+    uint16_t multiPingSequence;
+    uint16_t nbBeams;
+    uint32_t nbSamples;                 /* per beam */
+    uint32_t reserved[8];
+    // followed by nbSamples x nbBeams S7kBeamformedSample, sample by sample
+} S7kBeamformedRTH;
+#pragma pack()
+
+#pragma pack(1)
+typedef struct{
+    uint16_t amplitude;
+    int16_t  phase;
+} S7kBeamformedSample;
+#pragma pack()
+
+#pragma pack(1)
+typedef struct{ // 7042 compressed water column
+    uint64_t sonarId;
+    uint32_t pingNumber;
+    uint16_t multiPingSequence;
+    uint16_t nbBeams;
+    uint32_t nbSamples;                 /* before compression */
+    uint32_t nbCompressedSamples;
+    uint32_t flags;                     /* see S7K_WC_* */
+    uint32_t firstSample;
+    float    sampleRate;                /* in Hz */
+    float    compressionFactor;
+    uint32_t reserved;
+    // followed by a beam number (uint16_t), a segment number (uint8_t, if S7K_WC_SEGMENT_NUMBERS),
+    // a number of samples (uint32_t) and the samples of each beam
+} S7kCompressedWaterColumnRTH;
+#pragma pack()
+
+#define S7K_WC_MAGNITUDE_ONLY   0x0002  /* no phase */
+#define S7K_WC_8_BITS           0x0004  /* 8 bit magnitudes and phases */
+#define S7K_WC_32_BITS          0x1000  /* 32 bit magnitudes and phases */
+#define S7K_WC_SEGMENT_NUMBERS  0x4000  /* beams have a segment number */
+
+
 #endif /* S7KTYPES_HPP */
@@ -0,0 +1,227 @@
+/*
+* Copyright 2020 © Centre Interdisciplinaire de développement en Cartographie des Océans (CIDCO), Tous droits réservés
+*/
+
+#ifndef S7KWATERCOLUMNRECORD_HPP
+#define S7KWATERCOLUMNRECORD_HPP
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+#include "S7kTypes.hpp"
+#include "../../watercolumn/WaterColumnRecord.hpp"
+
+/*!
+* \brief View of an S7k 7018 beamformed data record
+*
+* The samples are stored sample by sample, all the beams of a sample together: the samples of a beam are
+* gathered with a stride when they are asked for. The record does not give the beam angles.
+*/
+class S7kBeamformedRecord : public WaterColumnRecord {
+public:
+
+    /**Creates a record viewing nothing*/
+    S7kBeamformedRecord() : header(NULL), samples(NULL), nbSamples(0) {
+    }
+
+    /**
+    * Views a 7018 record and decodes its header
+    *
+    * @param microEpoch timestamp of the ping
+    * @param data the record data
+    * @param length number of bytes of the record data
+    * @param sampleRate sampling frequency from the sonar settings of the ping, NaN if unknown
+    * @param soundVelocity sound speed from the sonar settings of the ping, NaN if unknown
+    */
+    void wrap(uint64_t microEpoch, unsigned char * data, unsigned int length, double sampleRate, double soundVelocity) {
+        header = (S7kBeamformedRTH *) data;
+        samples = (S7kBeamformedSample *) (data + sizeof (S7kBeamformedRTH));
+
+        timestamp = microEpoch;
+        pingNumber = header->pingNumber;
+        nbBeams = header->nbBeams;
+        nbSamples = header->nbSamples;
+        samplingFrequency = sampleRate;
+        soundSpeed = soundVelocity;
+
+        //keep the samples that fit in the record
+        uint64_t available = (length - sizeof (S7kBeamformedRTH)) / sizeof (S7kBeamformedSample);
+
+        if (nbBeams == 0 || (uint64_t) nbBeams * nbSamples > available) {
+            nbSamples = (nbBeams == 0) ? 0 : available / nbBeams;
+        }
+    }
+
+    double getBeamAngle(unsigned int beam) {
+        return std::numeric_limits<double>::quiet_NaN();
+    }
+
+    unsigned int getFirstSample(unsigned int beam) {
+        return 0;
+    }
+
+    unsigned int getNumberOfSamples(unsigned int beam) {
+        return nbSamples;
+    }
+
+    /**Decodes the amplitudes of a beam, as linear magnitudes*/
+    void getAmplitudes(unsigned int beam, std::vector<float> & amplitudes) {
+        amplitudes.resize(nbSamples);
+
+        S7kBeamformedSample * sample = samples + beam;
+
+        for (unsigned int i = 0; i < nbSamples; i++, sample += nbBeams) {
+            amplitudes[i] = sample->amplitude;
+        }
+    }
+
+    /**
+    * Decodes the phases of a beam
+    *
+    * @param beam the beam
+    * @param phases receives the phases, in the 16 bit scale of the record
+    */
+    void getPhases(unsigned int beam, std::vector<float> & phases) {
+        phases.resize(nbSamples);
+
+        S7kBeamformedSample * sample = samples + beam;
+
+        for (unsigned int i = 0; i < nbSamples; i++, sample += nbBeams) {
+            phases[i] = sample->phase;
+        }
+    }
+
+private:
+
+    /**Header of the record*/
+    S7kBeamformedRTH * header;
+
+    /**First sample of the first beam*/
+    S7kBeamformedSample * samples;
+
+    /**Number of samples of each beam*/
+    unsigned int nbSamples;
+};
+
+/*!
+* \brief View of an S7k 7042 compressed water column record
+*
+* The beams follow each other with their samples, whose size depends on the flags of the record: wrapping a
+* record hops over the beams to locate them, without reading the samples. The parser keeps one record and
+* wraps every 7042 record with it, so viewing a record does not allocate once the index has grown.
+* The record does not give the beam angles.
+*/
+class S7kCompressedWaterColumnRecord : public WaterColumnRecord {
+public:
+
+    /**Creates a record viewing nothing*/
+    S7kCompressedWaterColumnRecord() : header(NULL), sampleSize(0) {
+    }
+
+    /**
+    * Views a 7042 record, decodes its header and locates its beams
+    *
+    * @param microEpoch timestamp of the ping
+    * @param data the record data
+    * @param length number of bytes of the record data
+    */
+    void wrap(uint64_t microEpoch, unsigned char * data, unsigned int length) {
+        header = (S7kCompressedWaterColumnRTH *) data;
+
+        timestamp = microEpoch;
+        pingNumber = header->pingNumber;
+        samplingFrequency = header->sampleRate;
+
+        uint32_t flags = header->flags;
+        unsigned int magnitudeSize = (flags & S7K_WC_32_BITS) ? 4 : (flags & S7K_WC_8_BITS) ? 1 : 2;
+        sampleSize = (flags & S7K_WC_MAGNITUDE_ONLY) ? magnitudeSize : 2 * magnitudeSize;
+
+        unsigned int beamHeaderSize = sizeof (uint16_t) + ((flags & S7K_WC_SEGMENT_NUMBERS) ? sizeof (uint8_t) : 0) + sizeof (uint32_t);
+
+        beams.clear();
+
+        unsigned char * p = data + sizeof (S7kCompressedWaterColumnRTH);
+        unsigned char * end = data + length;
+
+        for (unsigned int i = 0; i < header->nbBeams && p + beamHeaderSize <= end; i++) {
+            Beam beam;
+            memcpy(&beam.number, p, sizeof (uint16_t));
+            memcpy(&beam.nbSamples, p + beamHeaderSize - sizeof (uint32_t), sizeof (uint32_t));
+            beam.samples = p + beamHeaderSize;
+
+            if ((uint64_t) beam.nbSamples * sampleSize > (uint64_t) (end - beam.samples)) {
+                break;
+            }
+
+            beams.push_back(beam);
+            p = beam.samples + beam.nbSamples * sampleSize;
+        }
+
+        nbBeams = beams.size();
+    }
+
+    /**Returns the beam number of a beam*/
+    unsigned int getBeamNumber(unsigned int beam) {
+        return beams[beam].number;
+    }
+
+    /**Returns the flags of the record*/
+    uint32_t getFlags() {
+        return header->flags;
+    }
+
+    double getBeamAngle(unsigned int beam) {
+        return std::numeric_limits<double>::quiet_NaN();
+    }
+
+    unsigned int getFirstSample(unsigned int beam) {
+        return header->firstSample;
+    }
+
+    unsigned int getNumberOfSamples(unsigned int beam) {
+        return beams[beam].nbSamples;
+    }
+
+    /**Decodes the magnitudes of a beam, in the scale of the record: 8 bit magnitudes are in dB*/
+    void getAmplitudes(unsigned int beam, std::vector<float> & amplitudes) {
+        Beam & b = beams[beam];
+        amplitudes.resize(b.nbSamples);
+
+        unsigned char * sample = b.samples;
+        unsigned int magnitudeSize = (header->flags & S7K_WC_MAGNITUDE_ONLY) ? sampleSize : sampleSize / 2;
+
+        for (unsigned int i = 0; i < b.nbSamples; i++, sample += sampleSize) {
+            if (magnitudeSize == 1) {
+                amplitudes[i] = *sample;
+            } else if (magnitudeSize == 2) {
+                uint16_t magnitude;
+                memcpy(&magnitude, sample, sizeof (uint16_t));
+                amplitudes[i] = magnitude;
+            } else {
+                uint32_t magnitude;
+                memcpy(&magnitude, sample, sizeof (uint32_t));
+                amplitudes[i] = magnitude;
+            }
+        }
+    }
+
+private:
+
+    /**A beam of the record*/
+    typedef struct {
+        uint16_t number;
+        uint32_t nbSamples;
+        unsigned char * samples;
+    } Beam;
+
+    /**Header of the record*/
+    S7kCompressedWaterColumnRTH * header;
+
+    /**Number of bytes of a sample, its magnitude and its phase if any*/
+    unsigned int sampleSize;
+
+    /**Beams of the record*/
+    std::vector<Beam> beams;
+};
+
+#endif /* S7KWATERCOLUMNRECORD_HPP */
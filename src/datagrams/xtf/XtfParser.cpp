@@ -23,9 +23,7 @@ XtfParser::XtfParser(DatagramEventHandler & processor):DatagramParser(processor)
 
 /**Destroy the XTF parser*/
 XtfParser::~XtfParser(){
-    for(auto i=channels.begin();i!=channels.end();i++){
-        free(*i);
-    }
+    //channel information is released along with channelArena
 }
 
 /**
@@ -34,15 +32,16 @@ XtfParser::~XtfParser(){
  * @param filename name of the file to read
  */
 void XtfParser::parse(std::string & filename, bool ignoreChecksum){
+    STATS_STAGE(STATS_PARSING);
     
     //TODO: reinit internal structures if called twice
     
-	FILE * file = fopen(filename.c_str(),"rb");
+	std::unique_ptr<InputStream> file(InputStream::open(filename));
 
         if(file){
                 //Lire Header
 		memset(&fileHeader,0,sizeof(XtfFileHeader));
-		int elementsRead = fread (&fileHeader,sizeof(XtfFileHeader),1,file);
+		int elementsRead = file->read(&fileHeader,sizeof(XtfFileHeader),1);
 
 		if(elementsRead==1){
 			if(fileHeader.FileFormat == MAGIC_NUMBER){
@@ -65,7 +64,7 @@ void XtfParser::parse(std::string & filename, bool ignoreChecksum){
 
 					do{
 						memset(buf,0,sizeof(XtfChanInfo)*8);
-						elementsRead = fread(&buf,sizeof(XtfChanInfo),8,file);
+						elementsRead = file->read(&buf,sizeof(XtfChanInfo),8);
 
 						if(elementsRead == 8){
 							for(int i=0;i<8;i++){
@@ -88,11 +87,11 @@ void XtfParser::parse(std::string & filename, bool ignoreChecksum){
 
 				//Lire packets
                                 
-				while(!feof(file)){
+				while(!file->eof()){
 					// parse a packet header
 					XtfPacketHeader packetHeader;
 
-					elementsRead = fread (&packetHeader,sizeof(XtfPacketHeader),1,file);
+					elementsRead = file->read(&packetHeader,sizeof(XtfPacketHeader),1);
 
 					if(elementsRead == 1){
 						if (packetHeader.MagicNumber==PACKET_MAGIC_NUMBER){
@@ -100,7 +99,7 @@ void XtfParser::parse(std::string & filename, bool ignoreChecksum){
 
 							unsigned char * packet = (unsigned char*) malloc(packetHeader.NumBytesThisRecord-sizeof(XtfPacketHeader));
 
-							elementsRead = fread (packet,packetHeader.NumBytesThisRecord-sizeof(XtfPacketHeader),1,file);
+							elementsRead = file->read(packet,packetHeader.NumBytesThisRecord-sizeof(XtfPacketHeader),1);
 
 							if(elementsRead == 1){
 								processPacket(packetHeader,packet);
@@ -112,7 +111,7 @@ void XtfParser::parse(std::string & filename, bool ignoreChecksum){
 							free(packet);
 						}
 						else{
-                                                    std::cerr << "Invalid packet header at byte position:" << ftell(file) << std::endl;
+                                                    std::cerr << "Invalid packet header at byte position:" << file->tell() << std::endl;
 						}
 					}
 					else{
@@ -122,16 +121,12 @@ void XtfParser::parse(std::string & filename, bool ignoreChecksum){
 				}
 			}
 			else{
-				fclose(file);
 				throw new Exception("Invalid file format");
 			}
 		}
 		else{
-			fclose(file);
 			throw new Exception("Couldn't read from file");
 		}
-
-		fclose(file);
 	}
 	else{
 		throw new Exception("File not found");
@@ -387,7 +382,7 @@ void XtfParser::processFileHeader(XtfFileHeader & f){
         //fprintf(stderr,"Reserved2: %d\n",f.Reserved2);
         //fprintf(stderr,"ReferencePointHeight: %f\n",f.ReferencePointHeight);
         
-        std::map<std::string,std::string> * fileProperties = new std::map<std::string,std::string>();
+        std::map<std::string,std::string> * fileProperties = create<std::map<std::string,std::string>>();
         
         fileProperties->insert(std::pair<std::string,std::string>("Channels (Sonar)",std::to_string(f.NumberOfSonarChannels)));
         fileProperties->insert(std::pair<std::string,std::string>("Channels (Bathymetry)",std::to_string(f.NumberOfBathymetryChannels)));
@@ -451,10 +446,11 @@ void XtfParser::processFileHeader(XtfFileHeader & f){
  * @param c the XTF ChanInfo
  */
 void XtfParser::processChanInfo(XtfChanInfo * c){
-    XtfChanInfo * channel = (XtfChanInfo *) malloc(sizeof(XtfChanInfo));
+    XtfChanInfo * channel = (XtfChanInfo *) channelArena.allocate(sizeof(XtfChanInfo));
     memcpy(channel,c,sizeof(XtfChanInfo));
     
     channels.push_back(channel);
+    sampleDecoders.push_back(XtfSampleDecoders::getDecoder(channel->SampleFormat,channel->BytesPerSample));
     
     //fprintf(stderr,"[+] XTF Channel Information\n\n");
     //fprintf(stderr,"TypeOfChannel: %d\n",channel->TypeOfChannel);
@@ -480,7 +476,7 @@ void XtfParser::processChanInfo(XtfChanInfo * c){
     //fprintf(stderr,"ReservedArea2: %s\n",channel->ReservedArea2);
     //fprintf(stderr,"------------\n");
     
-    std::map<std::string,std::string> * properties = new std::map<std::string,std::string>();
+    std::map<std::string,std::string> * properties = create<std::map<std::string,std::string>>();
     
     properties->insert(std::pair<std::string,std::string>("Channel Type",std::to_string(channel->TypeOfChannel)));
     properties->insert(std::pair<std::string,std::string>("Channel Number",std::to_string(channel->SubChannelNumber)));
@@ -547,6 +543,7 @@ void XtfParser::processPingHeader(XtfPingHeader & hdr){
  */
 void XtfParser::processPacket(XtfPacketHeader & hdr,unsigned char * packet){
 	processor.processDatagramTag(hdr.HeaderType);
+	STATS_DATAGRAM(*this,hdr.HeaderType);
 
 	if(hdr.HeaderType==XTF_HEADER_ATTITUDE){
 		uint64_t microEpoch = 0;
@@ -692,53 +689,20 @@ void XtfParser::processPingChanHeader(XtfPingChanHeader & pingChanHdr){
 }
 
 void XtfParser::processSidescanData(XtfPingHeader & pingHdr,XtfPingChanHeader & pingChanHdr,void * data){   
-    std::vector<double> rawSamples; //we will boil down all the types to double. This is not a pretty hack, but we need to support every sample type
-    
-    for(unsigned int i=0;i<pingChanHdr.NumSamples;i++){
-        double sample = 0;
-        
-        if(channels[pingChanHdr.ChannelNumber]->SampleFormat == 0){
-            //legacy
-            if(channels[pingChanHdr.ChannelNumber]->BytesPerSample == 1){
-                sample = ((uint8_t*)data)[i];
-            }
-            else if(channels[pingChanHdr.ChannelNumber]->BytesPerSample == 2){
-                sample = ((uint16_t*)data)[i];
-            }
-            else if(channels[pingChanHdr.ChannelNumber]->BytesPerSample == 4){
-                sample = ((uint32_t*)data)[i];
-            }
-            else{
-                std::cerr << "[-] Bytes per sample: " << channels[pingChanHdr.ChannelNumber]->BytesPerSample << std::endl;
-                throw new std::invalid_argument("Bad bytes per sample format");                
-            }
-        }
-        else if(channels[pingChanHdr.ChannelNumber]->SampleFormat == 1){
-            //TODO: wtf is an "IBM float" in C?
-            throw new std::invalid_argument("[-] Sample format is IBM float");
-        }
-        else if(channels[pingChanHdr.ChannelNumber]->SampleFormat == 2){
-            sample = ((uint32_t*)data)[i];
-        }
-        else if(channels[pingChanHdr.ChannelNumber]->SampleFormat == 3){
-            sample = ((uint16_t*)data)[i];
-        }
-        else if(channels[pingChanHdr.ChannelNumber]->SampleFormat == 5){
-            sample = ((float*)data)[i];
-        }
-        else if(channels[pingChanHdr.ChannelNumber]->SampleFormat == 8){
-            sample = ((uint8_t*)data)[i];
-        }        
-        else{
-            std::cerr << "[-] Sample Format: " << channels[pingChanHdr.ChannelNumber]->SampleFormat << std::endl;
-            throw new std::invalid_argument("Sample format unused");
+    XtfChanInfo * channel = channels[pingChanHdr.ChannelNumber];
+    XtfSampleDecoders::SampleDecoder decoder = sampleDecoders[pingChanHdr.ChannelNumber];
+
+    if(decoder == NULL){
+        if(channel->SampleFormat == 0){
+            std::cerr << "[-] Bytes per sample: " << channel->BytesPerSample << std::endl;
+            throw new std::invalid_argument("Bad bytes per sample format");
         }
 
-        rawSamples.push_back(sample);
+        std::cerr << "[-] Sample Format: " << (int)channel->SampleFormat << std::endl;
+        throw new std::invalid_argument("Sample format unused");
     }
-    
-    
-    SidescanPing * ping = new SidescanPing();
+
+    SidescanPing * ping = create<SidescanPing>();
     
     uint64_t microEpoch = TimeUtils::build_time(
                 pingHdr.Year,
@@ -754,8 +718,9 @@ void XtfParser::processSidescanData(XtfPingHeader & pingHdr,XtfPingChanHeader &
     ping->setTimestamp(microEpoch);
     
     if(pingHdr.SensorXcoordinate != 0.0 && pingHdr.SensorYcoordinate != 0.0){ //this would cause weird issues at coordinates... (0.0,0.0)
+        ping->setOwnsAttitudeAndPosition(processor.getArena() == NULL);
         ping->setPosition(
-            new Position(
+            create<Position>(
                     microEpoch,
                     // pingHdr.SensorXcoordinate,
                     // pingHdr.SensorYcoordinate,                    
@@ -772,39 +737,44 @@ void XtfParser::processSidescanData(XtfPingHeader & pingHdr,XtfPingChanHeader &
     
     ping->setChannelNumber(pingChanHdr.ChannelNumber);
     
-    if(channels[pingChanHdr.ChannelNumber]->CorrectionFlags == 2){
-        //ground ranged images, use as-is
-        ping->setSamples(rawSamples);
-        ping->setDistancePerSample(pingChanHdr.GroundRange/(double)rawSamples.size());
+    unsigned int nbSamples = pingChanHdr.NumSamples;
+
+    //samples are kept in their native width
+    decoder(data,nbSamples,*ping);
+
+    if(channel->CorrectionFlags == 2){
+        //ground ranged images
+        ping->setDistancePerSample(pingChanHdr.GroundRange/(double)nbSamples);
     }
     else{       
-        //Slant-range image, apply corrections to raw samples
-        std::vector<double> correctedSamples;
-
+        //Slant-range image
         //Get beam angle , between nadir and slant        
         double beamAngle = 20;
-
-        if(channels[pingChanHdr.ChannelNumber]->TiltAngle > 0){
-            beamAngle = channels[pingChanHdr.ChannelNumber]->TiltAngle;
+        
+        if(channel->TiltAngle > 0){
+            beamAngle = channel->TiltAngle;
         }
         
         //Apply corrections
-        SlantRangeCorrection::correct(rawSamples,pingChanHdr.SlantRange,0,beamAngle,correctedSamples);
-        
-        ping->setSamples(correctedSamples);
-        ping->setDistancePerSample((double)pingChanHdr.SlantRange/(double)rawSamples.size());
+        switch(ping->getSampleType()){
+            case SAMPLE_UINT8:  correctSlantRange<uint8_t>(*ping,pingChanHdr.SlantRange,beamAngle); break;
+            case SAMPLE_UINT16: correctSlantRange<uint16_t>(*ping,pingChanHdr.SlantRange,beamAngle); break;
+            case SAMPLE_UINT32: correctSlantRange<uint32_t>(*ping,pingChanHdr.SlantRange,beamAngle); break;
+            case SAMPLE_FLOAT:  correctSlantRange<float>(*ping,pingChanHdr.SlantRange,beamAngle); break;
+            default:            correctSlantRange<double>(*ping,pingChanHdr.SlantRange,beamAngle); break;
+        }
         
-        processor.processSidescanData(ping);
+        ping->setDistancePerSample((double)pingChanHdr.SlantRange/(double)nbSamples);
     }
+
+    processor.processSidescanData(ping);
 }
 
 void XtfParser::processResonSettingsDatagram(XtfPacketHeader & hdr, unsigned char * data) {
-    //S7kDataRecordFrame * drf = (S7kDataRecordFrame*) data;
+    S7kDataRecordFrame * drf = (S7kDataRecordFrame*) data;
     //skip the Data Record Frame
     S7kSonarSettings * settings = (S7kSonarSettings*) (data+sizeof(S7kDataRecordFrame));
-    S7kSonarSettings * settingsCopy = (S7kSonarSettings *) malloc(sizeof (S7kSonarSettings));
-    memcpy(settingsCopy, settings, sizeof (S7kSonarSettings));
-    pingSettings.push_back(settingsCopy);
+    pingSettings.add(*settings, S7kSonarSettingsTable::getDevice(*drf));
 }
 
 void XtfParser::processReson7027Bathy(XtfPacketHeader & hdr,unsigned char * packet) {
@@ -827,15 +797,8 @@ void XtfParser::processReson7027Bathy(XtfPacketHeader & hdr,unsigned char * pack
         double tiltAngle = swath->transmissionAngle*R2D;
         double samplingRate = swath->samplingRate;
         
-        S7kSonarSettings * settings = NULL;
-        for (auto i = pingSettings.begin(); i != pingSettings.end(); i++) {
-            if ((*i)->sequentialNumber == swath->pingNumber) {
-                settings = (*i);
-                pingSettings.remove((*i));
-                break;
-            }
-        }
-        
+        S7kSonarSettings * settings = pingSettings.find(swath->pingNumber, S7kSonarSettingsTable::getDevice(*drf));
+
         if (settings) {
             double surfaceSoundVelocity = settings->soundVelocity;
 
@@ -847,8 +810,6 @@ void XtfParser::processReson7027Bathy(XtfPacketHeader & hdr,unsigned char * pack
                 double intensity = swath->dataFieldSize > 22 ? ping->signalStrength : 0;
                 processor.processPing(microEpoch, (long) ping->beamDescriptor, (double) ping->receptionAngle*R2D, tiltAngle, twoWayTravelTime, ping->quality, intensity);
             }
-
-            free(settings);
         } else {
             
             std::cerr << "No settings for ping #" << swath->pingNumber << std::endl;
@@ -860,6 +821,21 @@ void XtfParser::processReson7027Bathy(XtfPacketHeader & hdr,unsigned char * pack
 }
 
 
+/**
+ * Reads a big-endian float. memcpy instead of pointer casts, which break strict aliasing
+ *
+ * @param field the 4 bytes of the float
+ */
+static float readBigEndianFloat(const void * field){
+    uint32_t bits;
+    memcpy(&bits,field,sizeof(bits));
+    bits = htonl(bits);
+
+    float value;
+    memcpy(&value,&bits,sizeof(value));
+    return value;
+}
+
 /**
  * Processes a QUINSy R2Sonic packet
  *
@@ -902,12 +878,12 @@ void XtfParser::processQuinsyR2SonicBathy(XtfPacketHeader & hdr,unsigned char *
             else if(sectionName==0x4130){
                 //A0 - equi-angle mode
                 XtfHeaderQuinsyR2SonicBathy_A0 * a0 = (XtfHeaderQuinsyR2SonicBathy_A0*) (packet + packetIndex);
-                uint32_t first = htonl( *((uint32_t*) &a0->AngleFirst) );
-                uint32_t last  = htonl( *((uint32_t*) &a0->AngleLast) );
+                float first = readBigEndianFloat(&a0->AngleFirst);
+                float last  = readBigEndianFloat(&a0->AngleLast);
 
-                double step = (   (*((float*)&first))   -   (*((float*)&last))   )/(double)nbBeams;
+                double step = (first - last)/(double)nbBeams;
 
-                double angle = (*((float*)&first));
+                double angle = first;
 
                 for(unsigned int i =0; i < nbBeams ;i++ ){
                     pings[i].setAcrossTrackAngle(angle);
@@ -917,11 +893,8 @@ void XtfParser::processQuinsyR2SonicBathy(XtfPacketHeader & hdr,unsigned char *
             else if(sectionName==0x4132){
                 //A2 - equidistant angle mode
                 XtfHeaderQuinsyR2SonicBathy_A2 * a2 = (XtfHeaderQuinsyR2SonicBathy_A2*) (packet + packetIndex);
-                uint32_t first         = htonl( *((uint32_t*)&a2->AngleFirst));
-                float    angleFirst    = *((float*)&first);
-
-                uint32_t scale         = htonl( *((uint32_t*)&a2->ScalingFactor));
-                float    scalingFactor = *((float*)&scale);
+                float    angleFirst    = readBigEndianFloat(&a2->AngleFirst);
+                float    scalingFactor = readBigEndianFloat(&a2->ScalingFactor);
                 uint32_t sum           = 0;
 
                 for(unsigned int i=0;i<nbBeams;i++){
@@ -933,8 +906,7 @@ void XtfParser::processQuinsyR2SonicBathy(XtfPacketHeader & hdr,unsigned char *
             else if(sectionName==0x4931){
                 //I1
                 XtfHeaderQuinsyR2SonicBathy_I1 * i1 = (XtfHeaderQuinsyR2SonicBathy_I1*) (packet + packetIndex);
-                uint32_t scale         = htonl( *((uint32_t*)&i1->ScalingFactor));
-                float    scalingFactor = *((float*)&scale);
+                float    scalingFactor = readBigEndianFloat(&i1->ScalingFactor);
 
                 for(unsigned int i=0;i<nbBeams;i++){
                     double microPascals = htons(((uint16_t*)&(i1->IntensityArray))[i]) * scalingFactor;
@@ -969,10 +941,10 @@ void XtfParser::processQuinsyR2SonicBathy(XtfPacketHeader & hdr,unsigned char *
                 //R0
                 XtfHeaderQuinsyR2SonicBathy_R0 * r0 = (XtfHeaderQuinsyR2SonicBathy_R0*) (packet + packetIndex);
                 uint16_t * ranges = &r0->RangeArray;
-                uint32_t scalingFactor=htonl(* ((uint32_t *) &r0->ScalingFactor));
+                float scalingFactor = readBigEndianFloat(&r0->ScalingFactor);
 
                 for(unsigned int i=0;i<nbBeams;i++){
-                    double twtt = (*((float*) &scalingFactor )) * htons(ranges[i]);
+                    double twtt = scalingFactor * htons(ranges[i]);
                     pings[i].setTwoWayTravelTime( twtt );
                 }
             } else if(sectionBytes == 0) {
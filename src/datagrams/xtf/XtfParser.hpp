@@ -18,13 +18,16 @@
 #include <string.h>
 #include <cstdio>
 #include "XtfTypes.hpp"
+#include "XtfSampleDecoders.hpp"
 #include "../s7k/S7kTypes.hpp"
+#include "../s7k/S7kSonarSettingsTable.hpp"
 #include "../DatagramParser.hpp"
 #include "../../utils/TimeUtils.hpp"
 #include "../../utils/Exception.hpp"
 #include <vector>
 #include "../../Ping.hpp"
 #include "../../math/SlantRangeCorrection.hpp"
+#include "../../utils/Arena.hpp"
 
 #define MAGIC_NUMBER 123
 #define PACKET_MAGIC_NUMBER 0xFACE
@@ -142,10 +145,28 @@ class XtfParser : public DatagramParser{
 		XtfFileHeader fileHeader;
                 
                 std::vector<XtfChanInfo*> channels;
+
+                /**Sample decoder of each channel, NULL if its sample format is not supported*/
+                std::vector<XtfSampleDecoders::SampleDecoder> sampleDecoders;
+
+                /**
+                 * Applies the slant range correction to the samples of a ping, keeping their storage type
+                 */
+                template<typename T>
+                void correctSlantRange(SidescanPing & ping,double slantRange,double beamAngle){
+                    std::vector<T> rawSamples;
+                    rawSamples.swap(ping.getTypedSamples<T>());
+                    slantRangeCorrection.apply(rawSamples,slantRange,0,beamAngle,ping.allocateSamples<T>(0));
+                }
+
+                /**Slant range correction, caching a remap plan per channel geometry*/
+                SlantRangeCorrection slantRangeCorrection;
+
+                /**Holds the channel information for the lifetime of the parser*/
+                Arena channelArena{sizeof(XtfChanInfo) * 16};
                 
-                //TODO Use a map instead
-                /**List of ping settings*/
-                std::list<S7kSonarSettings *> pingSettings;
+                /**Reson sonar settings waiting for their detections, by ping number*/
+                S7kSonarSettingsTable pingSettings;
                 
 
 };
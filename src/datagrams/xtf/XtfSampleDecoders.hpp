@@ -0,0 +1,111 @@
+/*
+* Copyright 2020 © Centre Interdisciplinaire de développement en Cartographie des Océans (CIDCO), Tous droits réservés
+*/
+
+#ifndef XTFSAMPLEDECODERS_HPP
+#define XTFSAMPLEDECODERS_HPP
+
+#include <cstdint>
+#include <cstring>
+#include <cmath>
+#include "../../sidescan/SidescanPing.hpp"
+
+/*!
+* \brief Decoders for the sidescan sample formats of XTF channels
+*
+* A decoder is picked once per channel, from its ChanInfo, so the per-sample loop has no format checks left.
+* Samples are stored in the ping in their native width, IBM floats are converted to float.
+*/
+class XtfSampleDecoders {
+public:
+
+    /**
+    * Stores raw samples in a ping
+    *
+    * @param data the raw samples
+    * @param nbSamples number of samples
+    * @param ping receives the samples
+    */
+    typedef void (*SampleDecoder)(const void * data, unsigned int nbSamples, SidescanPing & ping);
+
+    /**
+    * Returns the decoder for a channel, or NULL if its format is not supported
+    *
+    * @param sampleFormat SampleFormat field of the ChanInfo
+    * @param bytesPerSample BytesPerSample field of the ChanInfo, used by the legacy format (0)
+    */
+    static SampleDecoder getDecoder(uint8_t sampleFormat, uint16_t bytesPerSample) {
+        switch (sampleFormat) {
+            case 0:
+                //legacy
+                if (bytesPerSample == 1) return &decode<uint8_t>;
+                if (bytesPerSample == 2) return &decode<uint16_t>;
+                if (bytesPerSample == 4) return &decode<uint32_t>;
+                return NULL;
+
+            case 1:
+                return &decodeIbmFloat;
+
+            case 2:
+                return &decode<uint32_t>;
+
+            case 3:
+                return &decode<uint16_t>;
+
+            case 5:
+                return &decode<float>;
+
+            case 8:
+                return &decode<uint8_t>;
+
+            default:
+                return NULL;
+        }
+    }
+
+    /**
+    * Copies samples of a native type
+    *
+    * @param data the raw samples
+    * @param nbSamples number of samples
+    * @param ping receives the samples
+    */
+    template<typename T>
+    static void decode(const void * data, unsigned int nbSamples, SidescanPing & ping) {
+        std::vector<T> & samples = ping.allocateSamples<T>(nbSamples);
+        memcpy(samples.data(), data, nbSamples * sizeof (T));
+    }
+
+    /**
+    * Converts IBM System/360 single precision floats (sign bit, base 16 exponent biased by 64, 24 bit fraction)
+    *
+    * @param data the raw samples
+    * @param nbSamples number of samples
+    * @param ping receives the samples, as floats
+    */
+    static void decodeIbmFloat(const void * data, unsigned int nbSamples, SidescanPing & ping) {
+        const unsigned char * bytes = (const unsigned char *) data;
+        std::vector<float> & samples = ping.allocateSamples<float>(nbSamples);
+
+        for (unsigned int i = 0; i < nbSamples; i++) {
+            uint32_t ibm;
+            memcpy(&ibm, bytes + i * sizeof (uint32_t), sizeof (uint32_t));
+            samples[i] = (float) ibmFloatToDouble(ibm);
+        }
+    }
+
+    /**
+    * Converts an IBM System/360 single precision float
+    *
+    * @param ibm the raw value
+    */
+    static double ibmFloatToDouble(uint32_t ibm) {
+        double fraction = (double) (ibm & 0x00FFFFFF) / (double) 0x01000000;
+        int exponent = (int) ((ibm >> 24) & 0x7F) - 64;
+        double value = std::ldexp(fraction, 4 * exponent);
+
+        return (ibm & 0x80000000) ? -value : value;
+    }
+};
+
+#endif /* XTFSAMPLEDECODERS_HPP */
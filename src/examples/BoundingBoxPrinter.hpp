@@ -22,10 +22,14 @@ private:
 	double minLatitude  = std::numeric_limits<double>::max();
 	double maxLatitude  = std::numeric_limits<double>::lowest();
 
+	/**Arena holding the sidescan pings being processed*/
+	Arena pingArena;
+
 
 public:
 	BoundingBoxPrinter(){
-
+		//Only the position of each sidescan ping is kept, so the pings are carved from an arena that is recycled after each one
+		setArena(&pingArena);
 	}
 
 	~BoundingBoxPrinter(){
@@ -40,6 +44,8 @@ public:
                     ping->getPosition()->getEllipsoidalHeight()
                 );
             }
+
+            if(arena) arena->reset(); else delete ping;
         }
 
 	void processPosition(uint64_t microEpoch,double longitude,double latitude,double height){
@@ -7,6 +7,7 @@
 
 #include "../datagrams/DatagramParserFactory.hpp"
 #include "BoundingBoxPrinter.hpp"
+#include "../utils/Stats.hpp"
 #include <iostream>
 #include <cstdio>
 #include <string>
@@ -19,7 +20,7 @@ void printUsage(){
 	NAME\n\n\
 	bounding-box - prints bounding box information for a multibeam echosounder file\n\n\
 	SYNOPSIS\n \
-	bounding-box file\n\n\
+	bounding-box [--stats[=file.json]] file\n\n\
 	DESCRIPTION\n\n \
 	Copyright 2020 © Centre Interdisciplinaire de développement en Cartographie des Océans (CIDCO), All rights reserved" << std::endl;
 	exit(1);
@@ -32,6 +33,8 @@ void printUsage(){
 * @param argv value of the arguments
 */
 int main (int argc , char ** argv ){
+	Stats::parseArguments(argc, argv);
+
 	DatagramParser * parser = NULL;
 	BoundingBoxPrinter  printer;
 
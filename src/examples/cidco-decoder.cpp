@@ -7,6 +7,7 @@
 
 #include "../datagrams/DatagramParserFactory.hpp"
 #include "../svp/CarisSvpFile.hpp"
+#include "../utils/Stats.hpp"
 #include <iostream>
 #include <string>
 
@@ -18,7 +19,7 @@ void printUsage(){
 	NAME\n\n\
 	cidco-decoder - lit un fichier MBES et le transforme en format cidco (ASCII)\n\n\
 	SYNOPSIS\n \
-	cidco-decoder fichier\n\n\
+	cidco-decoder [--stats[=file.json]] fichier\n\n\
 	DESCRIPTION\n\n \
 	Copyright 2018 © Centre Interdisciplinaire de développement en Cartographie des Océans (CIDCO), Tous droits réservés" << std::endl;
 	exit(1);
@@ -183,6 +184,8 @@ public:
 * @param argv value of the arguments
 */
 int main (int argc , char ** argv ){
+	Stats::parseArguments(argc, argv);
+
 	DatagramParser * parser = NULL;
 	DatagramPrinter  printer;
 
@@ -17,7 +17,6 @@
 #include <cstdio>
 #include <string>
 #include <iostream>
-#include <list>
 #include <iostream>
 #include <Eigen/Dense>
 #include <fstream>
@@ -25,6 +24,13 @@
 #include "../filter/QualityFilter.hpp"
 #include "../filter/IntensityFilter.hpp"
 #include "../filter/InsanePositionFilter.hpp"
+#include "../filter/PointFilterChain.hpp"
+#include "../filter/PointBatch.hpp"
+#include "../filter/PointMask.hpp"
+#include "../filter/SpatialOutlierFilter.hpp"
+#include "../utils/PointTextReader.hpp"
+#include "../utils/PointTextWriter.hpp"
+#include "../utils/Stats.hpp"
 
 using namespace std;
 
@@ -34,8 +40,12 @@ void printUsage(){
   NAME\n\n\
      data-cleaning - Filtre les points d'un nuage\n\n\
   SYNOPSIS\n \
-	   data-cleaning [-q QualityFilter] [-i IntensityFilter]\n\n\
-  DESCRIPTION\n\n \
+	   data-cleaning [-q QualityFilter] [-i IntensityFilter] [-c cell_size [-k sigmas] [-m median|plane] [-t threads]] [--stats[=file.json]]\n\n\
+  DESCRIPTION\n \
+	   -c Removes spatial outliers, using cells of this size in the unit of x and y\n \
+	   -k Number of sigmas beyond which a point is an outlier (default: 3)\n \
+	   -m Surface of a cell: median depth or fitted plane (default: median)\n \
+	   -t Number of threads of the outlier filter (default: every core)\n\n \
   Copyright 2017-2019 © Centre Interdisciplinaire de développement en Cartographie des Océans (CIDCO), Tous droits réservés" << std::endl;
 	exit(1);
 }
@@ -47,18 +57,24 @@ void printUsage(){
  * @param argv value of the parameters
  */
 int main(int argc,char** argv){
-
-	std::string line;
+	Stats::parseArguments(argc, argv);
 
 	//Filter chain
-	std::list<PointFilter *> filters;
-        filters.push_back(new InsanePositionFilter());
+	PointFilterChain filters;
+        filters.add(new InsanePositionFilter());
 
 	//TODO: load desired filters and parameters from command line
         int index;
         int quality;
         int intensity;
-        while((index=getopt(argc,argv,"q:i:"))!=-1)
+
+        //Spatial outlier filter
+        double cellSize = 0;
+        double sigmas = 3.0;
+        OutlierSurface surface = SURFACE_MEDIAN;
+        unsigned int nbThreads = 0;
+
+        while((index=getopt(argc,argv,"q:i:c:k:m:t:"))!=-1)
         {
             switch(index)
             {
@@ -70,7 +86,7 @@ int main(int argc,char** argv){
                     }
                     else
                     {
-                        filters.push_back(new QualityFilter(quality));
+                        filters.add(new QualityFilter(quality));
                     }
                 break;
 
@@ -82,36 +98,90 @@ int main(int argc,char** argv){
                     }
                     else
                     {
-                        filters.push_back(new IntensityFilter(intensity));
+                        filters.add(new IntensityFilter(intensity));
                     }
                 break;
-            }
-        }
-        unsigned int lineCount = 1;
-        while((std::getline(std::cin,line))&&(line!="0")){
-            double x,y,z;
-            uint32_t quality;
-            uint32_t intensity;
-
-            if(sscanf(line.c_str(),"%lf %lf %lf %d %d",&x,&y,&z,&quality,&intensity)==5){
-		bool doFilter = false;
-
-			//Apply filter chain
-		for(auto i = filters.begin();i!= filters.end();i++){
-                    if( (*i)->filterPoint(0,x,y,z,quality,intensity) ){
-			doFilter = true;
-                        break;
+
+                case 'c':
+                    if(sscanf(optarg,"%lf", &cellSize) != 1 || cellSize <= 0)
+                    {
+                        std::cerr << "Error: -c invalid cell size parameter" << std::endl;
+                        printUsage();
                     }
-		}
+                break;
 
-		if(!doFilter){
-                    printf("%.6lf %.6lf %.6lf %d %d\n",x,y,z,quality,intensity);
-		}
+                case 'k':
+                    if(sscanf(optarg,"%lf", &sigmas) != 1 || sigmas <= 0)
+                    {
+                        std::cerr << "Error: -k invalid sigmas parameter" << std::endl;
+                        printUsage();
+                    }
+                break;
+
+                case 'm':
+                {
+                    std::string mode(optarg);
+
+                    if(mode == "median")
+                    {
+                        surface = SURFACE_MEDIAN;
+                    }
+                    else if(mode == "plane")
+                    {
+                        surface = SURFACE_PLANE;
+                    }
+                    else
+                    {
+                        std::cerr << "Error: -m invalid surface parameter" << std::endl;
+                        printUsage();
+                    }
+                }
+                break;
+
+                case 't':
+                    if(sscanf(optarg,"%u", &nbThreads) != 1)
+                    {
+                        std::cerr << "Error: -t invalid threads parameter" << std::endl;
+                        printUsage();
+                    }
+                break;
             }
-            else{
-		std::cerr << "Error at line " << lineCount << std::endl;
+        }
+
+        //Last, so the points removed by the other filters do not weigh on the cell surfaces
+        if(cellSize > 0)
+        {
+            filters.add(new SpatialOutlierFilter(cellSize, sigmas, surface, 5, 20000, nbThreads));
+        }
+
+        //Points are read, filtered and written in batches
+        PointTextReader reader(stdin);
+        PointTextWriter writer(stdout);
+
+        PointBatch batch;
+        PointMask rejected;
+        const unsigned int batchSize = 4096;
+
+        batch.reserve(batchSize);
+
+        while(reader.read(batch, batchSize)){
+            unsigned int nbPoints = batch.size();
+
+            //Apply filter chain over the whole batch
+            rejected.reset(nbPoints);
+            filters.filterBatch(batch, rejected);
+
+            STATS_STAGE(STATS_OUTPUT);
+            STATS_COUNT(STATS_POINTS_WRITTEN, nbPoints - rejected.getNumberOfRejected());
+
+            for(unsigned int p = 0; p < nbPoints; p++){
+                if(!rejected.isRejected(p)){
+                    writer.write(batch.x[p],batch.y[p],batch.z[p],batch.quality[p],batch.intensity[p]);
+                }
             }
-            lineCount++;
         }
+
+        STATS_STAGE(STATS_OUTPUT);
+        writer.flush();
     }
 #endif
@@ -10,6 +10,7 @@
 #define MAIN_CPP
 
 #include "../datagrams/DatagramParserFactory.hpp"
+#include "../utils/Stats.hpp"
 #include <iostream>
 #include <string>
 
@@ -21,7 +22,7 @@ void printUsage(){
 	NAME\n\n\
 	datagram-dump - lit un fichier binaire et le transforme en format texte (ASCII)\n\n\
 	SYNOPSIS\n \
-	datagram-dump fichier\n\n\
+	datagram-dump [--stats[=file.json]] fichier\n\n\
 	DESCRIPTION\n\n \
 	Copyright 2017 © Centre Interdisciplinaire de développement en Cartographie des Océans (CIDCO), Tous droits réservés" << std::endl;
 	exit(1);
@@ -102,6 +103,8 @@ public:
 * @param argv value of the arguments
 */
 int main (int argc , char ** argv ){
+	Stats::parseArguments(argc, argv);
+
 	DatagramParser * parser = NULL;
 	DatagramPrinter  printer;
 
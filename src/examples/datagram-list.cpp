@@ -10,6 +10,7 @@
 #define MAIN_CPP
 
 #include "../datagrams/DatagramParserFactory.hpp"
+#include "../utils/Stats.hpp"
 #include <iostream>
 #include <string>
 
@@ -22,7 +23,7 @@ void printUsage(){
 	NAME\n\n\
 	datagram-list - liste les datagrammes contenus dans un fichier binaire\n\n\
 	SYNOPSIS\n \
-	datagram-list fichier\n\n\
+	datagram-list [--stats[=file.json]] fichier\n\n\
 	DESCRIPTION\n\n \
 	Copyright 2017 © Centre Interdisciplinaire de développement en Cartographie des Océans (CIDCO), Tous droits réservés" << std::endl;
 	exit(1);
@@ -72,6 +73,8 @@ public:
 * @param argv value of the arguments
 */
 int main (int argc , char ** argv ){
+	Stats::parseArguments(argc, argv);
+
 	DatagramParser * parser = NULL;
 	DatagramPrinter  printer;
 
@@ -22,13 +22,14 @@
 #include "../svp/SvpNearestByTime.hpp"
 #include "../svp/SvpNearestByLocation.hpp"
 #include "../math/Boresight.hpp"
+#include "../utils/Stats.hpp"
 
 void printUsage(){
 	std::cerr << "\n\
 NAME\n\n\
 	raytracer - Produces raytraced vectors for each beam \n\n\
 SYNOPSIS\n \
-	raytracer [-x lever_arm_x] [-y lever_arm_y] [-z lever_arm_z] [-r roll_angle] [-p pitch_angle] [-h heading_angle] [-d transducer_depth] [-s svp_file] [-S svpStrategy] file\n\n\
+	raytracer [-x lever_arm_x] [-y lever_arm_y] [-z lever_arm_z] [-r roll_angle] [-p pitch_angle] [-h heading_angle] [-d transducer_depth] [-s svp_file] [-S svpStrategy] [--stats[=file.json]] file\n\n\
 DESCRIPTION\n \
     This application will output the raytraced vector for each beam in the MBES file\n\n \
         -S choose one: nearestTime or nearestLocation\n\n \
@@ -43,6 +44,8 @@ Copyright 2017-2020 © Centre Interdisciplinaire de développement en Cartograph
 * @param argv value of the arguments
 */
 int main (int argc , char ** argv ){
+	Stats::parseArguments(argc, argv);
+
 	
 
 	#ifdef __GNU__
@@ -0,0 +1,240 @@
+/*
+ *  Copyright 2020 © Centre Interdisciplinaire de développement en Cartographie des Océans (CIDCO), Tous droits réservés
+ */
+#ifndef DTMGRID_CPP
+#define DTMGRID_CPP
+
+#ifdef _WIN32
+#include "../utils/getopt.h"
+#pragma comment(lib, "Ws2_32.lib")
+#else
+#include <unistd.h>
+#endif
+
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <cstdio>
+#include <Eigen/Dense>
+#include "../datagrams/DatagramParserFactory.hpp"
+#include "../gridding/DtmGrid.hpp"
+#include "../gridding/DtmGridStore.hpp"
+#include "../gridding/DatagramGridder.hpp"
+#include "../utils/Exception.hpp"
+#include "../math/Boresight.hpp"
+#include "../svp/CarisSvpFile.hpp"
+#include "../svp/SvpNearestByTime.hpp"
+#include "../utils/Stats.hpp"
+
+/**Write the information about the program*/
+void printUsage(){
+	std::cerr << "\n\
+NAME\n\n\
+	dtm-grid - Grids the soundings of binary multibeam echosounder datagrams files into a digital terrain model\n\n\
+SYNOPSIS\n \
+	dtm-grid [-c cell_size] [-o store_directory [-m mapped_tiles]] [-x lever_arm_x] [-y lever_arm_y] [-z lever_arm_z] [-r roll_angle] [-p pitch_angle] [-h heading_angle] [-s svp_file] [--stats[=file.json]] file\n\n\
+DESCRIPTION\n \
+	-c Cell size in meters (default: 1)\n \
+	-o Grid into an on-disk tiled store in this directory, for grids larger than memory\n \
+	-m Number of store tiles kept in memory (default: 256)\n\n \
+	Without -o, writes \"longitude latitude count mean min max stddev\" for every cell holding soundings.\n \
+	Depths are positive down, relative to the ellipsoidal height of the centroid of the positions\n\n \
+Copyright 2020 © Centre Interdisciplinaire de développement en Cartographie des Océans (CIDCO), Tous droits réservés" << std::endl;
+	exit(1);
+}
+
+/**
+  * declare the parser depending on argument receive
+  *
+  * @param argc number of argument
+  * @param argv value of the arguments
+  */
+int main (int argc , char ** argv){
+    Stats::parseArguments(argc, argv);
+
+
+#ifdef __GNU__
+	setenv("TZ", "UTC", 1);
+#endif
+#ifdef _WIN32
+	putenv("TZ");
+#endif
+    if(argc < 2)
+    {
+        printUsage();
+    }
+
+    std::string fileName(argv[argc-1]);
+
+    double cellSize = 1.0;
+
+    std::string storeDirectory;
+    unsigned int maxMappedTiles = 256;
+
+    //Lever arm
+    double leverArmX = 0.0;
+    double leverArmY = 0.0;
+    double leverArmZ = 0.0;
+
+    //Boresight
+    double roll     = 0.0;
+    double pitch    = 0.0;
+    double heading  = 0.0;
+
+    std::string svpFilename;
+    CarisSvpFile svps;
+
+    int index;
+
+    while((index=getopt(argc,argv,"c:o:m:x:y:z:r:p:h:s:"))!=-1)
+    {
+        switch(index)
+        {
+            case 'c':
+                if(sscanf(optarg,"%lf", &cellSize) != 1 || cellSize <= 0)
+                {
+                    std::cerr << "Invalid cell size (-c)" << std::endl;
+                    printUsage();
+                }
+            break;
+
+            case 'o':
+                storeDirectory = optarg;
+            break;
+
+            case 'm':
+                if(sscanf(optarg,"%u", &maxMappedTiles) != 1 || maxMappedTiles == 0)
+                {
+                    std::cerr << "Invalid number of mapped tiles (-m)" << std::endl;
+                    printUsage();
+                }
+            break;
+
+            case 'x':
+                if(sscanf(optarg,"%lf", &leverArmX) != 1)
+                {
+                    std::cerr << "Invalid lever arm X offset (-x)" << std::endl;
+                    printUsage();
+                }
+            break;
+
+            case 'y':
+                if(sscanf(optarg,"%lf", &leverArmY) != 1)
+                {
+                    std::cerr << "Invalid lever arm Y offset (-y)" << std::endl;
+                    printUsage();
+                }
+            break;
+
+            case 'z':
+                if(sscanf(optarg,"%lf", &leverArmZ) != 1)
+                {
+                    std::cerr << "Invalid lever arm Z offset (-z)" << std::endl;
+                    printUsage();
+                }
+            break;
+
+            case 'r':
+                if(sscanf(optarg,"%lf", &roll) != 1)
+                {
+                    std::cerr << "Invalid roll angle offset (-r)" << std::endl;
+                    printUsage();
+                }
+            break;
+
+            case 'p':
+                if(sscanf(optarg,"%lf", &pitch) != 1)
+                {
+                    std::cerr << "Invalid pitch angle offset (-p)" << std::endl;
+                    printUsage();
+                }
+            break;
+
+            case 'h':
+                if(sscanf(optarg,"%lf", &heading) != 1)
+                {
+                    std::cerr << "Invalid heading angle offset (-h)" << std::endl;
+                    printUsage();
+                }
+            break;
+
+            case 's':
+                svpFilename = optarg;
+                if(!svps.readSvpFile(svpFilename))
+                {
+                    std::cerr << "Invalid SVP file (-s)" << std::endl;
+                    printUsage();
+                }
+            break;
+        }
+    }
+
+    try
+    {
+        std::ifstream inFile(fileName);
+
+        if(!inFile)
+        {
+            throw new Exception("File not found: " + fileName);
+        }
+
+        GeoreferencingLGF lgf;
+        SvpNearestByTime svpStrategy;
+        DtmGrid grid(cellSize);
+        DtmGridStore * store = NULL;
+
+        if(!storeDirectory.empty())
+        {
+            store = new DtmGridStore(storeDirectory, cellSize, maxMappedTiles);
+
+            //a store keeps its origin, so lines gridded later share the same frame
+            if(store->hasOrigin())
+            {
+                lgf.setCentroid(store->getOrigin());
+            }
+        }
+
+        DatagramGridder gridder(lgf, svpStrategy, store ? (DtmGridWriter &) *store : (DtmGridWriter &) grid);
+
+        std::cerr << "[+] Decoding " << fileName << std::endl;
+
+        DatagramParser * parser = DatagramParserFactory::build(fileName,gridder);
+        parser->parse(fileName);
+
+        //Lever arm
+        Eigen::Vector3d leverArm;
+        leverArm << leverArmX,leverArmY,leverArmZ;
+
+        //Boresight
+        Attitude boresightAngles(0,roll,pitch,heading);
+        Eigen::Matrix3d boresight;
+        Boresight::buildMatrix(boresight,boresightAngles);
+
+        gridder.georeference(leverArm, boresight, svps.getSvps());
+
+        if(store)
+        {
+            store->flush();
+            std::cerr << "[+] " << gridder.getNumberOfSoundings() << " soundings in " << store->getNumberOfTiles() << " tiles stored in " << storeDirectory << std::endl;
+            delete store;
+        }
+        else
+        {
+            std::cerr << "[+] " << gridder.getNumberOfSoundings() << " soundings in " << grid.getNumberOfCells() << " cells, " << grid.getNumberOfTiles() << " tiles" << std::endl;
+            STATS_STAGE(STATS_OUTPUT);
+            STATS_COUNT(STATS_POINTS_WRITTEN, grid.getNumberOfCells());
+            grid.writeXyz(std::cout);
+        }
+
+        delete parser;
+    }
+    catch(Exception * error)
+    {
+        std::cerr << "[-] Error while parsing " << fileName << ": " << error->what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
+
+#endif
@@ -22,6 +22,7 @@
 #include "../svp/SvpNearestByTime.hpp"
 #include "../svp/SvpNearestByLocation.hpp"
 #include "../math/CartesianToGeodeticFukushima.hpp"
+#include "../utils/Stats.hpp"
 
 using namespace std;
 
@@ -31,11 +32,13 @@ void printUsage(){
 NAME\n\n\
 	georeference - Produces a georeferenced point cloud from binary multibeam echosounder datagrams files\n\n\
 SYNOPSIS\n \
-	georeference [-x lever_arm_x] [-y lever_arm_y] [-z lever_arm_z] [-r roll_angle] [-p pitch_angle] [-h heading_angle] [-s svp_file] [-S svpStrategy] file\n\n\
+	georeference [-x lever_arm_x] [-y lever_arm_y] [-z lever_arm_z] [-r roll_angle] [-p pitch_angle] [-h heading_angle] [-d transducer_draft] [-s svp_file] [-S svpStrategy] [-m mode] [--stats[=file.json]] file\n\n\
 DESCRIPTION\n \
 	-L Use a local geographic frame (NED)\n \
 	-T Use a terrestrial geographic frame (WGS84 ECEF)\n \
-        -S choose one: nearestTime or nearestLocation\n\n \
+        -S choose one: nearestTime or nearestLocation\n \
+        -m choose one: raytrace (default), sonar to use the soundings the sonar raytraced (Kongsberg XYZ 88) without raytracing,\n \
+           or compare to raytrace and compare with the soundings of the sonar\n\n \
 Copyright 2017-2019 © Centre Interdisciplinaire de développement en Cartographie des Océans (CIDCO), Tous droits réservés" << std::endl;
 	exit(1);
 }
@@ -47,6 +50,8 @@ Copyright 2017-2019 © Centre Interdisciplinaire de développement en Cartograph
   * @param argv value of the arguments
   */
 int main (int argc , char ** argv){
+    Stats::parseArguments(argc, argv);
+
 
 #ifdef __GNU__
 	setenv("TZ", "UTC", 1);
@@ -69,6 +74,9 @@ int main (int argc , char ** argv){
         double leverArmY = 0.0;
         double leverArmZ = 0.0;
 
+        //draft
+        double transducerDraft = 0.0;
+
         //Boresight
         double roll     = 0.0;
         double pitch    = 0.0;
@@ -78,6 +86,10 @@ int main (int argc , char ** argv){
         std::string userSelectedStrategy;
         SvpSelectionStrategy * svpStrategy = NULL;
 
+        //Sounding source
+        std::string userSelectedMode;
+        GeoreferencingMode mode = GEOREFERENCE_RAYTRACE;
+
         //Georeference method
         Georeferencing * georef = NULL;
         CartesianToGeodeticFukushima * cartesian2geographic = NULL;
@@ -87,7 +99,7 @@ int main (int argc , char ** argv){
 
         int index;
 
-        while((index=getopt(argc,argv,"x:y:z:r:p:h:s:S:LTg"))!=-1)
+        while((index=getopt(argc,argv,"x:y:z:r:p:h:d:s:S:m:LTg"))!=-1)
         {
             switch(index)
             {
@@ -139,6 +151,14 @@ int main (int argc , char ** argv){
                     }
                 break;
 
+                case 'd':
+                    if (sscanf(optarg, "%lf", &transducerDraft) != 1)
+                    {
+                        std::cerr << "Invalid transducer draft (-d)" << std::endl;
+                        printUsage();
+                    }
+                break;
+
 		case 's':
 			svpFilename = optarg;
 			if(!svps.readSvpFile(svpFilename)){
@@ -164,6 +184,26 @@ int main (int argc , char ** argv){
                         }
                         break;
 
+                case 'm':
+                        userSelectedMode = optarg;
+                        if(userSelectedMode == "raytrace") {
+                            mode = GEOREFERENCE_RAYTRACE;
+                        } else if(userSelectedMode == "sonar") {
+                            std::cerr << "[+] Using the soundings raytraced by the sonar" << std::endl;
+                            mode = GEOREFERENCE_SONAR;
+                        } else if(userSelectedMode == "compare") {
+                            std::cerr << "[+] Comparing raytraced beams with the soundings raytraced by the sonar" << std::endl;
+                            mode = GEOREFERENCE_COMPARE;
+                        } else {
+                            std::cerr << "Invalid mode (-m): " << userSelectedMode << std::endl;
+                            std::cerr << "Possible choices are:" << std::endl;
+                            std::cerr << "-m raytrace" << std::endl;
+                            std::cerr << "-m sonar" << std::endl;
+                            std::cerr << "-m compare" << std::endl;
+                            printUsage();
+                        }
+                        break;
+
                 case 'L':
                     georef = new GeoreferencingLGF();
                 break;
@@ -194,6 +234,8 @@ int main (int argc , char ** argv){
         {
             DatagramParser * parser = NULL;
             DatagramGeoreferencer  printer(*georef, *svpStrategy);
+            printer.setMode(mode);
+            printer.setTransducerDraft(transducerDraft);
             if(cart2geo) {
                 printer.setCart2Geo(cartesian2geographic);
             }
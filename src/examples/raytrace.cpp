@@ -21,6 +21,7 @@
 #include "../svp/CarisSvpFile.hpp"
 #include "../datagrams/DatagramParserFactory.hpp"
 #include "../math/Boresight.hpp"
+#include "../utils/Stats.hpp"
 
 
 void printUsage() {
@@ -28,7 +29,7 @@ void printUsage() {
 NAME\n\n\
 	ray - Produces raytraced vectors for each layer in SVP \n\n\
 SYNOPSIS\n \
-	ray [-t twoWayTravelTime] [-s surfaceSoundSpeed] [-b acrossTrackAngleDegrees] [-i alongTrackAngleDegrees] [-r roll_angle] [-p pitch_angle] [-h heading_angle] [-e boresight_roll_angle] [-f boresight_pitch_angle] [-g boresight_heading_angle] [-d transducer_depth] svpfile\n\n\
+	ray [-t twoWayTravelTime] [-s surfaceSoundSpeed] [-b acrossTrackAngleDegrees] [-i alongTrackAngleDegrees] [-r roll_angle] [-p pitch_angle] [-h heading_angle] [-e boresight_roll_angle] [-f boresight_pitch_angle] [-g boresight_heading_angle] [-d transducer_depth] [--stats[=file.json]] svpfile\n\n\
 \n \
 Copyright 2017-2021 © Centre Interdisciplinaire de développement en Cartographie des Océans (CIDCO), Tous droits réservés" << std::endl;
 
@@ -40,6 +41,8 @@ Copyright 2017-2021 © Centre Interdisciplinaire de développement en Cartograph
  * @param argv value of the arguments
  */
 int main(int argc, char ** argv) {
+    Stats::parseArguments(argc, argv);
+
 
 
 #ifdef __GNU__
@@ -0,0 +1,139 @@
+/*
+ *  Copyright 2020 © Centre Interdisciplinaire de développement en Cartographie des Océans (CIDCO), Tous droits réservés
+ */
+#ifndef SIDESCANMOSAIC_CPP
+#define SIDESCANMOSAIC_CPP
+
+#ifdef _WIN32
+#include "../utils/getopt.h"
+#pragma comment(lib, "Ws2_32.lib")
+#else
+#include <unistd.h>
+#endif
+
+#include <iostream>
+#include <string>
+#include <cstdio>
+#include "../datagrams/DatagramParserFactory.hpp"
+#include "../sidescan/SidescanMosaic.hpp"
+#include "../sidescan/SidescanMosaicker.hpp"
+#include "../utils/Exception.hpp"
+#include "../utils/Stats.hpp"
+
+/**Write the information about the program*/
+void printUsage(){
+	std::cerr << "\n\
+NAME\n\n\
+	sidescan-mosaic - Produces a sidescan mosaic from binary sidescan datagrams files\n\n\
+SYNOPSIS\n \
+	sidescan-mosaic [-r resolution] [-b last|max|average] [-t threads] [--stats[=file.json]] file\n\n\
+DESCRIPTION\n \
+	-r Cell size in meters (default: 1)\n \
+	-b How samples falling in the same cell are blended (default: average)\n \
+	-t Number of threads (default: every core)\n\n \
+	Writes \"longitude latitude value\" for every cell of the mosaic\n\n \
+Copyright 2020 © Centre Interdisciplinaire de développement en Cartographie des Océans (CIDCO), Tous droits réservés" << std::endl;
+	exit(1);
+}
+
+/**
+  * declare the parser depending on argument receive
+  *
+  * @param argc number of argument
+  * @param argv value of the arguments
+  */
+int main (int argc , char ** argv){
+    Stats::parseArguments(argc, argv);
+
+
+#ifdef __GNU__
+	setenv("TZ", "UTC", 1);
+#endif
+#ifdef _WIN32
+	putenv("TZ");
+#endif
+    if(argc < 2)
+    {
+        printUsage();
+    }
+
+    std::string fileName(argv[argc-1]);
+
+    double resolution = 1.0;
+    MosaicBlending blending = BLEND_AVERAGE;
+    unsigned int nbThreads = 0;
+
+    int index;
+
+    while((index=getopt(argc,argv,"r:b:t:"))!=-1)
+    {
+        switch(index)
+        {
+            case 'r':
+                if(sscanf(optarg,"%lf", &resolution) != 1 || resolution <= 0)
+                {
+                    std::cerr << "Invalid resolution (-r)" << std::endl;
+                    printUsage();
+                }
+            break;
+
+            case 'b':
+            {
+                std::string mode(optarg);
+
+                if(mode == "last"){
+                    blending = BLEND_LAST;
+                }
+                else if(mode == "max"){
+                    blending = BLEND_MAX;
+                }
+                else if(mode == "average"){
+                    blending = BLEND_AVERAGE;
+                }
+                else{
+                    std::cerr << "Invalid blending mode (-b): " << mode << std::endl;
+                    printUsage();
+                }
+            }
+            break;
+
+            case 't':
+                if(sscanf(optarg,"%u", &nbThreads) != 1)
+                {
+                    std::cerr << "Invalid number of threads (-t)" << std::endl;
+                    printUsage();
+                }
+            break;
+        }
+    }
+
+    try
+    {
+        SidescanMosaic mosaic(resolution, blending);
+        SidescanMosaicker mosaicker(mosaic, nbThreads);
+
+        std::cerr << "[+] Decoding " << fileName << std::endl;
+
+        DatagramParser * parser = DatagramParserFactory::build(fileName,mosaicker);
+        parser->parse(fileName);
+        mosaicker.flush();
+
+        std::cerr << "[+] " << mosaicker.getNumberOfPings() << " pings, " << mosaicker.getNumberOfSamples() << " samples in " << mosaic.getNumberOfTiles() << " tiles" << std::endl;
+
+        {
+            STATS_STAGE(STATS_OUTPUT);
+            mosaic.writeXyz(std::cout);
+        }
+
+        delete parser;
+    }
+    catch(Exception * error)
+    {
+        std::cerr << "[-] Error while parsing " << fileName << ": " << error->what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
+
+#endif
@@ -0,0 +1,245 @@
+/*
+ *  Copyright 2020 © Centre Interdisciplinaire de développement en Cartographie des Océans (CIDCO), Tous droits réservés
+ */
+#ifndef SURVEYOVERLAP_CPP
+#define SURVEYOVERLAP_CPP
+
+#ifdef _WIN32
+#include "../utils/getopt.h"
+#else
+#include <unistd.h>
+#endif
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <atomic>
+#include <thread>
+#include <Eigen/Dense>
+#include "../Position.hpp"
+#include "../math/CoordinateTransform.hpp"
+#include "../filter/PointBatch.hpp"
+#include "../geometry/SurveyOverlap.hpp"
+#include "../utils/PointTextReader.hpp"
+#include "../utils/Exception.hpp"
+#include "../utils/Stats.hpp"
+
+/**Write the information about the program*/
+void printUsage(){
+	std::cerr << "\n\
+NAME\n\n\
+	survey-overlap - Finds every pair of overlapping survey lines\n\n\
+SYNOPSIS\n \
+	survey-overlap [-g] [-t threads] [--stats[=file.json]] file1 file2 ...\n\n\
+DESCRIPTION\n \
+	Each file holds the \"x y z quality intensity\" points of a line, as written by georeference, in the same horizontal frame.\n \
+	-g The points are \"longitude latitude height\", as written by georeference -g\n \
+	-t Number of threads (default: every core)\n\n \
+	Writes \"file1 file2 area points1 points2\" for each pair of lines whose convex hulls overlap, with the number of points of\n \
+	each line inside the hull of the other\n\n \
+Copyright 2020 © Centre Interdisciplinaire de développement en Cartographie des Océans (CIDCO), Tous droits réservés" << std::endl;
+	exit(1);
+}
+
+/**Converts geographic points to north and east, in meters, in the local geodetic frame of an origin*/
+class LocalFrame {
+public:
+
+    LocalFrame(double longitude, double latitude, double height) {
+        Position origin(0, latitude, longitude, height);
+        CoordinateTransform::getPositionECEF(originECEF, origin);
+        CoordinateTransform::getTerrestialToLocalGeodeticReferenceFrameMatrix(trf2lgf, origin);
+    }
+
+    void convert(PointBatch & batch) {
+        for (unsigned int i = 0; i < batch.size(); i++) {
+            Position position(0, batch.y[i], batch.x[i], batch.z[i]);
+            Eigen::Vector3d ned;
+            CoordinateTransform::getPositionInNavigationFrame(ned, position, trf2lgf, originECEF);
+            batch.x[i] = ned(0);
+            batch.y[i] = ned(1);
+        }
+    }
+
+private:
+
+    Eigen::Vector3d originECEF;
+
+    Eigen::Matrix3d trf2lgf;
+};
+
+/**
+  * Reads a line in batches, handing each batch to a pass
+  *
+  * @param fileName the file of the line
+  * @param frame converts geographic points, NULL for projected points
+  * @param pass called with each batch
+  */
+template<typename Pass>
+void readLine(const std::string & fileName, LocalFrame * frame, Pass pass){
+    FILE * file = fopen(fileName.c_str(), "r");
+
+    if(!file)
+    {
+        std::cerr << "[-] Cannot open " << fileName << std::endl;
+        return;
+    }
+
+    PointTextReader reader(file);
+    PointBatch batch;
+
+    while(reader.read(batch, 65536))
+    {
+        if(frame)
+        {
+            frame->convert(batch);
+        }
+
+        pass(batch);
+    }
+
+    fclose(file);
+}
+
+/**
+  * Runs a task for each line, on several threads
+  *
+  * @param nbLines number of lines
+  * @param nbThreads number of threads
+  * @param task called with the index of each line
+  */
+template<typename Task>
+void forEachLine(unsigned int nbLines, unsigned int nbThreads, Task task){
+    std::atomic<unsigned int> next(0);
+    std::vector<std::thread> workers;
+
+    for(unsigned int t = 0; t < nbThreads; t++)
+    {
+        workers.push_back(std::thread([&next, &task, nbLines]() {
+            for(unsigned int line = next++; line < nbLines; line = next++)
+            {
+                task(line);
+            }
+        }));
+    }
+
+    for(auto i = workers.begin(); i != workers.end(); i++)
+    {
+        i->join();
+    }
+}
+
+/**
+  * declare the parser depending on argument receive
+  *
+  * @param argc number of argument
+  * @param argv value of the arguments
+  */
+int main (int argc , char ** argv){
+    Stats::parseArguments(argc, argv);
+
+    bool geographic = false;
+    unsigned int nbThreads = 0;
+
+    int index;
+
+    while((index=getopt(argc,argv,"gt:"))!=-1)
+    {
+        switch(index)
+        {
+            case 'g':
+                geographic = true;
+            break;
+
+            case 't':
+                if(sscanf(optarg,"%u", &nbThreads) != 1)
+                {
+                    std::cerr << "Invalid number of threads (-t)" << std::endl;
+                    printUsage();
+                }
+            break;
+        }
+    }
+
+    if(argc - optind < 2)
+    {
+        printUsage();
+    }
+
+    if(nbThreads == 0)
+    {
+        nbThreads = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    std::vector<std::string> fileNames(argv + optind, argv + argc);
+    SurveyOverlap survey(nbThreads);
+
+    for(auto i = fileNames.begin(); i != fileNames.end(); i++)
+    {
+        survey.addLine(*i);
+    }
+
+    //every line shares the frame of the first point of the first line
+    FILE * first = fopen(fileNames[0].c_str(), "r");
+    PointBatch firstPoint;
+
+    if(first)
+    {
+        PointTextReader reader(first);
+        reader.read(firstPoint, 1);
+        fclose(first);
+    }
+
+    if(firstPoint.size() == 0)
+    {
+        std::cerr << "[-] No point in " << fileNames[0] << std::endl;
+        return 1;
+    }
+
+    LocalFrame * frame = NULL;
+
+    if(geographic)
+    {
+        frame = new LocalFrame(firstPoint.x[0], firstPoint.y[0], firstPoint.z[0]);
+        survey.setOrigin(0, 0);
+    }
+    else
+    {
+        survey.setOrigin(firstPoint.x[0], firstPoint.y[0]);
+    }
+
+    std::cerr << "[+] Computing the hulls of " << fileNames.size() << " lines" << std::endl;
+
+    forEachLine(fileNames.size(), nbThreads, [&](unsigned int line) {
+        readLine(fileNames[line], frame, [&](PointBatch & batch) {
+            survey.addPoints(line, &batch.x[0], &batch.y[0], batch.size());
+        });
+
+        survey.closeLine(line);
+    });
+
+    survey.findOverlaps();
+
+    std::cerr << "[+] " << survey.getNumberOfCandidatePairs() << " pairs with overlapping bounding boxes, " << survey.getOverlaps().size() << " overlapping" << std::endl;
+
+    forEachLine(fileNames.size(), nbThreads, [&](unsigned int line) {
+        if(survey.hasOverlap(line))
+        {
+            readLine(fileNames[line], frame, [&](PointBatch & batch) {
+                survey.countPoints(line, &batch.x[0], &batch.y[0], batch.size());
+            });
+        }
+    });
+
+    {
+        STATS_STAGE(STATS_OUTPUT);
+        survey.writeReport(std::cout);
+    }
+
+    delete frame;
+
+    return 0;
+}
+
+#endif
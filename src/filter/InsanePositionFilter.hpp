@@ -39,10 +39,30 @@ public:
   * @param intensity intensity of the point
   */
   bool filterPoint(uint64_t microEpoch,double x,double y,double z, uint32_t quality,uint32_t intensity){
-    bool insaneX = ((x>1.00*100000000)||(x<-1.00*100000000));
-    bool insaneY = ((y>1.00*100000000)||(y<-1.00*100000000));
-    bool insaneZ = ((z>1.00*100000000)||(z<-1.00*100000000));
-    return (insaneX||insaneY||insaneZ);
+    return (isInsane(x)||isInsane(y)||isInsane(z));
+  }
+
+  /**
+  * Sets the bits of the points whose position seems insane
+  *
+  * @param batch the points
+  * @param mask the rejection mask, reset to the size of the batch
+  */
+  void filterBatch(PointBatch & batch, PointMask & mask){
+    const double * x = batch.x.data();
+    const double * y = batch.y.data();
+    const double * z = batch.z.data();
+
+    mask.rejectIf([x, y, z](unsigned int i){
+      return isInsane(x[i]) | isInsane(y[i]) | isInsane(z[i]);
+    });
+  }
+
+private:
+
+  /**Returns true if a coordinate is beyond 100000000 either way*/
+  static bool isInsane(double coordinate){
+    return (coordinate>1.00*100000000)||(coordinate<-1.00*100000000);
   }
 };
 
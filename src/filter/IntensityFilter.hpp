@@ -45,6 +45,20 @@ public:
     return intensity < minimumIntensity;
   }
 
+  /**
+  * Sets the bits of the points with an intensity lower than the minimum accepted
+  *
+  * @param batch the points
+  * @param mask the rejection mask, reset to the size of the batch
+  */
+  void filterBatch(PointBatch & batch, PointMask & mask){
+    const uint32_t * intensity = batch.intensity.data();
+
+    mask.rejectIf([intensity, this](unsigned int i){
+      return intensity[i] < minimumIntensity;
+    });
+  }
+
 private:
 
   /**Minimal intensity accepted*/
@@ -0,0 +1,73 @@
+/*
+* Copyright 2020 © Centre Interdisciplinaire de développement en Cartographie des Océans (CIDCO), Tous droits réservés
+*/
+
+#ifndef POINTBATCH_HPP
+#define POINTBATCH_HPP
+
+#include <cstdint>
+#include <vector>
+
+/*!
+* \brief A batch of points, one array per field
+*
+* The arrays keep their capacity when the batch is cleared, so a batch is reused from one block of input to the next.
+*/
+class PointBatch {
+public:
+
+    /**Removes every point*/
+    void clear() {
+        microEpochs.clear();
+        x.clear();
+        y.clear();
+        z.clear();
+        quality.clear();
+        intensity.clear();
+    }
+
+    /**Reserves room for a number of points*/
+    void reserve(unsigned int nbPoints) {
+        microEpochs.reserve(nbPoints);
+        x.reserve(nbPoints);
+        y.reserve(nbPoints);
+        z.reserve(nbPoints);
+        quality.reserve(nbPoints);
+        intensity.reserve(nbPoints);
+    }
+
+    /**Appends a point*/
+    void add(uint64_t microEpoch, double px, double py, double pz, uint32_t pquality, uint32_t pintensity) {
+        microEpochs.push_back(microEpoch);
+        x.push_back(px);
+        y.push_back(py);
+        z.push_back(pz);
+        quality.push_back(pquality);
+        intensity.push_back(pintensity);
+    }
+
+    /**Returns the number of points*/
+    unsigned int size() {
+        return x.size();
+    }
+
+    /**Timestamps of the points*/
+    std::vector<uint64_t> microEpochs;
+
+    /**x positions of the points*/
+    std::vector<double> x;
+
+    /**y positions of the points*/
+    std::vector<double> y;
+
+    /**z positions of the points*/
+    std::vector<double> z;
+
+    /**Qualities of the points*/
+    std::vector<uint32_t> quality;
+
+    /**Intensities of the points*/
+    std::vector<uint32_t> intensity;
+};
+
+#endif /* POINTBATCH_HPP */
@@ -5,9 +5,17 @@
 #ifndef POINTFILTER_HPP
 #define POINTFILTER_HPP
 
+#include <cstdint>
+#include "PointBatch.hpp"
+#include "PointMask.hpp"
+
 /*!
 * \brief Point filter class
 * \author Guillaume Labbe-Morissette
+*
+* Filters answer one point at a time with filterPoint(), or a whole batch at once with filterBatch().
+* The default filterBatch() calls filterPoint() on each point not rejected yet, so a filter only
+* implementing filterPoint() works in batches too.
 */
 class PointFilter{
 public:
@@ -18,7 +26,7 @@ public:
   }
 
   /**Destroys the point filter*/
-  ~PointFilter(){
+  virtual ~PointFilter(){
 
   }
 
@@ -33,6 +41,22 @@ public:
   * @param intensity intensity of the point
   */
   virtual bool filterPoint(uint64_t microEpoch,double x,double y,double z, uint32_t quality,uint32_t intensity) = 0;
+
+  /**
+  * Sets the bits of the points we remove. Bits already set stay set
+  *
+  * @param batch the points
+  * @param mask the rejection mask, reset to the size of the batch
+  */
+  virtual void filterBatch(PointBatch & batch, PointMask & mask){
+    unsigned int nbPoints = batch.size();
+
+    for(unsigned int i = 0; i < nbPoints; i++){
+      if(!mask.isRejected(i) && filterPoint(batch.microEpochs[i],batch.x[i],batch.y[i],batch.z[i],batch.quality[i],batch.intensity[i])){
+        mask.reject(i);
+      }
+    }
+  }
 };
 
 #endif
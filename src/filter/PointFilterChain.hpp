@@ -0,0 +1,87 @@
+/*
+* Copyright 2020 © Centre Interdisciplinaire de développement en Cartographie des Océans (CIDCO), Tous droits réservés
+*/
+
+#ifndef POINTFILTERCHAIN_HPP
+#define POINTFILTERCHAIN_HPP
+
+#include <vector>
+#include "PointFilter.hpp"
+
+/*!
+* \brief Filters applied one after the other
+*
+* A point is removed if any filter removes it. On a batch, each filter only adds to the mask of the
+* previous ones, and the chain stops as soon as every point of the batch is rejected.
+* A chain is itself a filter, so chains can be nested. It does not own its filters.
+*/
+class PointFilterChain : public PointFilter{
+public:
+
+  /**Creates an empty filter chain*/
+  PointFilterChain(){
+
+  }
+
+  /**Destroys the filter chain*/
+  ~PointFilterChain(){
+
+  }
+
+  /**
+  * Appends a filter to the chain
+  *
+  * @param filter the filter
+  */
+  void add(PointFilter * filter){
+    filters.push_back(filter);
+  }
+
+  /**Returns the number of filters*/
+  unsigned int size(){
+    return filters.size();
+  }
+
+  /**
+  * Returns true if any filter removes this point
+  *
+  * @param microEpoch timestamp of the point
+  * @param x x position of the point
+  * @param y y position of the point
+  * @param z z position of the point
+  * @param quality quality of the point
+  * @param intensity intensity of the point
+  */
+  bool filterPoint(uint64_t microEpoch,double x,double y,double z, uint32_t quality,uint32_t intensity){
+    for(auto i = filters.begin(); i != filters.end(); i++){
+      if((*i)->filterPoint(microEpoch,x,y,z,quality,intensity)){
+        return true;
+      }
+    }
+
+    return false;
+  }
+
+  /**
+  * Sets the bits of the points removed by any filter
+  *
+  * @param batch the points
+  * @param mask the rejection mask, reset to the size of the batch
+  */
+  void filterBatch(PointBatch & batch, PointMask & mask){
+    for(auto i = filters.begin(); i != filters.end(); i++){
+      if(mask.allRejected()){
+        return;
+      }
+
+      (*i)->filterBatch(batch, mask);
+    }
+  }
+
+private:
+
+  /**Filters, in the order they are applied*/
+  std::vector<PointFilter *> filters;
+};
+
+#endif
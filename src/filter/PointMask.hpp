@@ -0,0 +1,116 @@
+/*
+* Copyright 2020 © Centre Interdisciplinaire de développement en Cartographie des Océans (CIDCO), Tous droits réservés
+*/
+
+#ifndef POINTMASK_HPP
+#define POINTMASK_HPP
+
+#include <cstdint>
+#include <vector>
+
+/*!
+* \brief Rejection bitmask of a PointBatch, one bit per point, 64 points per word
+*
+* Bit i of word w is point w * 64 + i. Bits past the last point are always clear.
+*/
+class PointMask {
+public:
+
+    /**Number of points in a word*/
+    static const unsigned int WORD_BITS = 64;
+
+    /**
+    * Clears the mask for a number of points
+    *
+    * @param nbPoints number of points
+    */
+    void reset(unsigned int nbPoints) {
+        this->nbPoints = nbPoints;
+        words.assign((nbPoints + WORD_BITS - 1) / WORD_BITS, 0);
+    }
+
+    /**Returns the number of points*/
+    unsigned int size() {
+        return nbPoints;
+    }
+
+    /**Returns the number of words*/
+    unsigned int getNumberOfWords() {
+        return words.size();
+    }
+
+    /**Returns a word of the mask*/
+    uint64_t & word(unsigned int w) {
+        return words[w];
+    }
+
+    /**Returns the bits of a word that stand for points, all of them except in the last word*/
+    uint64_t getValidBits(unsigned int w) {
+        unsigned int remaining = nbPoints - w * WORD_BITS;
+        return (remaining >= WORD_BITS) ? ~(uint64_t) 0 : (((uint64_t) 1 << remaining) - 1);
+    }
+
+    /**Returns true if a point is rejected*/
+    bool isRejected(unsigned int point) {
+        return (words[point / WORD_BITS] >> (point % WORD_BITS)) & 1;
+    }
+
+    /**Rejects a point*/
+    void reject(unsigned int point) {
+        words[point / WORD_BITS] |= (uint64_t) 1 << (point % WORD_BITS);
+    }
+
+    /**
+    * Rejects the points failing a test, a word at a time. Points already rejected stay rejected
+    *
+    * @param rejects called with the index of each point, returns true to reject it
+    */
+    template<typename Test>
+    void rejectIf(Test rejects) {
+        for (unsigned int w = 0; w < words.size(); w++) {
+            unsigned int first = w * WORD_BITS;
+            unsigned int count = (nbPoints - first < WORD_BITS) ? nbPoints - first : WORD_BITS;
+            uint64_t bits = 0;
+
+            for (unsigned int j = 0; j < count; j++) {
+                bits |= (uint64_t) (rejects(first + j) ? 1 : 0) << j;
+            }
+
+            words[w] |= bits;
+        }
+    }
+
+    /**Returns true if every point is rejected*/
+    bool allRejected() {
+        for (unsigned int w = 0; w < words.size(); w++) {
+            if (words[w] != getValidBits(w)) {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    /**Returns the number of rejected points*/
+    unsigned int getNumberOfRejected() {
+        unsigned int total = 0;
+
+        for (unsigned int w = 0; w < words.size(); w++) {
+            for (uint64_t bits = words[w]; bits; bits &= bits - 1) {
+                total++;
+            }
+        }
+
+        return total;
+    }
+
+private:
+
+    /**Number of points*/
+    unsigned int nbPoints = 0;
+
+    /**Bits, one per point*/
+    std::vector<uint64_t> words;
+};
+
+#endif /* POINTMASK_HPP */
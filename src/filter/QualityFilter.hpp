@@ -44,6 +44,20 @@ public:
     return quality < minimumQuality;
   }
 
+  /**
+  * Sets the bits of the points with a quality lower than the minimum accepted
+  *
+  * @param batch the points
+  * @param mask the rejection mask, reset to the size of the batch
+  */
+  void filterBatch(PointBatch & batch, PointMask & mask){
+    const uint32_t * quality = batch.quality.data();
+
+    mask.rejectIf([quality, this](unsigned int i){
+      return quality[i] < minimumQuality;
+    });
+  }
+
 private:
 
   /**Minimal quality accepted*/
@@ -0,0 +1,359 @@
+/*
+* Copyright 2020 © Centre Interdisciplinaire de développement en Cartographie des Océans (CIDCO), Tous droits réservés
+*/
+
+#ifndef SPATIALOUTLIERFILTER_HPP
+#define SPATIALOUTLIERFILTER_HPP
+
+#include <cstdint>
+#include <cmath>
+#include <vector>
+#include <algorithm>
+#include <unordered_map>
+#include <Eigen/Dense>
+#include "PointFilter.hpp"
+#include "../math/PlaneFitter.hpp"
+#include "../utils/Exception.hpp"
+#include "../utils/WorkerPool.hpp"
+
+/**The surface a cell is compared to*/
+enum OutlierSurface { SURFACE_MEDIAN, SURFACE_PLANE };
+
+/*!
+* \brief Spatial statistical outlier filter
+*
+* Points are binned by (x, y) into square cells of a hashed grid. In each cell, a robust surface is estimated,
+* either the median depth or a plane fitted with PlaneFitter, and the spread around it is measured as
+* 1.4826 times the median absolute deviation, which is sigma for normally distributed depths.
+* Points further than k sigma from the surface are removed.
+*
+* x and y must be horizontal coordinates in the unit of the cell size, such as a local geodetic frame, and z the depth.
+*
+* The filter streams: each batch is judged together with a sliding window of the last accepted points along
+* the track. A cell spanning two batches is thus judged with the points before the batch, but not with the points
+* of the next batch, which are not known yet: the first points of a cell are judged on fewer neighbours.
+* Cells are processed by several threads, kept for the lifetime of the filter.
+*/
+class SpatialOutlierFilter : public PointFilter{
+public:
+
+  /**
+  * Creates a spatial outlier filter
+  *
+  * @param cellSize size of a cell, in the unit of x and y
+  * @param k number of sigmas beyond which a point is removed
+  * @param surface the surface points are compared to
+  * @param minimumPoints cells with fewer points are not filtered
+  * @param windowSize number of accepted points kept from previous batches
+  * @param nbThreads number of threads, 0 to use every core
+  * @param minimumSigma lowest sigma, so a cell of identical depths does not reject every other depth
+  */
+  SpatialOutlierFilter(double cellSize, double k = 3.0, OutlierSurface surface = SURFACE_MEDIAN, unsigned int minimumPoints = 5, unsigned int windowSize = 20000, unsigned int nbThreads = 0, double minimumSigma = 0.01)
+  : cellSize(cellSize), k(k), surface(surface), minimumPoints(minimumPoints), windowSize(windowSize), pool(nbThreads), minimumSigma(minimumSigma){
+    if(cellSize <= 0){
+      throw new Exception("Outlier filter cell size must be positive");
+    }
+
+    //a plane needs three points
+    if(surface == SURFACE_PLANE && this->minimumPoints < 3){
+      this->minimumPoints = 3;
+    }
+  }
+
+  /**Destroys the spatial outlier filter*/
+  ~SpatialOutlierFilter(){
+
+  }
+
+  /**
+  * Returns true if the point is an outlier. The point is judged as a batch of one, against the window
+  *
+  * @param microEpoch timestamp of the point
+  * @param x x position of the point
+  * @param y y position of the point
+  * @param z z position of the point
+  * @param quality quality of the point
+  * @param intensity intensity of the point
+  */
+  bool filterPoint(uint64_t microEpoch,double x,double y,double z, uint32_t quality,uint32_t intensity){
+    PointBatch single;
+    single.add(microEpoch,x,y,z,quality,intensity);
+
+    PointMask mask;
+    mask.reset(1);
+    filterBatch(single,mask);
+
+    return mask.isRejected(0);
+  }
+
+  /**
+  * Sets the bits of the outliers of a batch. Points already rejected are not used
+  *
+  * @param batch the points
+  * @param mask the rejection mask, reset to the size of the batch
+  */
+  void filterBatch(PointBatch & batch, PointMask & mask){
+    unsigned int nbBatch = batch.size();
+    unsigned int nbWindow = windowX.size();
+
+    buildCellIndex(batch, mask);
+
+    unsigned int nbCells = cellStart.size() - 1;
+
+    outlier.assign(nbBatch, 0);
+
+    //a few cells are not worth a thread
+    unsigned int threads = std::min(pool.getNumberOfThreads(), std::max(1u, nbCells / 16));
+
+    if(threads == 1){
+      filterCells(0, nbCells, batch, nbWindow);
+    }
+    else{
+      pool.run(threads, [this, &batch, nbCells, nbWindow, threads](unsigned int t){
+        unsigned int first = (uint64_t) nbCells * t / threads;
+        unsigned int last = (uint64_t) nbCells * (t + 1) / threads;
+        filterCells(first, last, batch, nbWindow);
+      });
+    }
+
+    for(unsigned int i = 0; i < nbBatch; i++){
+      if(outlier[i]){
+        mask.reject(i);
+      }
+      else if(!mask.isRejected(i)){
+        windowX.push_back(batch.x[i]);
+        windowY.push_back(batch.y[i]);
+        windowZ.push_back(batch.z[i]);
+      }
+    }
+
+    if(windowX.size() > windowSize){
+      unsigned int excess = windowX.size() - windowSize;
+      windowX.erase(windowX.begin(), windowX.begin() + excess);
+      windowY.erase(windowY.begin(), windowY.begin() + excess);
+      windowZ.erase(windowZ.begin(), windowZ.begin() + excess);
+    }
+  }
+
+private:
+
+  /**Marks no cell*/
+  static const unsigned int NO_CELL = 0xFFFFFFFF;
+
+  /**Returns the key of the cell holding a position*/
+  uint64_t getCellKey(double x, double y){
+    int32_t column = (int32_t) std::floor(x / cellSize);
+    int32_t row = (int32_t) std::floor(y / cellSize);
+    return ((uint64_t) (uint32_t) column << 32) | (uint32_t) row;
+  }
+
+  /**
+  * Groups the points of the batch and of the window by cell. Only the cells holding batch points are kept.
+  * Point i < nbBatch is batch point i, point nbBatch + j is window point j
+  */
+  void buildCellIndex(PointBatch & batch, PointMask & mask){
+    unsigned int nbBatch = batch.size();
+    unsigned int nbWindow = windowX.size();
+
+    cellIds.clear();
+    cellOf.assign(nbBatch + nbWindow, (unsigned int) NO_CELL);
+
+    for(unsigned int i = 0; i < nbBatch; i++){
+      if(mask.isRejected(i)){
+        continue;
+      }
+
+      auto inserted = cellIds.insert(std::make_pair(getCellKey(batch.x[i], batch.y[i]), (unsigned int) cellIds.size()));
+      cellOf[i] = inserted.first->second;
+    }
+
+    for(unsigned int j = 0; j < nbWindow; j++){
+      auto cell = cellIds.find(getCellKey(windowX[j], windowY[j]));
+
+      if(cell != cellIds.end()){
+        cellOf[nbBatch + j] = cell->second;
+      }
+    }
+
+    //counting sort of the points by cell
+    cellStart.assign(cellIds.size() + 1, 0);
+
+    for(unsigned int i = 0; i < cellOf.size(); i++){
+      if(cellOf[i] != NO_CELL){
+        cellStart[cellOf[i] + 1]++;
+      }
+    }
+
+    for(unsigned int c = 0; c < cellIds.size(); c++){
+      cellStart[c + 1] += cellStart[c];
+    }
+
+    cellPoints.resize(cellStart.back());
+    std::vector<unsigned int> next(cellStart.begin(), cellStart.end() - 1);
+
+    for(unsigned int i = 0; i < cellOf.size(); i++){
+      if(cellOf[i] != NO_CELL){
+        cellPoints[next[cellOf[i]]++] = i;
+      }
+    }
+  }
+
+  /**Finds the outliers of a range of cells. Cells hold distinct points, so ranges can be processed concurrently*/
+  void filterCells(unsigned int firstCell, unsigned int lastCell, PointBatch & batch, unsigned int nbWindow){
+    unsigned int nbBatch = batch.size();
+    std::vector<double> deviations;
+    std::vector<double> scratch;
+
+    for(unsigned int c = firstCell; c < lastCell; c++){
+      unsigned int first = cellStart[c];
+      unsigned int count = cellStart[c + 1] - first;
+
+      if(count < minimumPoints){
+        continue;
+      }
+
+      deviations.resize(count);
+
+      bool fitted = false;
+
+      if(surface == SURFACE_PLANE){
+        //centered on the first point, for a well conditioned fit
+        unsigned int origin = cellPoints[first];
+        double x0 = getX(origin, batch, nbBatch);
+        double y0 = getY(origin, batch, nbBatch);
+        double z0 = getZ(origin, batch, nbBatch);
+
+        PlaneFitAccumulator accumulator;
+
+        for(unsigned int i = 0; i < count; i++){
+          unsigned int point = cellPoints[first + i];
+          accumulator.add(getX(point, batch, nbBatch) - x0, getY(point, batch, nbBatch) - y0, getZ(point, batch, nbBatch) - z0);
+        }
+
+        Eigen::Vector4d plane;
+        fitted = accumulator.fitPlane(plane);
+
+        if(fitted){
+          for(unsigned int i = 0; i < count; i++){
+            unsigned int point = cellPoints[first + i];
+            deviations[i] = plane(0) * (getX(point, batch, nbBatch) - x0) + plane(1) * (getY(point, batch, nbBatch) - y0) + plane(2) * (getZ(point, batch, nbBatch) - z0) + plane(3);
+          }
+
+          scratch.assign(deviations.begin(), deviations.end());
+          double median = getMedian(scratch);
+
+          for(unsigned int i = 0; i < count; i++){
+            deviations[i] -= median;
+          }
+        }
+      }
+
+      //points along a line do not define a plane, their median does
+      if(!fitted){
+        scratch.resize(count);
+
+        for(unsigned int i = 0; i < count; i++){
+          scratch[i] = getZ(cellPoints[first + i], batch, nbBatch);
+        }
+
+        double median = getMedian(scratch);
+
+        for(unsigned int i = 0; i < count; i++){
+          deviations[i] = getZ(cellPoints[first + i], batch, nbBatch) - median;
+        }
+      }
+
+      scratch.resize(count);
+
+      for(unsigned int i = 0; i < count; i++){
+        scratch[i] = std::fabs(deviations[i]);
+      }
+
+      double sigma = std::max(1.4826 * getMedian(scratch), minimumSigma);
+
+      //only batch points are judged, window points were judged before
+      for(unsigned int i = 0; i < count; i++){
+        unsigned int point = cellPoints[first + i];
+
+        if(point < nbBatch && std::fabs(deviations[i]) > k * sigma){
+          outlier[point] = 1;
+        }
+      }
+    }
+  }
+
+  /**Returns the median of values, reordering them*/
+  static double getMedian(std::vector<double> & values){
+    unsigned int middle = values.size() / 2;
+    std::nth_element(values.begin(), values.begin() + middle, values.end());
+    double median = values[middle];
+
+    if(values.size() % 2 == 0){
+      median = (median + *std::max_element(values.begin(), values.begin() + middle)) / 2;
+    }
+
+    return median;
+  }
+
+  /**Returns x of a batch or window point*/
+  double getX(unsigned int point, PointBatch & batch, unsigned int nbBatch){
+    return (point < nbBatch) ? batch.x[point] : windowX[point - nbBatch];
+  }
+
+  /**Returns y of a batch or window point*/
+  double getY(unsigned int point, PointBatch & batch, unsigned int nbBatch){
+    return (point < nbBatch) ? batch.y[point] : windowY[point - nbBatch];
+  }
+
+  /**Returns z of a batch or window point*/
+  double getZ(unsigned int point, PointBatch & batch, unsigned int nbBatch){
+    return (point < nbBatch) ? batch.z[point] : windowZ[point - nbBatch];
+  }
+
+  /**Size of a cell*/
+  double cellSize;
+
+  /**Number of sigmas beyond which a point is removed*/
+  double k;
+
+  /**The surface points are compared to*/
+  OutlierSurface surface;
+
+  /**Cells with fewer points are not filtered*/
+  unsigned int minimumPoints;
+
+  /**Number of accepted points kept from previous batches*/
+  unsigned int windowSize;
+
+  /**The threads filtering the cells*/
+  WorkerPool pool;
+
+  /**Lowest sigma*/
+  double minimumSigma;
+
+  /**x of the window points*/
+  std::vector<double> windowX;
+
+  /**y of the window points*/
+  std::vector<double> windowY;
+
+  /**z of the window points*/
+  std::vector<double> windowZ;
+
+  /**Dense id of each cell, by key*/
+  std::unordered_map<uint64_t, unsigned int> cellIds;
+
+  /**Cell of each point, NO_CELL if it is not used*/
+  std::vector<unsigned int> cellOf;
+
+  /**First entry of each cell in cellPoints, plus the end*/
+  std::vector<unsigned int> cellStart;
+
+  /**Points, grouped by cell*/
+  std::vector<unsigned int> cellPoints;
+
+  /**Outlier flag of each batch point*/
+  std::vector<uint8_t> outlier;
+};
+
+#endif
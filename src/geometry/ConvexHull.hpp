@@ -0,0 +1,96 @@
+/*
+* Copyright 2019 © Centre Interdisciplinaire de développement en Cartographie des Océans (CIDCO), Tous droits réservés
+*/
+
+ /*
+ * \author Christian Bouchard
+ */
+
+#ifndef CONVEXHULL_HPP
+#define CONVEXHULL_HPP
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include <algorithm>
+
+//-----------------------------------------------------------------------------------
+// Andrew's monotone chain convex hull algorithm
+// Adapted from
+// https://en.wikibooks.org/wiki/Algorithm_Implementation/Geometry/Convex_hull/Monotone_chain#C++
+
+typedef float coord_t;      // coordinate type (Use float because pcl::PointXYZ's coordinates are float)
+typedef double coord2_t;    // must be big enough to hold 2*max(|coordinate|)^2
+
+struct PointAndrews
+{
+	coord_t x;
+    coord_t y;
+    uint64_t index;
+
+	bool operator <( const PointAndrews &p ) const
+    {
+		return x < p.x || (x == p.x && y < p.y);
+	}
+};
+
+
+// 3D cross product of OA and OB vectors, (i.e z-component of their "2D" cross product,
+// but remember that it is not defined in "2D").
+// Returns a positive value, if OAB makes a counter-clockwise turn,
+// negative for clockwise turn, and zero if the points are collinear.
+inline coord2_t cross( const PointAndrews &O, const PointAndrews &A, const PointAndrews &B )
+{
+	return (A.x - O.x) * (B.y - O.y) - (A.y - O.y) * (B.x - O.x);
+}
+
+// Returns a list of points on the convex hull in counter-clockwise order.
+// Note: the last point in the returned list is the same as the first one.
+// CB: vector points is modified by getting sorted.
+inline void AndrewsConvex_hull( std::vector<PointAndrews> & hull, std::vector<PointAndrews> & points )
+{
+	size_t n = points.size(), k = 0;
+
+    hull.clear();
+
+    // Fewer than 3 points enclose no area, in any order. Triangles go through the chain to be counter-clockwise
+    if ( n < 3 )
+    {
+        hull.reserve( n );
+
+        for ( size_t count = 0; count < n; count++ )
+            hull.push_back( points[ count ] );
+
+        return;
+    }
+
+    hull.resize( 2 * n );
+
+	// Sort points lexicographically
+	sort(points.begin(), points.end());
+
+	// Build lower hull
+	for (size_t i = 0; i < n; ++i)
+    {
+		while (k >= 2 && cross(hull[k-2], hull[k-1], points[i]) <= 0)
+            k--;
+
+		hull[k++] = points[i];
+	}
+
+	// Build upper hull
+	for (size_t i = n-1, t = k+1; i > 0; --i)
+    {
+		while (k >= t && cross(hull[k-2], hull[k-1], points[i-1]) <= 0)
+            k--;
+
+		hull[k++] = points[i-1];
+	}
+
+	hull.resize(k-1);
+
+}
+
+//-----------------------------------------------------------------------------------
+
+#endif
@@ -0,0 +1,317 @@
+/*
+* Copyright 2020 © Centre Interdisciplinaire de développement en Cartographie des Océans (CIDCO), Tous droits réservés
+*/
+
+#ifndef HULLGRID_HPP
+#define HULLGRID_HPP
+
+#include <cstdint>
+#include <cmath>
+#include <vector>
+#include <algorithm>
+#include <thread>
+
+/*!
+* \brief Uniform grid over a polygon answering point-in-polygon queries
+*
+* Each cell of the grid covering the bounding box of the polygon is labelled inside, outside or boundary.
+* A cell no edge touches is entirely inside or outside, so only points in boundary cells are tested against
+* the edges. The crossing test casts a ray along y, so it only needs the edges spanning the column of the point.
+* The answers are those of pcl::isXYPointIn2DXYPolygon, which isInPolygon reproduces.
+*/
+class HullGrid {
+public:
+
+    /**
+    * Creates the grid of a polygon
+    *
+    * @param x x of the vertices
+    * @param y y of the vertices
+    * @param cellsPerVertex number of cells per vertex, more cells make fewer points fall in boundary cells
+    */
+    HullGrid(const std::vector<float> & x, const std::vector<float> & y, double cellsPerVertex = 16) : x(x), y(y) {
+        unsigned int nbVertices = x.size();
+
+        if (nbVertices == 0) {
+            minX = maxX = minY = maxY = 0;
+            nbColumns = nbRows = 0;
+            cellSize = 1;
+            return;
+        }
+
+        minX = maxX = x[0];
+        minY = maxY = y[0];
+
+        for (unsigned int i = 1; i < nbVertices; i++) {
+            minX = std::min(minX, (double) x[i]);
+            maxX = std::max(maxX, (double) x[i]);
+            minY = std::min(minY, (double) y[i]);
+            maxY = std::max(maxY, (double) y[i]);
+        }
+
+        //square cells, about cellsPerVertex per vertex, at most 4M
+        double width = std::max(maxX - minX, 1e-9);
+        double height = std::max(maxY - minY, 1e-9);
+        double nbCells = std::min(std::max(1024.0, cellsPerVertex * nbVertices), 4194304.0);
+        cellSize = std::sqrt(width * height / nbCells);
+        cellSize = std::max(cellSize, std::max(width, height) / 4096);
+
+        nbColumns = (unsigned int) (width / cellSize) + 1;
+        nbRows = (unsigned int) (height / cellSize) + 1;
+
+        buildCells();
+    }
+
+    /**Returns true if a point is inside the polygon*/
+    bool isInside(double px, double py) const {
+        if (nbColumns == 0 || px < minX || px > maxX || py < minY || py > maxY) {
+            return false;
+        }
+
+        unsigned int column = getColumn(px);
+        unsigned int cell = getRow(py) * nbColumns + column;
+
+        if (labels[cell] != BOUNDARY) {
+            return labels[cell] == INSIDE;
+        }
+
+        return isInColumn(px, py, column);
+    }
+
+    /**
+    * Finds the points inside the polygon, using several threads
+    *
+    * @param px x of the points
+    * @param py y of the points
+    * @param nbPoints number of points
+    * @param stride distance between two points in px and py, in bytes
+    * @param[out] indices indices of the points inside, in increasing order
+    * @param nbThreads number of threads, 0 to use every core
+    */
+    void findPointsInside(const float * px, const float * py, uint64_t nbPoints, unsigned int stride, std::vector<uint64_t> & indices, unsigned int nbThreads = 0) const {
+        indices.clear();
+
+        if (nbThreads == 0) {
+            nbThreads = std::max(1u, std::thread::hardware_concurrency());
+        }
+
+        //a small cloud is not worth a thread
+        nbThreads = (unsigned int) std::min<uint64_t>(nbThreads, std::max<uint64_t>(1, nbPoints / 65536));
+
+        std::vector< std::vector<uint64_t> > found(nbThreads);
+        std::vector<std::thread> workers;
+
+        for (unsigned int t = 0; t < nbThreads; t++) {
+            uint64_t first = nbPoints * t / nbThreads;
+            uint64_t last = nbPoints * (t + 1) / nbThreads;
+            workers.push_back(std::thread(&HullGrid::findPointsInRange, this, px, py, first, last, stride, std::ref(found[t])));
+        }
+
+        for (auto i = workers.begin(); i != workers.end(); i++) {
+            i->join();
+        }
+
+        for (unsigned int t = 0; t < nbThreads; t++) {
+            indices.insert(indices.end(), found[t].begin(), found[t].end());
+        }
+    }
+
+    /**Returns the number of cells*/
+    unsigned int getNumberOfCells() const {
+        return nbColumns * nbRows;
+    }
+
+    /**Returns the number of boundary cells*/
+    unsigned int getNumberOfBoundaryCells() const {
+        return std::count(labels.begin(), labels.end(), (uint8_t) BOUNDARY);
+    }
+
+    /**
+    * Returns true if a point is inside a polygon, testing every edge like pcl::isXYPointIn2DXYPolygon
+    *
+    * @param px x of the point
+    * @param py y of the point
+    * @param x x of the vertices
+    * @param y y of the vertices
+    */
+    static bool isInPolygon(double px, double py, const std::vector<float> & x, const std::vector<float> & y) {
+        bool inside = false;
+        unsigned int nbVertices = x.size();
+
+        for (unsigned int i = 0; i < nbVertices; i++) {
+            if (crosses(px, py, x[(i + nbVertices - 1) % nbVertices], y[(i + nbVertices - 1) % nbVertices], x[i], y[i])) {
+                inside = !inside;
+            }
+        }
+
+        return inside;
+    }
+
+private:
+
+    /**Label of a cell*/
+    enum { OUTSIDE = 0, INSIDE = 1, BOUNDARY = 2 };
+
+    /**Returns the column of an x inside the bounding box*/
+    unsigned int getColumn(double px) const {
+        return std::min((unsigned int) ((px - minX) / cellSize), nbColumns - 1);
+    }
+
+    /**Returns the row of a y inside the bounding box*/
+    unsigned int getRow(double py) const {
+        return std::min((unsigned int) ((py - minY) / cellSize), nbRows - 1);
+    }
+
+    /**Crossing test of a point against the edges spanning its column, the only edges that can toggle it*/
+    bool isInColumn(double px, double py, unsigned int column) const {
+        unsigned int nbVertices = x.size();
+        bool inside = false;
+
+        for (unsigned int i = columnStart[column]; i < columnStart[column + 1]; i++) {
+            unsigned int e = columnEdges[i];
+            unsigned int previous = (e + nbVertices - 1) % nbVertices;
+
+            if (crosses(px, py, x[previous], y[previous], x[e], y[e])) {
+                inside = !inside;
+            }
+        }
+
+        return inside;
+    }
+
+    /**Returns true if the edge from (xold, yold) to (xnew, ynew) toggles the crossing test, as in pcl::isXYPointIn2DXYPolygon*/
+    static bool crosses(double px, double py, double xold, double yold, double xnew, double ynew) {
+        double x1, x2, y1, y2;
+
+        if (xnew > xold) {
+            x1 = xold;
+            x2 = xnew;
+            y1 = yold;
+            y2 = ynew;
+        }
+        else {
+            x1 = xnew;
+            x2 = xold;
+            y1 = ynew;
+            y2 = yold;
+        }
+
+        return (xnew < px) == (px <= xold) && (py - y1) * (x2 - x1) < (y2 - y1) * (px - x1);
+    }
+
+    /**Lists the edges spanning each column and marks the cells they touch, then labels the other cells by testing their center*/
+    void buildCells() {
+        unsigned int nbVertices = x.size();
+        unsigned int nbCells = nbColumns * nbRows;
+
+        labels.assign(nbCells, OUTSIDE);
+
+        //columns an edge spans, padded by a fraction of a cell against rounding
+        std::vector< std::pair<unsigned int, unsigned int> > spanned;
+        double pad = cellSize * 1e-3;
+
+        for (unsigned int e = 0; e < nbVertices; e++) {
+            unsigned int previous = (e + nbVertices - 1) % nbVertices;
+            double x0 = x[previous], y0 = y[previous], x1 = x[e], y1 = y[e];
+
+            if (x0 > x1) {
+                std::swap(x0, x1);
+                std::swap(y0, y1);
+            }
+
+            unsigned int firstColumn = getColumn(std::max(x0 - pad, minX));
+            unsigned int lastColumn = getColumn(std::min(x1 + pad, maxX));
+
+            for (unsigned int column = firstColumn; column <= lastColumn; column++) {
+                spanned.push_back(std::make_pair(column, e));
+
+                //the part of the edge within the column
+                double left = std::max(x0, minX + column * cellSize - pad);
+                double right = std::min(x1, minX + (column + 1) * cellSize + pad);
+                double yLeft = y0, yRight = y1;
+
+                if (x1 > x0) {
+                    yLeft = y0 + (y1 - y0) * (left - x0) / (x1 - x0);
+                    yRight = y0 + (y1 - y0) * (right - x0) / (x1 - x0);
+                }
+
+                unsigned int firstRow = getRow(std::max(std::min(yLeft, yRight) - pad, minY));
+                unsigned int lastRow = getRow(std::min(std::max(yLeft, yRight) + pad, maxY));
+
+                for (unsigned int row = firstRow; row <= lastRow; row++) {
+                    labels[row * nbColumns + column] = BOUNDARY;
+                }
+            }
+        }
+
+        //counting sort of the edges by column
+        columnStart.assign(nbColumns + 1, 0);
+
+        for (auto i = spanned.begin(); i != spanned.end(); i++) {
+            columnStart[i->first + 1]++;
+        }
+
+        for (unsigned int c = 0; c < nbColumns; c++) {
+            columnStart[c + 1] += columnStart[c];
+        }
+
+        columnEdges.resize(spanned.size());
+        std::vector<unsigned int> next(columnStart.begin(), columnStart.end() - 1);
+
+        for (auto i = spanned.begin(); i != spanned.end(); i++) {
+            columnEdges[next[i->first]++] = i->second;
+        }
+
+        //no edge touches the other cells, so their center tells for all their points
+        for (unsigned int row = 0; row < nbRows; row++) {
+            for (unsigned int column = 0; column < nbColumns; column++) {
+                unsigned int cell = row * nbColumns + column;
+
+                if (labels[cell] != BOUNDARY && isInColumn(minX + (column + 0.5) * cellSize, minY + (row + 0.5) * cellSize, column)) {
+                    labels[cell] = INSIDE;
+                }
+            }
+        }
+    }
+
+    /**Finds the points inside the polygon among the points [first, last)*/
+    void findPointsInRange(const float * px, const float * py, uint64_t first, uint64_t last, unsigned int stride, std::vector<uint64_t> & found) const {
+        for (uint64_t i = first; i < last; i++) {
+            float pointX = *(const float *) ((const char *) px + i * stride);
+            float pointY = *(const float *) ((const char *) py + i * stride);
+
+            if (isInside(pointX, pointY)) {
+                found.push_back(i);
+            }
+        }
+    }
+
+    /**x of the vertices*/
+    std::vector<float> x;
+
+    /**y of the vertices*/
+    std::vector<float> y;
+
+    /**Bounding box of the polygon*/
+    double minX, maxX, minY, maxY;
+
+    /**Size of a cell*/
+    double cellSize;
+
+    /**Number of columns*/
+    unsigned int nbColumns;
+
+    /**Number of rows*/
+    unsigned int nbRows;
+
+    /**Label of each cell, by row then column*/
+    std::vector<uint8_t> labels;
+
+    /**First entry of each column in columnEdges, plus the end*/
+    std::vector<unsigned int> columnStart;
+
+    /**Edges spanning each column, edge e going from vertex e - 1 to vertex e*/
+    std::vector<unsigned int> columnEdges;
+};
+
+#endif /* HULLGRID_HPP */
@@ -35,85 +35,8 @@
 #include <Eigen/Dense>
 #include <Eigen/Geometry> // For cross product
 
-
-//-----------------------------------------------------------------------------------
-// Andrew's monotone chain convex hull algorithm
-// Adapted from
-// https://en.wikibooks.org/wiki/Algorithm_Implementation/Geometry/Convex_hull/Monotone_chain#C++
-
-typedef float coord_t;      // coordinate type (Use float because pcl::PointXYZ's coordinates are float)
-typedef double coord2_t;    // must be big enough to hold 2*max(|coordinate|)^2
-
-struct PointAndrews
-{
-	coord_t x;
-    coord_t y;
-    uint64_t index;
-
-	bool operator <( const PointAndrews &p ) const
-    {
-		return x < p.x || (x == p.x && y < p.y);
-	}
-};
-
-
-// 3D cross product of OA and OB vectors, (i.e z-component of their "2D" cross product,
-// but remember that it is not defined in "2D").
-// Returns a positive value, if OAB makes a counter-clockwise turn,
-// negative for clockwise turn, and zero if the points are collinear.
-coord2_t cross( const PointAndrews &O, const PointAndrews &A, const PointAndrews &B )
-{
-	return (A.x - O.x) * (B.y - O.y) - (A.y - O.y) * (B.x - O.x);
-}
-
-// Returns a list of points on the convex hull in counter-clockwise order.
-// Note: the last point in the returned list is the same as the first one.
-// CB: vector points is modified by getting sorted.
-void AndrewsConvex_hull( std::vector<PointAndrews> & hull, std::vector<PointAndrews> & points )
-{
-	size_t n = points.size(), k = 0;
-
-    hull.clear();
-
-    if ( n <= 3 )
-    {
-        hull.reserve( n );
-
-        for ( int count = 0; count < n; count++ )
-            hull.push_back( points[ count ] );
-
-        return;
-    }
-
-    hull.resize( 2 * n );
-
-	// Sort points lexicographically
-	sort(points.begin(), points.end());
-
-	// Build lower hull
-	for (size_t i = 0; i < n; ++i)
-    {
-		while (k >= 2 && cross(hull[k-2], hull[k-1], points[i]) <= 0)
-            k--;
-
-		hull[k++] = points[i];
-	}
-
-	// Build upper hull
-	for (size_t i = n-1, t = k+1; i > 0; --i)
-    {
-		while (k >= t && cross(hull[k-2], hull[k-1], points[i-1]) <= 0)
-            k--;
-
-		hull[k++] = points[i-1];
-	}
-
-	hull.resize(k-1);
-
-}
-
-//-----------------------------------------------------------------------------------
-
+#include "ConvexHull.hpp"
+#include "HullGrid.hpp"
 
 
 class HullOverlap
@@ -917,14 +840,12 @@ private:
             return;
 
 
-        for ( uint64_t count = 0; count < cloudIn->points.size(); count++ )
-        {
-            if ( pcl::isXYPointIn2DXYPolygon( cloudIn->points[ count ], *hullVertices ) )
-            {
-                cloudOut->push_back( lineOriginal->points[ count ] );
-                indexPointInHull.push_back( count );
-            }
-        }
+        findIndicesInHull( cloudIn, indexPointInHull, hullVertices );
+
+        cloudOut->reserve( indexPointInHull.size() );
+
+        for ( uint64_t count = 0; count < indexPointInHull.size(); count++ )
+            cloudOut->push_back( lineOriginal->points[ indexPointInHull[ count ] ] );
 
     }
 
@@ -968,11 +889,7 @@ private:
             return;
 
         
-        for ( uint64_t count = 0; count < cloudIn->points.size(); count++ )
-        {
-            if ( pcl::isXYPointIn2DXYPolygon( cloudIn->points[ count ], *hullVertices ) )
-                indexPointInHull.push_back( count );
-        }
+        findIndicesInHull( cloudIn, indexPointInHull, hullVertices );
 
     }
 
@@ -1025,16 +942,53 @@ private:
             return;
 
 
-        for ( uint64_t count = 0; count < cloudIn->points.size(); count++ )
-        {
-            if ( pcl::isXYPointIn2DXYPolygon( cloudIn->points[ count ], *hullVertices ) )
-                cloudOut->push_back( lineOriginal->points[ count ] );
-        }
+        std::vector< uint64_t > indexPointInHull;
+        findIndicesInHull( cloudIn, indexPointInHull, hullVertices );
+
+        cloudOut->reserve( indexPointInHull.size() );
+
+        for ( uint64_t count = 0; count < indexPointInHull.size(); count++ )
+            cloudOut->push_back( lineOriginal->points[ indexPointInHull[ count ] ] );
 
     }
 
 
 
+	/**
+	* Find indices of points that are within a hull, like pcl::isXYPointIn2DXYPolygon would, but
+    * testing only the points near the edges of the hull, and using every core
+    *
+    * @param[in] cloudIn Point cloud on the projection plane expressed in 2D
+    * @param[out] indexPointInHull Indices of the points that are within the hull, in increasing order
+    * @param[in] hullVertices Vertices of the hull
+	*/
+    void findIndicesInHull( pcl::PointCloud<pcl::PointXYZ>::ConstPtr cloudIn,
+                                std::vector< uint64_t > & indexPointInHull,
+                                pcl::PointCloud<pcl::PointXYZ>::ConstPtr hullVertices )
+    {
+        indexPointInHull.clear();
+
+        if ( cloudIn->points.empty() )
+            return;
+
+        std::vector< float > hullX;
+        std::vector< float > hullY;
+
+        hullX.reserve( hullVertices->size() );
+        hullY.reserve( hullVertices->size() );
+
+        for ( uint64_t count = 0; count < hullVertices->size(); count++ )
+        {
+            hullX.push_back( hullVertices->points[ count ].x );
+            hullY.push_back( hullVertices->points[ count ].y );
+        }
+
+        HullGrid grid( hullX, hullY );
+
+        grid.findPointsInside( &cloudIn->points[ 0 ].x, &cloudIn->points[ 0 ].y, cloudIn->points.size(),
+                                sizeof( pcl::PointXYZ ), indexPointInHull );
+    }
+
 
 // ----------------------------- Variables ------------------------------------------------
 
@@ -0,0 +1,498 @@
+/*
+* Copyright 2020 © Centre Interdisciplinaire de développement en Cartographie des Océans (CIDCO), Tous droits réservés
+*/
+
+#ifndef SURVEYOVERLAP_HPP
+#define SURVEYOVERLAP_HPP
+
+#include <cstdint>
+#include <cmath>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <ostream>
+#include "ConvexHull.hpp"
+#include "HullGrid.hpp"
+
+/*!
+* \brief Overlap of two survey lines
+*/
+class LineOverlap {
+public:
+
+    /**Creates the overlap of two lines*/
+    LineOverlap(unsigned int line1, unsigned int line2) : line1(line1), line2(line2), area(0), nbPoints1(0), nbPoints2(0) {
+    }
+
+    /**First line, the lowest index*/
+    unsigned int line1;
+
+    /**Second line*/
+    unsigned int line2;
+
+    /**Area shared by the hulls of the lines*/
+    double area;
+
+    /**Number of points of the first line inside the hull of the second*/
+    uint64_t nbPoints1;
+
+    /**Number of points of the second line inside the hull of the first*/
+    uint64_t nbPoints2;
+};
+
+/*!
+* \brief Finds every overlapping pair among many survey lines
+*
+* The lines are read twice, a batch of points at a time, so they never need to fit in memory together.
+* The first pass builds the convex hull of each line with addPoints and closeLine. findOverlaps then prunes the pairs with a
+* sweep over the bounding boxes of the hulls and intersects the hulls of the remaining pairs. The second pass counts,
+* with countPoints, the points of each line inside the hulls overlapping it, using a HullGrid per hull.
+*
+* Different lines can be read concurrently in both passes. Points are kept relative to an origin, so single
+* precision hulls stay accurate in projected coordinates.
+*/
+class SurveyOverlap {
+public:
+
+    /**
+    * Creates an empty survey
+    *
+    * @param nbThreads number of threads used by findOverlaps, 0 to use every core
+    */
+    SurveyOverlap(unsigned int nbThreads = 0) : nbThreads(nbThreads), hasOrigin(false), originX(0), originY(0) {
+        if (this->nbThreads == 0) {
+            this->nbThreads = std::max(1u, std::thread::hardware_concurrency());
+        }
+    }
+
+    /**Destroys the survey*/
+    ~SurveyOverlap() {
+        for (auto i = lines.begin(); i != lines.end(); i++) {
+            delete i->grid;
+        }
+    }
+
+    /**
+    * Adds a line and returns its index
+    *
+    * @param name name of the line, used in the report
+    */
+    unsigned int addLine(const std::string & name) {
+        lines.push_back(SurveyLine(name));
+        return lines.size() - 1;
+    }
+
+    /**
+    * Sets the position subtracted from every point, the first point added otherwise
+    *
+    * @param x x of the origin
+    * @param y y of the origin
+    */
+    void setOrigin(double x, double y) {
+        originX = x;
+        originY = y;
+        hasOrigin = true;
+    }
+
+    /**
+    * Adds points to the hull of a line. Once the origin is set, points can be added to different lines at the same time
+    *
+    * @param line index of the line
+    * @param x x of the points
+    * @param y y of the points
+    * @param nbPoints number of points
+    */
+    void addPoints(unsigned int line, const double * x, const double * y, unsigned int nbPoints) {
+        if (nbPoints == 0) {
+            return;
+        }
+
+        if (!hasOrigin) {
+            originX = x[0];
+            originY = y[0];
+            hasOrigin = true;
+        }
+
+        SurveyLine & surveyLine = lines.at(line);
+
+        for (unsigned int i = 0; i < nbPoints; i++) {
+            PointAndrews point;
+            point.x = x[i] - originX;
+            point.y = y[i] - originY;
+            point.index = 0;
+            surveyLine.pending.push_back(point);
+        }
+
+        surveyLine.nbPoints += nbPoints;
+
+        //the hull of the hull and the new points is the hull of all the points
+        if (surveyLine.pending.size() > PENDING_SIZE) {
+            mergePending(surveyLine);
+        }
+    }
+
+    /**
+    * Completes the hull of a line, once all its points are added
+    *
+    * @param line index of the line
+    */
+    void closeLine(unsigned int line) {
+        mergePending(lines.at(line));
+    }
+
+    /**
+    * Completes the hulls and finds the pairs of lines whose hulls overlap
+    */
+    void findOverlaps() {
+        overlaps.clear();
+
+        for (auto i = lines.begin(); i != lines.end(); i++) {
+            mergePending(*i);
+            i->computeBoundingBox();
+            i->partners.clear();
+        }
+
+        findCandidatePairs();
+
+        std::vector<LineOverlap> candidates;
+
+        for (auto i = candidatePairs.begin(); i != candidatePairs.end(); i++) {
+            candidates.push_back(LineOverlap(i->first, i->second));
+        }
+
+        //hull intersections, then grids of the lines that overlap another, in parallel
+        runInParallel(candidates.size(), [this, &candidates](unsigned int c) {
+            candidates[c].area = getIntersectionArea(lines[candidates[c].line1], lines[candidates[c].line2]);
+        });
+
+        for (auto i = candidates.begin(); i != candidates.end(); i++) {
+            if (i->area > 0) {
+                lines[i->line1].partners.push_back(std::make_pair(i->line2, (unsigned int) overlaps.size()));
+                lines[i->line2].partners.push_back(std::make_pair(i->line1, (unsigned int) overlaps.size()));
+                overlaps.push_back(*i);
+            }
+        }
+
+        runInParallel(lines.size(), [this](unsigned int l) {
+            delete lines[l].grid;
+            lines[l].grid = NULL;
+
+            if (lines[l].partners.size() > 0) {
+                lines[l].grid = new HullGrid(lines[l].hullX, lines[l].hullY);
+            }
+        });
+    }
+
+    /**
+    * Counts the points of a line inside the hulls of the lines overlapping it.
+    * Can be called for different lines at the same time, but not for the same line
+    *
+    * @param line index of the line
+    * @param x x of the points
+    * @param y y of the points
+    * @param nbPoints number of points
+    */
+    void countPoints(unsigned int line, const double * x, const double * y, unsigned int nbPoints) {
+        SurveyLine & surveyLine = lines.at(line);
+
+        for (auto p = surveyLine.partners.begin(); p != surveyLine.partners.end(); p++) {
+            HullGrid * grid = lines[p->first].grid;
+            uint64_t inside = 0;
+
+            for (unsigned int i = 0; i < nbPoints; i++) {
+                if (grid->isInside((float) (x[i] - originX), (float) (y[i] - originY))) {
+                    inside++;
+                }
+            }
+
+            LineOverlap & overlap = overlaps[p->second];
+
+            if (overlap.line1 == line) {
+                overlap.nbPoints1 += inside;
+            }
+            else {
+                overlap.nbPoints2 += inside;
+            }
+        }
+    }
+
+    /**Returns true if a line overlaps another, so its points need counting*/
+    bool hasOverlap(unsigned int line) {
+        return lines.at(line).partners.size() > 0;
+    }
+
+    /**Returns the overlaps found, by first line then second line*/
+    const std::vector<LineOverlap> & getOverlaps() {
+        return overlaps;
+    }
+
+    /**Returns the number of pairs whose bounding boxes overlap*/
+    unsigned int getNumberOfCandidatePairs() {
+        return candidatePairs.size();
+    }
+
+    /**Returns the number of lines*/
+    unsigned int getNumberOfLines() {
+        return lines.size();
+    }
+
+    /**Returns the name of a line*/
+    const std::string & getLineName(unsigned int line) {
+        return lines.at(line).name;
+    }
+
+    /**Returns the number of points added to a line*/
+    uint64_t getNumberOfPoints(unsigned int line) {
+        return lines.at(line).nbPoints;
+    }
+
+    /**Returns the area of the hull of a line*/
+    double getHullArea(unsigned int line) {
+        return getArea(lines.at(line).hullX, lines.at(line).hullY);
+    }
+
+    /**
+    * Writes "line1 line2 area nbPoints1 nbPoints2" for each overlap
+    *
+    * @param out the output stream
+    */
+    void writeReport(std::ostream & out) {
+        for (auto i = overlaps.begin(); i != overlaps.end(); i++) {
+            out << lines[i->line1].name << " " << lines[i->line2].name << " " << i->area << " " << i->nbPoints1 << " " << i->nbPoints2 << std::endl;
+        }
+    }
+
+    /**
+    * Returns the area of a polygon
+    *
+    * @param x x of the vertices
+    * @param y y of the vertices
+    */
+    static double getArea(const std::vector<float> & x, const std::vector<float> & y) {
+        double area = 0;
+        unsigned int nbVertices = x.size();
+
+        for (unsigned int i = 0; i < nbVertices; i++) {
+            unsigned int next = (i + 1) % nbVertices;
+            area += (double) x[i] * y[next] - (double) x[next] * y[i];
+        }
+
+        return std::fabs(area) / 2;
+    }
+
+private:
+
+    /**Number of points added before they are merged into the hull*/
+    static const unsigned int PENDING_SIZE = 1 << 20;
+
+    /*!
+    * \brief A line: its hull and the lines overlapping it
+    */
+    class SurveyLine {
+    public:
+
+        SurveyLine(const std::string & name) : name(name), nbPoints(0), grid(NULL), minX(0), maxX(0), minY(0), maxY(0) {
+        }
+
+        /**Computes the bounding box of the hull*/
+        void computeBoundingBox() {
+            if (hullX.empty()) {
+                return;
+            }
+
+            minX = *std::min_element(hullX.begin(), hullX.end());
+            maxX = *std::max_element(hullX.begin(), hullX.end());
+            minY = *std::min_element(hullY.begin(), hullY.end());
+            maxY = *std::max_element(hullY.begin(), hullY.end());
+        }
+
+        /**Name of the line*/
+        std::string name;
+
+        /**Number of points*/
+        uint64_t nbPoints;
+
+        /**Points not merged into the hull yet*/
+        std::vector<PointAndrews> pending;
+
+        /**x of the hull vertices, counter-clockwise*/
+        std::vector<float> hullX;
+
+        /**y of the hull vertices, counter-clockwise*/
+        std::vector<float> hullY;
+
+        /**Grid over the hull, for the lines overlapping this one*/
+        HullGrid * grid;
+
+        /**Lines overlapping this one, with the index of the overlap*/
+        std::vector< std::pair<unsigned int, unsigned int> > partners;
+
+        /**Bounding box of the hull*/
+        float minX, maxX, minY, maxY;
+    };
+
+    /**Replaces the hull of a line by the hull of its vertices and pending points*/
+    void mergePending(SurveyLine & line) {
+        if (line.pending.empty()) {
+            return;
+        }
+
+        for (unsigned int i = 0; i < line.hullX.size(); i++) {
+            PointAndrews vertex;
+            vertex.x = line.hullX[i];
+            vertex.y = line.hullY[i];
+            vertex.index = 0;
+            line.pending.push_back(vertex);
+        }
+
+        std::vector<PointAndrews> hull;
+        AndrewsConvex_hull(hull, line.pending);
+
+        line.hullX.clear();
+        line.hullY.clear();
+
+        for (auto i = hull.begin(); i != hull.end(); i++) {
+            line.hullX.push_back(i->x);
+            line.hullY.push_back(i->y);
+        }
+
+        std::vector<PointAndrews>().swap(line.pending);
+    }
+
+    /**Finds the pairs of lines whose bounding boxes overlap, sweeping the boxes along x*/
+    void findCandidatePairs() {
+        candidatePairs.clear();
+
+        std::vector<unsigned int> order;
+
+        for (unsigned int l = 0; l < lines.size(); l++) {
+            //a hull needs an area
+            if (lines[l].hullX.size() >= 3) {
+                order.push_back(l);
+            }
+        }
+
+        std::sort(order.begin(), order.end(), [this](unsigned int a, unsigned int b) {
+            return lines[a].minX < lines[b].minX;
+        });
+
+        std::vector<unsigned int> active;
+
+        for (auto i = order.begin(); i != order.end(); i++) {
+            SurveyLine & line = lines[*i];
+            unsigned int kept = 0;
+
+            for (unsigned int a = 0; a < active.size(); a++) {
+                SurveyLine & other = lines[active[a]];
+
+                //boxes ending before this one starts cannot overlap the next ones either
+                if (other.maxX < line.minX) {
+                    continue;
+                }
+
+                active[kept++] = active[a];
+
+                if (other.minY <= line.maxY && line.minY <= other.maxY) {
+                    candidatePairs.push_back(std::make_pair(std::min(*i, active[a]), std::max(*i, active[a])));
+                }
+            }
+
+            active.resize(kept);
+            active.push_back(*i);
+        }
+
+        std::sort(candidatePairs.begin(), candidatePairs.end());
+    }
+
+    /**Returns the area shared by the convex hulls of two lines, clipping one by each edge of the other*/
+    static double getIntersectionArea(const SurveyLine & line1, const SurveyLine & line2) {
+        std::vector<double> x(line1.hullX.begin(), line1.hullX.end());
+        std::vector<double> y(line1.hullY.begin(), line1.hullY.end());
+        std::vector<double> clippedX, clippedY;
+        unsigned int nbEdges = line2.hullX.size();
+
+        for (unsigned int e = 0; e < nbEdges && x.size() > 0; e++) {
+            double ax = line2.hullX[e], ay = line2.hullY[e];
+            double bx = line2.hullX[(e + 1) % nbEdges], by = line2.hullY[(e + 1) % nbEdges];
+
+            clippedX.clear();
+            clippedY.clear();
+
+            for (unsigned int i = 0; i < x.size(); i++) {
+                unsigned int j = (i + 1) % x.size();
+
+                //counter-clockwise hull: inside is on the left of each edge
+                double sideI = (bx - ax) * (y[i] - ay) - (by - ay) * (x[i] - ax);
+                double sideJ = (bx - ax) * (y[j] - ay) - (by - ay) * (x[j] - ax);
+
+                if (sideI >= 0) {
+                    clippedX.push_back(x[i]);
+                    clippedY.push_back(y[i]);
+                }
+
+                if ((sideI >= 0) != (sideJ >= 0)) {
+                    double t = sideI / (sideI - sideJ);
+                    clippedX.push_back(x[i] + (x[j] - x[i]) * t);
+                    clippedY.push_back(y[i] + (y[j] - y[i]) * t);
+                }
+            }
+
+            x.swap(clippedX);
+            y.swap(clippedY);
+        }
+
+        double area = 0;
+
+        for (unsigned int i = 0; i < x.size(); i++) {
+            unsigned int next = (i + 1) % x.size();
+            area += x[i] * y[next] - x[next] * y[i];
+        }
+
+        return std::fabs(area) / 2;
+    }
+
+    /**Runs a task for each index in [0, nbTasks), the threads taking the next index as they finish*/
+    template<typename Task>
+    void runInParallel(unsigned int nbTasks, Task task) {
+        std::atomic<unsigned int> next(0);
+        std::vector<std::thread> workers;
+        unsigned int threads = std::max(1u, std::min(nbThreads, nbTasks));
+
+        for (unsigned int t = 0; t < threads; t++) {
+            workers.push_back(std::thread([&next, &task, nbTasks]() {
+                for (unsigned int i = next++; i < nbTasks; i = next++) {
+                    task(i);
+                }
+            }));
+        }
+
+        for (auto i = workers.begin(); i != workers.end(); i++) {
+            i->join();
+        }
+    }
+
+    /**Number of threads*/
+    unsigned int nbThreads;
+
+    /**The lines*/
+    std::vector<SurveyLine> lines;
+
+    /**Pairs of lines whose bounding boxes overlap*/
+    std::vector< std::pair<unsigned int, unsigned int> > candidatePairs;
+
+    /**Pairs of lines whose hulls overlap*/
+    std::vector<LineOverlap> overlaps;
+
+    /**True once the origin is set*/
+    bool hasOrigin;
+
+    /**x subtracted from the points*/
+    double originX;
+
+    /**y subtracted from the points*/
+    double originY;
+};
+
+#endif /* SURVEYOVERLAP_HPP */
@@ -6,6 +6,7 @@
 #define DATAGRAMGEOREFERENCER_HPP
 
 #include "../Ping.hpp"
+#include "../Sounding.hpp"
 #include "../Position.hpp"
 #include "../Attitude.hpp"
 #include "Georeferencing.hpp"
@@ -14,7 +15,18 @@
 #include "../svp/SvpSelectionStrategy.hpp"
 #include "../datagrams/DatagramEventHandler.hpp"
 #include "../math/Interpolation.hpp"
+#include "../math/AttitudeSeries.hpp"
+#include "../utils/TimeSeries.hpp"
+#include "../utils/TimestampSort.hpp"
 #include "../math/CartesianToGeodeticFukushima.hpp"
+#include "../utils/Stats.hpp"
+
+/**Where the georeferenced soundings come from*/
+enum GeoreferencingMode {
+    GEOREFERENCE_RAYTRACE,  //raytrace the pings
+    GEOREFERENCE_SONAR,     //use the soundings the sonar raytraced in real time, without raytracing
+    GEOREFERENCE_COMPARE    //raytrace the pings and compare them with the soundings of the sonar
+};
 
 /*!
  * \brief Datagram Georeferencer class.
@@ -74,6 +86,25 @@ public:
         pings.push_back(Ping(microEpoch, id, quality, intensity, currentSurfaceSoundSpeed, twoWayTravelTime, tiltAngle, beamAngle));
     };
 
+    /**
+     * Add a sounding raytraced by the sonar in the vector soundings, unless the pings are only raytraced
+     *
+     * @param microEpoch the ping timestamp
+     * @param id the beam id
+     * @param heading the heading at transmit time
+     * @param transducerDepth the depth of the transmit transducer below the water line
+     * @param alongTrack the along track distance
+     * @param acrossTrack the across track distance
+     * @param depth the depth below the transmit transducer
+     * @param quality the sounding quality
+     * @param intensity the sounding intensity
+     */
+    void processSounding(uint64_t microEpoch, long id, double heading, double transducerDepth, double alongTrack, double acrossTrack, double depth, uint32_t quality, int32_t intensity) {
+        if (mode != GEOREFERENCE_RAYTRACE) {
+            soundings.push_back(Sounding(microEpoch, id, heading, transducerDepth, alongTrack, acrossTrack, depth, quality, intensity));
+        }
+    };
+
     /**
      * Change the current surface sound speed
      * 
@@ -107,14 +138,19 @@ public:
                 return;
         }
 
-        if(pings.size()==0){
+        if(mode != GEOREFERENCE_SONAR && pings.size()==0){
                 std::cerr << "[-] No ping data found in file" << std::endl;
                 return;
         }
 
+        if(mode != GEOREFERENCE_RAYTRACE && soundings.size()==0){
+                std::cerr << "[-] No sonar soundings found in file" << std::endl;
+                return;
+        }
 
-
-        if (externalSvps.size() > 0) {
+        if (mode == GEOREFERENCE_SONAR) {
+            //the sonar already raytraced the soundings
+        } else if (externalSvps.size() > 0) {
             //Use svps specified by user
             for (unsigned int i = 0; i < externalSvps.size(); ++i) {
                 svpStrategy.addSvp(externalSvps[i]);
@@ -152,9 +188,10 @@ public:
         }
 
         //Sort everything
-        std::sort(positions.begin(), positions.end(), &Position::sortByTimestamp);
-        std::sort(attitudes.begin(), attitudes.end(), &Attitude::sortByTimestamp);
-        std::sort(pings.begin(), pings.end(), &Ping::sortByTimestamp);
+        positions.sort();
+        attitudes.sort();
+        TimestampSort::sort(pings, &Ping::sortByTimestamp);
+        TimestampSort::sort(soundings, &Sounding::sortByTimestamp);
 
         // fprintf(stderr, "[+] Position data points: %ld [%lu to %lu]\n", positions.size(), positions[0].getTimestamp(), positions[positions.size() - 1].getTimestamp());
         // fprintf(stderr, "[+] Attitude data points: %ld [%lu to %lu]\n", attitudes.size(), attitudes[0].getTimestamp(), attitudes[attitudes.size() - 1].getTimestamp());
@@ -168,6 +205,27 @@ public:
         std::cerr <<  "[+] Ping data points: " << pings.size() << " [" << ( (pings.size() > 0) ? pings[0].getTimestamp() : 0 ) << " to " 
                 << ( (pings.size() > 0) ? pings[pings.size() - 1].getTimestamp() : 0 ) << "]\n";                            
 
+        if (mode != GEOREFERENCE_RAYTRACE) {
+            std::cerr << "[+] Sonar soundings: " << soundings.size() << " [" << soundings[0].getTimestamp() << " to "
+                    << soundings[soundings.size() - 1].getTimestamp() << "]\n";
+
+            checkTransducerDraft();
+        }
+
+        //attitudes are interpolated as quaternions
+        AttitudeSeries attitudeSeries;
+        attitudeSeries.add(attitudes.getSamples());
+
+        if (mode == GEOREFERENCE_SONAR) {
+            georeferenceSoundings(leverArm, attitudeSeries);
+            writeGeographicPoints();
+            return;
+        }
+
+        if (mode == GEOREFERENCE_COMPARE) {
+            resetComparison();
+        }
+
         //interpolate attitudes and positions around pings
         unsigned int attitudeIndex = 0;
         unsigned int positionIndex = 0;
@@ -176,65 +234,278 @@ public:
         for (auto i = pings.begin(); i != pings.end(); i++) {
 
 
-            while (attitudeIndex + 1 < attitudes.size() && attitudes[attitudeIndex + 1].getTimestamp() < (*i).getTimestamp()) {
-                attitudeIndex++;
-            }
+            attitudeIndex = attitudes.seek((*i).getTimestamp());
 
             //No more attitudes available
             if (attitudeIndex >= attitudes.size() - 1) {
                 //std::cerr << "No more attitudes" << std::endl;
+                STATS_COUNT(STATS_REJECTED_PINGS, pings.end() - i);
                 break;
             }
 
-            while (positionIndex + 1 < positions.size() && positions[positionIndex + 1].getTimestamp() < (*i).getTimestamp()) {
-                positionIndex++;
-            }
+            positionIndex = positions.seek((*i).getTimestamp());
 
             //No more positions available
             if (positionIndex >= positions.size() - 1) {
                 //std::cerr << "No more positions" << std::endl;
+                STATS_COUNT(STATS_REJECTED_PINGS, pings.end() - i);
                 break;
             }
 
             //No position or attitude smaller than ping, so discard this ping
             if (positions[positionIndex].getTimestamp() > (*i).getTimestamp() || attitudes[attitudeIndex].getTimestamp() > (*i).getTimestamp()) {
                 std::cerr << "rejecting ping " << (*i).getId() << " " << (*i).getTimestamp() << " " << positions[positionIndex].getTimestamp() << " " << attitudes[attitudeIndex].getTimestamp() << std::endl;
+                STATS_COUNT(STATS_REJECTED_PINGS, 1);
                 continue;
             }
 
-            Attitude & beforeAttitude = attitudes[attitudeIndex];
-            Attitude & afterAttitude = attitudes[attitudeIndex + 1];
-
             Position & beforePosition = positions[positionIndex];
             Position & afterPosition = positions[positionIndex + 1];
 
-            Attitude * interpolatedAttitude = Interpolator::interpolateAttitude(beforeAttitude, afterAttitude, (*i).getTimestamp());
-            Position * interpolatedPosition = Interpolator::interpolatePosition(beforePosition, afterPosition, (*i).getTimestamp());
+            Position * interpolatedPosition;
+            Eigen::Matrix3d imu2ned;
+
+            {
+                STATS_STAGE(STATS_INTERPOLATION);
+                interpolatedPosition = Interpolator::interpolatePosition(beforePosition, afterPosition, (*i).getTimestamp());
+                attitudeSeries.getImu2Ned(imu2ned, attitudeIndex, (*i).getTimestamp());
+            }
             
             // Set the transducer depth to draft
             // If we have timestamped vertical motion, then this would need to
             // be processed and interpolated in the same way as Position and Attitude
             i->setTransducerDepth(transducerDraft); // i is the i-th ping
 
+            SoundVelocityProfile * svp;
+
+            {
+                STATS_STAGE(STATS_SVP_SELECTION);
+                svp = svpStrategy.chooseSvp(*interpolatedPosition, *i);
+            }
+
             //georeference
             Eigen::Vector3d georeferencedPing;
-            georef.georeference(georeferencedPing, *interpolatedAttitude, *interpolatedPosition, (*i), *(svpStrategy.chooseSvp(*interpolatedPosition, *i)), leverArm, boresight);
+
+            {
+                STATS_STAGE(STATS_GEOREFERENCING);
+                georef.georeference(georeferencedPing, imu2ned, *interpolatedPosition, (*i), *svp, leverArm, boresight);
+            }
+
+            STATS_COUNT(STATS_PINGS, 1);
 
             processGeoreferencedPing(georeferencedPing, (*i).getQuality(), (*i).getIntensity(), positionIndex, attitudeIndex);
 
-            delete interpolatedAttitude;
+            if (mode == GEOREFERENCE_COMPARE) {
+                compareWithSounding(i, georeferencedPing, imu2ned, *interpolatedPosition, leverArm);
+            }
+
+            delete interpolatedPosition;
+        }
+
+        writeGeographicPoints();
+
+        if (mode == GEOREFERENCE_COMPARE) {
+            printComparison();
+        }
+    }
+
+    /**
+     * Georeferences the soundings the sonar raytraced, without raytracing them again
+     *
+     * @param leverArm vector from the position reference point (PRP) to the acoustic center
+     * @param attitudeSeries the attitudes, which rotate the lever arm
+     */
+    void georeferenceSoundings(Eigen::Vector3d & leverArm, AttitudeSeries & attitudeSeries) {
+        unsigned int attitudeIndex = 0;
+        unsigned int positionIndex = 0;
+
+        for (auto i = soundings.begin(); i != soundings.end(); i++) {
+            attitudeIndex = attitudes.seek((*i).getTimestamp());
+
+            //No more attitudes available
+            if (attitudeIndex >= attitudes.size() - 1) {
+                STATS_COUNT(STATS_REJECTED_PINGS, soundings.end() - i);
+                break;
+            }
+
+            positionIndex = positions.seek((*i).getTimestamp());
+
+            //No more positions available
+            if (positionIndex >= positions.size() - 1) {
+                STATS_COUNT(STATS_REJECTED_PINGS, soundings.end() - i);
+                break;
+            }
+
+            //No position or attitude smaller than sounding, so discard this sounding
+            if (positions[positionIndex].getTimestamp() > (*i).getTimestamp() || attitudes[attitudeIndex].getTimestamp() > (*i).getTimestamp()) {
+                std::cerr << "rejecting sounding " << (*i).getId() << " " << (*i).getTimestamp() << " " << positions[positionIndex].getTimestamp() << " " << attitudes[attitudeIndex].getTimestamp() << std::endl;
+                STATS_COUNT(STATS_REJECTED_PINGS, 1);
+                continue;
+            }
+
+            Position * interpolatedPosition;
+            Eigen::Matrix3d imu2ned;
+
+            {
+                STATS_STAGE(STATS_INTERPOLATION);
+                interpolatedPosition = Interpolator::interpolatePosition(positions[positionIndex], positions[positionIndex + 1], (*i).getTimestamp());
+                attitudeSeries.getImu2Ned(imu2ned, attitudeIndex, (*i).getTimestamp());
+            }
+
+            Eigen::Vector3d georeferencedSounding;
+
+            {
+                STATS_STAGE(STATS_GEOREFERENCING);
+                georef.georeferenceSounding(georeferencedSounding, imu2ned, *interpolatedPosition, (*i), leverArm);
+            }
+
+            STATS_COUNT(STATS_PINGS, 1);
+
+            processGeoreferencedPing(georeferencedSounding, (*i).getQuality(), (*i).getIntensity(), positionIndex, attitudeIndex);
+
             delete interpolatedPosition;
         }
     }
 
+    /**
+     * Checks the draft against the transducer depth the sonar raytraced its soundings from.
+     * The soundings cannot be raytraced again from the draft, so a mismatch is only reported
+     */
+    void checkTransducerDraft() {
+        double transducerDepthSum = 0;
+
+        for (auto i = soundings.begin(); i != soundings.end(); i++) {
+            transducerDepthSum += i->getTransducerDepth();
+        }
+
+        double transducerDepth = transducerDepthSum / soundings.size();
+
+        std::cerr << "[+] Sonar transducer depth: mean " << transducerDepth << " m, transducer draft: " << transducerDraft << " m" << std::endl;
+
+        if (std::abs(transducerDepth - transducerDraft) > maxTransducerDraftDifference) {
+            std::cerr << "[-] The sonar raytraced its soundings from a transducer depth that differs from the transducer draft" << std::endl;
+        }
+    }
+
+    /**
+     * Compares a raytraced beam with the sonar sounding of the same ping and the same rank from port to starboard.
+     * Pings whose number of beams and of soundings differ are not compared
+     *
+     * @param ping the raytraced beam, in the sorted pings
+     * @param georeferencedPing the georeferenced beam
+     * @param imu2ned the rotation from the IMU frame to the navigation frame
+     * @param position the position at the ping
+     * @param leverArm vector from the position reference point (PRP) to the acoustic center
+     */
+    void compareWithSounding(std::vector<Ping>::iterator ping, Eigen::Vector3d & georeferencedPing, Eigen::Matrix3d & imu2ned, Position & position, Eigen::Vector3d & leverArm) {
+        uint64_t timestamp = ping->getTimestamp();
+
+        if (ping == pings.begin() || (ping - 1)->getTimestamp() != timestamp) {
+            //first beam of a ping, find its soundings
+            unsigned int nbBeams = 0;
+
+            for (auto i = ping; i != pings.end() && i->getTimestamp() == timestamp; i++) {
+                nbBeams++;
+            }
+
+            auto first = std::lower_bound(soundings.begin(), soundings.end(), timestamp, [](Sounding & sounding, uint64_t t) {
+                return sounding.getTimestamp() < t;
+            });
+
+            auto last = std::upper_bound(first, soundings.end(), timestamp, [](uint64_t t, Sounding & sounding) {
+                return t < sounding.getTimestamp();
+            });
+
+            swathSounding = first - soundings.begin();
+            swathSize = ((unsigned int) (last - first) == nbBeams) ? nbBeams : 0;
+            swathRank = 0;
+        }
+
+        unsigned int rank = swathRank++;
+
+        if (rank >= swathSize) {
+            uncomparedBeams++;
+            return;
+        }
+
+        Eigen::Vector3d georeferencedSounding;
+        georef.georeferenceSounding(georeferencedSounding, imu2ned, position, soundings[swathSounding + rank], leverArm);
+
+        Eigen::Vector3d difference = georeferencedPing - georeferencedSounding;
+
+        if (dynamic_cast<GeoreferencingLGF*> (&georef) == NULL) {
+            //ECEF to NED
+            Eigen::Matrix3d ned2ecef;
+            CoordinateTransform::ned2ecef(ned2ecef, position);
+            difference = ned2ecef.transpose() * difference;
+        }
+
+        double horizontal = sqrt(difference(0) * difference(0) + difference(1) * difference(1));
+
+        comparedBeams++;
+        horizontalDifferenceSum += horizontal;
+        verticalDifferenceSum += difference(2);
+        verticalDifferenceSquareSum += difference(2) * difference(2);
+        maxHorizontalDifference = std::max(maxHorizontalDifference, horizontal);
+        maxVerticalDifference = std::max(maxVerticalDifference, std::abs(difference(2)));
+    }
+
+    /**Writes the statistics of the comparison between the raytraced beams and the sonar soundings*/
+    void printComparison() {
+        std::cerr << "[+] Raytraced beams compared with sonar soundings: " << comparedBeams << " (" << uncomparedBeams << " beams without a matching sounding)" << std::endl;
+
+        if (comparedBeams > 0) {
+            std::cerr << "[+] Horizontal difference: mean " << horizontalDifferenceSum / comparedBeams << " m, max " << maxHorizontalDifference << " m" << std::endl;
+            std::cerr << "[+] Vertical difference (raytraced - sonar, positive down): mean " << verticalDifferenceSum / comparedBeams
+                    << " m, RMS " << sqrt(verticalDifferenceSquareSum / comparedBeams) << " m, max " << maxVerticalDifference << " m" << std::endl;
+        }
+    }
+
     virtual void processGeoreferencedPing(Eigen::Vector3d & georeferencedPing, uint32_t quality, int32_t intensity, int positionIndex, int attitudeIndex) {
         if(cart2geo) {
-            Position p(0,0,0,0);
-            cart2geo->ecefToLongitudeLatitudeElevation(georeferencedPing, p);
-            std::cout << p.getLongitude() << " " << p.getLatitude() << " " << p.getEllipsoidalHeight() << " " << quality << " " << intensity << std::endl;
+            //converted in batches, written in order
+            ecefX.push_back(georeferencedPing(0));
+            ecefY.push_back(georeferencedPing(1));
+            ecefZ.push_back(georeferencedPing(2));
+            qualities.push_back(quality);
+            intensities.push_back(intensity);
+
+            if(ecefX.size() >= geographicBatchSize) {
+                writeGeographicPoints();
+            }
         } else {
+            STATS_STAGE(STATS_OUTPUT);
             std::cout << georeferencedPing(0) << " " << georeferencedPing(1) << " " << georeferencedPing(2) << " " << quality << " " << intensity << std::endl;
+            STATS_COUNT(STATS_POINTS_WRITTEN, 1);
+        }
+    }
+
+    /**Converts the pending ECEF points to longitude, latitude and height and writes them*/
+    void writeGeographicPoints() {
+        unsigned int nbPoints = ecefX.size();
+
+        if(nbPoints == 0) {
+            return;
+        }
+
+        STATS_STAGE(STATS_OUTPUT);
+        STATS_COUNT(STATS_POINTS_WRITTEN, nbPoints);
+
+        longitudes.resize(nbPoints);
+        latitudes.resize(nbPoints);
+        heights.resize(nbPoints);
+
+        cart2geo->ecefToLongitudeLatitudeElevation(&ecefX[0], &ecefY[0], &ecefZ[0], nbPoints, &longitudes[0], &latitudes[0], &heights[0]);
+
+        for(unsigned int i = 0; i < nbPoints; i++) {
+            std::cout << longitudes[i] << " " << latitudes[i] << " " << heights[i] << " " << qualities[i] << " " << intensities[i] << '\n';
         }
+
+        ecefX.clear();
+        ecefY.clear();
+        ecefZ.clear();
+        qualities.clear();
+        intensities.clear();
     }
 
     void setSvpStrategy(SvpSelectionStrategy& svpStrategy) {
@@ -245,10 +516,25 @@ public:
         cart2geo = c2g;
     }
     
+    /**
+     * Sets the transducer draft. Pings are raytraced from it. The sonar raytraced its soundings from the transducer depth it measured,
+     * which the draft is checked against
+     *
+     * @param d the distance between the transducer and the water line
+     */
     void setTransducerDraft(double d) {
         transducerDraft = d;
     }
 
+    /**
+     * Sets where the georeferenced soundings come from. Must be set before parsing, since sonar soundings are only kept when needed
+     *
+     * @param m the georeferencing mode
+     */
+    void setMode(GeoreferencingMode m) {
+        mode = m;
+    }
+
 
 protected:
 
@@ -264,19 +550,57 @@ protected:
     /**Vector of pings*/
     std::vector<Ping> pings;
 
-    /**Vector of positions*/
-    std::vector<Position> positions;
+    /**Vector of soundings raytraced by the sonar*/
+    std::vector<Sounding> soundings;
+
+    /**where the georeferenced soundings come from*/
+    GeoreferencingMode mode = GEOREFERENCE_RAYTRACE;
 
-    /**vector of attitudes*/
-    std::vector<Attitude> attitudes;
+    /**Time series of positions*/
+    TimeSeries<Position> positions;
+
+    /**Time series of attitudes*/
+    TimeSeries<Attitude> attitudes;
 
     /**Vector of SoundVelocityProfile*/
     std::vector<SoundVelocityProfile*> svps;
     
     /**the distance between transducer and water line*/
     double transducerDraft = 0.0;
+
+    /**largest difference between the draft and the transducer depth of the sonar that is not reported (meters)*/
+    static constexpr double maxTransducerDraftDifference = 0.1;
     
     CartesianToGeodeticFukushima* cart2geo = NULL;
+
+    /**number of points converted to geographic coordinates at once*/
+    static const unsigned int geographicBatchSize = 4096;
+
+    /**georeferenced points waiting for their conversion to geographic coordinates*/
+    std::vector<double> ecefX, ecefY, ecefZ;
+    std::vector<uint32_t> qualities;
+    std::vector<int32_t> intensities;
+
+    /**geographic coordinates of the points being written*/
+    std::vector<double> longitudes, latitudes, heights;
+
+    /**Clears the statistics of the comparison*/
+    void resetComparison() {
+        swathSounding = swathSize = swathRank = 0;
+        comparedBeams = uncomparedBeams = 0;
+        horizontalDifferenceSum = verticalDifferenceSum = verticalDifferenceSquareSum = 0;
+        maxHorizontalDifference = maxVerticalDifference = 0;
+    }
+
+    /**first sounding, number of soundings matching the beams (0 if they don't) and rank of the next beam of the compared ping*/
+    unsigned int swathSounding = 0, swathSize = 0, swathRank = 0;
+
+    /**number of beams compared with a sounding, or not*/
+    unsigned int comparedBeams = 0, uncomparedBeams = 0;
+
+    /**sums and maxima of the differences between the raytraced beams and the sonar soundings, in meters*/
+    double horizontalDifferenceSum = 0, verticalDifferenceSum = 0, verticalDifferenceSquareSum = 0;
+    double maxHorizontalDifference = 0, maxVerticalDifference = 0;
 };
 
 #endif
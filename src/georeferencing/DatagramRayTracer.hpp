@@ -18,6 +18,9 @@
 #include "../svp/SvpSelectionStrategy.hpp"
 #include "../svp/SoundVelocityProfileFactory.hpp"
 #include "../math/Interpolation.hpp"
+#include "../math/AttitudeSeries.hpp"
+#include "../utils/TimeSeries.hpp"
+#include "../utils/TimestampSort.hpp"
 
 
 /*!
@@ -138,9 +141,9 @@ public:
         }
 
         //Sort everything
-        std::sort(positions.begin(), positions.end(), &Position::sortByTimestamp);
-        std::sort(attitudes.begin(), attitudes.end(), &Attitude::sortByTimestamp);
-        std::sort(pings.begin(), pings.end(), &Ping::sortByTimestamp);
+        positions.sort();
+        attitudes.sort();
+        TimestampSort::sort(pings, &Ping::sortByTimestamp);
 
         // For correct display of timestamps on Windows
         std::cerr <<  "[+] Position data points: " << positions.size() << " [" << positions[0].getTimestamp() << " to " 
@@ -150,6 +153,10 @@ public:
         std::cerr <<  "[+] Ping data points: " << pings.size() << " [" << ( (pings.size() > 0) ? pings[0].getTimestamp() : 0 ) << " to " 
                 << ( (pings.size() > 0) ? pings[pings.size() - 1].getTimestamp() : 0 ) << "]\n";                            
 
+        //attitudes are interpolated as quaternions
+        AttitudeSeries attitudeSeries;
+        attitudeSeries.add(attitudes.getSamples());
+
         //interpolate attitudes and positions around pings
         unsigned int attitudeIndex = 0;
         unsigned int positionIndex = 0;
@@ -158,9 +165,7 @@ public:
         for (auto i = pings.begin(); i != pings.end(); i++) {
 
 
-            while (attitudeIndex + 1 < attitudes.size() && attitudes[attitudeIndex + 1].getTimestamp() < (*i).getTimestamp()) {
-                attitudeIndex++;
-            }
+            attitudeIndex = attitudes.seek((*i).getTimestamp());
 
             //No more attitudes available
             if (attitudeIndex >= attitudes.size() - 1) {
@@ -168,9 +173,7 @@ public:
                 break;
             }
 
-            while (positionIndex + 1 < positions.size() && positions[positionIndex + 1].getTimestamp() < (*i).getTimestamp()) {
-                positionIndex++;
-            }
+            positionIndex = positions.seek((*i).getTimestamp());
 
             //No more positions available
             if (positionIndex >= positions.size() - 1) {
@@ -184,13 +187,9 @@ public:
                 continue;
             }
 
-            Attitude & beforeAttitude = attitudes[attitudeIndex];
-            Attitude & afterAttitude = attitudes[attitudeIndex + 1];
-
             Position & beforePosition = positions[positionIndex];
             Position & afterPosition = positions[positionIndex + 1];
 
-            Attitude * interpolatedAttitude = Interpolator::interpolateAttitude(beforeAttitude, afterAttitude, (*i).getTimestamp());
             Position * interpolatedPosition = Interpolator::interpolatePosition(beforePosition, afterPosition, (*i).getTimestamp());
             
             // Set the transducer depth to draft
@@ -200,7 +199,7 @@ public:
 
             //raytracing
             Eigen::Matrix3d imu2nav;
-            CoordinateTransform::getDCM(imu2nav, *interpolatedAttitude);
+            attitudeSeries.getImu2Ned(imu2nav, attitudeIndex, (*i).getTimestamp());
             
             Eigen::Vector3d rayTracedBeam;
             Raytracing::rayTrace(rayTracedBeam, (*i), *(svpStrategy.chooseSvp(*interpolatedPosition, *i)), boresight, imu2nav);
@@ -208,7 +207,6 @@ public:
 
             processRayTracedBeam(rayTracedBeam);
 
-            delete interpolatedAttitude;
             delete interpolatedPosition;
         }
     }
@@ -229,11 +227,11 @@ protected:
     /**Vector of pings*/
     std::vector<Ping> pings;
 
-    /**Vector of positions*/
-    std::vector<Position> positions;
+    /**Time series of positions*/
+    TimeSeries<Position> positions;
 
-    /**vector of attitudes*/
-    std::vector<Attitude> attitudes;
+    /**Time series of attitudes*/
+    TimeSeries<Attitude> attitudes;
 
     /**Vector of SoundVelocityProfile*/
     std::vector<SoundVelocityProfile*> svps;
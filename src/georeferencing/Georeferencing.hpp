@@ -9,6 +9,7 @@
 #include "../math/CoordinateTransform.hpp"
 #include "Raytracing.hpp"
 #include "../Ping.hpp"
+#include "../Sounding.hpp"
 
 /*!
 * \brief Georeferencing class
@@ -28,7 +29,65 @@ public:
   * @param leverArm vector from the position reference point (PRP) to the acoustic center
   *
   */
-  virtual void georeference(Eigen::Vector3d & georeferencedPing,Attitude & attitude,Position & position,Ping & ping,SoundVelocityProfile & svp,Eigen::Vector3d & leverArm,Eigen::Matrix3d & boresight){};
+  virtual void georeference(Eigen::Vector3d & georeferencedPing,Attitude & attitude,Position & position,Ping & ping,SoundVelocityProfile & svp,Eigen::Vector3d & leverArm,Eigen::Matrix3d & boresight){
+    Eigen::Matrix3d imu2ned;
+    CoordinateTransform::getDCM(imu2ned,attitude);
+
+    georeference(georeferencedPing,imu2ned,position,ping,svp,leverArm,boresight);
+  };
+
+  /**
+  * Georeferences a ping with the rotation of the ship, as given by an AttitudeSeries
+  *
+  * @param georeferencedPing georeferenced ping in vector form
+  * @param imu2ned the rotation from the IMU frame to the navigation frame
+  * @param position the position of the ship in the TRF
+  * @param ping the ping of the georeference in the sonar frame
+  * @param svp the SoundVelocityProfile
+  * @param leverArm vector from the position reference point (PRP) to the acoustic center
+  *
+  */
+  virtual void georeference(Eigen::Vector3d & georeferencedPing,Eigen::Matrix3d & imu2ned,Position & position,Ping & ping,SoundVelocityProfile & svp,Eigen::Vector3d & leverArm,Eigen::Matrix3d & boresight){};
+
+  /**
+  * Georeferences a sounding the sonar already raytraced, without raytracing it again
+  * The sonar measures x and y from the PRP, so only the vertical component of the lever arm is added
+  *
+  * @param georeferencedSounding georeferenced sounding in vector form
+  * @param imu2ned the rotation from the IMU frame to the navigation frame, which rotates the lever arm
+  * @param position the position of the ship in the TRF
+  * @param sounding the sounding in the surface frame of the vessel
+  * @param leverArm vector from the position reference point (PRP) to the acoustic center
+  *
+  */
+  virtual void georeferenceSounding(Eigen::Vector3d & georeferencedSounding,Eigen::Matrix3d & imu2ned,Position & position,Sounding & sounding,Eigen::Vector3d & leverArm){};
+
+  /**
+  * Rotates a sounding from the surface frame of the vessel to the navigation frame (NED)
+  *
+  * @param soundingNED the sounding in the navigation frame
+  * @param sounding the sounding in the surface frame of the vessel, which is horizontal and only needs the heading
+  */
+  static void getSoundingNED(Eigen::Vector3d & soundingNED,Sounding & sounding){
+    double sinHeading = sin(sounding.getHeading()*D2R);
+    double cosHeading = cos(sounding.getHeading()*D2R);
+    Eigen::Vector3d & v = sounding.getVector();
+
+    soundingNED << cosHeading * v(0) - sinHeading * v(1), sinHeading * v(0) + cosHeading * v(1), v(2);
+  }
+
+  /**
+  * Returns the sounding relative to the position reference point, in the navigation frame (NED)
+  *
+  * @param soundingNED the sounding from the PRP in the navigation frame
+  * @param imu2ned the rotation from the IMU frame to the navigation frame
+  * @param sounding the sounding in the surface frame of the vessel
+  * @param leverArm vector from the PRP to the acoustic center, of which only the height of the transducer is used
+  */
+  static void getSoundingFromPRP(Eigen::Vector3d & soundingNED,Eigen::Matrix3d & imu2ned,Sounding & sounding,Eigen::Vector3d & leverArm){
+    getSoundingNED(soundingNED,sounding);
+    soundingNED(2) += imu2ned.row(2).dot(leverArm);
+  }
 };
 
 /*!
@@ -39,18 +98,20 @@ public:
 class GeoreferencingTRF : public Georeferencing{
 public:
 
+  using Georeferencing::georeference;
+
   /**
   * Georeferences a ping in the TRF
   *
   * @param georeferencedPing vector of a ping georeferenced
-  * @param attitude the attitude of the ship in the IM frame
+  * @param imu2ned the rotation from the IMU frame to the navigation frame
   * @param position the position of the ship in the TRF
   * @param ping the ping of the georeference in the sonar frame
   * @param svp the sound velocity profile
   * @param leverArm vector from the position reference point (PRP) to the acoustic center
   *
   */
-  void georeference(Eigen::Vector3d & georeferencedPing,Attitude & attitude,Position & position,Ping & ping,SoundVelocityProfile & svp,Eigen::Vector3d & leverArm,Eigen::Matrix3d & boresight) {
+  void georeference(Eigen::Vector3d & georeferencedPing,Eigen::Matrix3d & imu2ned,Position & position,Ping & ping,SoundVelocityProfile & svp,Eigen::Vector3d & leverArm,Eigen::Matrix3d & boresight) {
     //Compute transform matrixes
     Eigen::Matrix3d ned2ecef;
     CoordinateTransform::ned2ecef(ned2ecef,position);
@@ -59,9 +120,6 @@ public:
         std::cerr << "NED 2 ECEF: " << std::endl << ned2ecef << std::endl << std::endl;
 #endif
 
-    Eigen::Matrix3d imu2ned;
-    CoordinateTransform::getDCM(imu2ned,attitude);
-
 #ifdef DEBUG
         std::cerr << "IMU 2 NED: " << std::endl << imu2ned << std::endl << std::endl;
 #endif
@@ -99,6 +157,29 @@ public:
 
     georeferencedPing = positionECEF + pingECEF + leverArmECEF;
   }
+
+  /**
+  * Georeferences a sounding the sonar already raytraced in the TRF
+  *
+  * @param georeferencedSounding vector of a sounding georeferenced
+  * @param imu2ned the rotation from the IMU frame to the navigation frame
+  * @param position the position of the ship in the TRF
+  * @param sounding the sounding in the surface frame of the vessel
+  * @param leverArm vector from the position reference point (PRP) to the acoustic center
+  *
+  */
+  void georeferenceSounding(Eigen::Vector3d & georeferencedSounding,Eigen::Matrix3d & imu2ned,Position & position,Sounding & sounding,Eigen::Vector3d & leverArm) {
+    Eigen::Matrix3d ned2ecef;
+    CoordinateTransform::ned2ecef(ned2ecef,position);
+
+    Eigen::Vector3d positionECEF;
+    CoordinateTransform::getPositionECEF(positionECEF,position);
+
+    Eigen::Vector3d soundingNED;
+    getSoundingFromPRP(soundingNED,imu2ned,sounding,leverArm);
+
+    georeferencedSounding = positionECEF + ned2ecef * soundingNED;
+  }
 };
 
 
@@ -108,11 +189,13 @@ public:
 class GeoreferencingLGF : public Georeferencing{
 public:
 
+    using Georeferencing::georeference;
+
     /**
      * Georeferences a ping in the LGF (NED)
      *
      * @param georeferencedPing vector of a ping georeferenced
-     * @param attitude the attitude of the ship in the IM frame
+     * @param imu2ned the rotation from the IMU frame to the navigation frame
      * @param position the position of the ship in the TRF
      * @param ping the ping of the georeference in the sonar frame
      * @param svp the sound velocity profile
@@ -120,10 +203,7 @@ public:
      *
      */
     
-    virtual void georeference(Eigen::Vector3d & georeferencedPing,Attitude & attitude,Position & position,Ping & ping,SoundVelocityProfile & svp,Eigen::Vector3d & leverArm,Eigen::Matrix3d & boresight) {
-        Eigen::Matrix3d imu2ned;
-        CoordinateTransform::getDCM(imu2ned,attitude);
-
+    virtual void georeference(Eigen::Vector3d & georeferencedPing,Eigen::Matrix3d & imu2ned,Position & position,Ping & ping,SoundVelocityProfile & svp,Eigen::Vector3d & leverArm,Eigen::Matrix3d & boresight) {
 	//Convert position's geographic coordinates to ECEF, and then from ECEF to NED
         Eigen::Vector3d positionECEF;
         CoordinateTransform::getPositionECEF(positionECEF,position);
@@ -147,6 +227,28 @@ public:
         georeferencedPing = positionNED + pingNED + leverArmNED;
     }
 
+    /**
+     * Georeferences a sounding the sonar already raytraced in the LGF (NED)
+     *
+     * @param georeferencedSounding vector of a sounding georeferenced
+     * @param imu2ned the rotation from the IMU frame to the navigation frame
+     * @param position the position of the ship in the TRF
+     * @param sounding the sounding in the surface frame of the vessel
+     * @param leverArm vector from the position reference point (PRP) to the acoustic center
+     *
+     */
+    virtual void georeferenceSounding(Eigen::Vector3d & georeferencedSounding,Eigen::Matrix3d & imu2ned,Position & position,Sounding & sounding,Eigen::Vector3d & leverArm) {
+        Eigen::Vector3d positionECEF;
+        CoordinateTransform::getPositionECEF(positionECEF,position);
+
+        Eigen::Vector3d positionNED = ecef2ned * (positionECEF-centroidECEF);
+
+        Eigen::Vector3d soundingNED;
+        getSoundingFromPRP(soundingNED,imu2ned,sounding,leverArm);
+
+        georeferencedSounding = positionNED + soundingNED;
+    }
+
     /**
      * Sets centroid and inits ECEF 2 NED matrix
      */
@@ -9,6 +9,7 @@
 #include "../svp/SoundVelocityProfile.hpp"
 #include "../Ping.hpp"
 #include "../math/CoordinateTransform.hpp"
+#include "../utils/Stats.hpp"
 
 
 /*!
@@ -90,7 +91,8 @@ public:
      * @param svp the SoundVelocityProfile for the raytracing
      */
     static void rayTrace(Eigen::Vector3d & raytracedPing,Ping & ping,SoundVelocityProfile & svp, Eigen::Matrix3d & boresightMatrix,Eigen::Matrix3d & imu2nav){
-        
+        STATS_STAGE(STATS_RAYTRACING);
+
 	double sinAz;
 	double cosAz;
 	double beta0;
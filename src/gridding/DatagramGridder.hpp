@@ -0,0 +1,72 @@
+/*
+* Copyright 2020 © Centre Interdisciplinaire de développement en Cartographie des Océans (CIDCO), Tous droits réservés
+*/
+
+#ifndef DATAGRAMGRIDDER_HPP
+#define DATAGRAMGRIDDER_HPP
+
+#include "../georeferencing/DatagramGeoreferencer.hpp"
+#include "../georeferencing/Georeferencing.hpp"
+#include "DtmGridWriter.hpp"
+
+/*!
+* \brief Georeferences pings straight into a DtmGrid or a DtmGridStore
+*
+* Soundings are georeferenced in the local geodetic frame of a GeoreferencingLGF and added to the grid
+* as they are produced, instead of being printed. The grid origin is the centroid of the LGF.
+*/
+class DatagramGridder : public DatagramGeoreferencer {
+public:
+
+    /**
+    * Creates a datagram gridder
+    *
+    * @param lgf the local geodetic frame georeferencing
+    * @param svpStrat the svp selection strategy
+    * @param grid the grid receiving the soundings
+    */
+    DatagramGridder(GeoreferencingLGF & lgf, SvpSelectionStrategy & svpStrat, DtmGridWriter & grid) : DatagramGeoreferencer(lgf, svpStrat), lgf(lgf), grid(grid) {
+
+    }
+
+    /**Destroys the datagram gridder*/
+    ~DatagramGridder() {
+
+    }
+
+    /**
+    * Adds a georeferenced sounding to the grid
+    *
+    * @param georeferencedPing the sounding (north, east, down) in the LGF
+    * @param quality the sounding quality
+    * @param intensity the sounding intensity
+    * @param positionIndex index of the position before the ping
+    * @param attitudeIndex index of the attitude before the ping
+    */
+    virtual void processGeoreferencedPing(Eigen::Vector3d & georeferencedPing, uint32_t quality, int32_t intensity, int positionIndex, int attitudeIndex) {
+        if (!grid.hasOrigin()) {
+            grid.setOrigin(*lgf.getCentroid());
+        }
+
+        grid.add(georeferencedPing(0), georeferencedPing(1), georeferencedPing(2));
+        nbSoundings++;
+    }
+
+    /**Returns the number of soundings added to the grid*/
+    uint64_t getNumberOfSoundings() {
+        return nbSoundings;
+    }
+
+private:
+
+    /**the local geodetic frame georeferencing*/
+    GeoreferencingLGF & lgf;
+
+    /**the grid receiving the soundings*/
+    DtmGridWriter & grid;
+
+    /**number of soundings added to the grid*/
+    uint64_t nbSoundings = 0;
+};
+
+#endif /* DATAGRAMGRIDDER_HPP */
@@ -0,0 +1,306 @@
+/*
+* Copyright 2020 © Centre Interdisciplinaire de développement en Cartographie des Océans (CIDCO), Tous droits réservés
+*/
+
+#ifndef DTMGRID_HPP
+#define DTMGRID_HPP
+
+#include <cstdint>
+#include <cmath>
+#include <vector>
+#include <unordered_map>
+#include <ostream>
+#include "../Position.hpp"
+#include "TiledGridFrame.hpp"
+#include "DtmGridWriter.hpp"
+
+/*!
+* \brief Statistics of the soundings falling into one cell of a DtmGrid
+*
+* Mean and variance are accumulated in a single pass with Welford's method.
+*/
+class DtmCell {
+public:
+
+    /**
+    * Adds a sounding to the cell
+    *
+    * @param z the sounding depth
+    */
+    void add(double z) {
+        count++;
+
+        double delta = z - mean;
+        mean += delta / count;
+        m2 += delta * (z - mean);
+
+        if (count == 1 || z < min) {
+            min = z;
+        }
+
+        if (count == 1 || z > max) {
+            max = z;
+        }
+    }
+
+    /**Returns the sample variance, 0 with less than two soundings*/
+    double getVariance() const {
+        return (count > 1) ? m2 / (count - 1) : 0.0;
+    }
+
+    /**Returns the sample standard deviation*/
+    double getStandardDeviation() const {
+        return std::sqrt(getVariance());
+    }
+
+    /**Mean depth*/
+    double mean = 0;
+
+    /**Sum of the squared differences to the mean*/
+    double m2 = 0;
+
+    /**Shallowest depth*/
+    float min = 0;
+
+    /**Deepest depth*/
+    float max = 0;
+
+    /**Number of soundings*/
+    uint32_t count = 0;
+};
+
+/*!
+* \brief Sparse digital terrain model grid
+*
+* Cells are square, in a local geodetic frame (north, east, down) centered on an origin, usually the
+* centroid of a GeoreferencingLGF. Soundings are accumulated one at a time, so the grid is built in a
+* single streaming pass without keeping the soundings.
+*
+* Tiles of TILE_SIZE x TILE_SIZE cells are kept in a hash map and only created where soundings land,
+* so memory follows coverage, not the area of the bounding box.
+*/
+class DtmGrid : public DtmGridWriter {
+public:
+
+    /**Number of cells on each side of a tile*/
+    static const int TILE_SIZE = 128;
+
+    /**Local frame and cell indexing of the grid*/
+    typedef TiledGridFrame<TILE_SIZE> Frame;
+
+    /**A block of TILE_SIZE x TILE_SIZE cells*/
+    class Tile {
+    public:
+        Tile(int32_t column, int32_t row) : column(column), row(row), cells(TILE_SIZE * TILE_SIZE) {
+        }
+
+        /**Tile column, in tiles east of the origin*/
+        int32_t column;
+
+        /**Tile row, in tiles north of the origin*/
+        int32_t row;
+
+        /**Cells, row-major from the south-west corner*/
+        std::vector<DtmCell> cells;
+    };
+
+    /**
+    * Creates an empty grid
+    *
+    * @param cellSize size of a cell in meters
+    */
+    DtmGrid(double cellSize) : frame(cellSize), lastTile(NULL) {
+    }
+
+    /**Destroys the grid and its tiles*/
+    ~DtmGrid() {
+        for (auto i = tiles.begin(); i != tiles.end(); i++) {
+            delete i->second;
+        }
+    }
+
+    /**
+    * Sets the origin of the local frame
+    *
+    * @param origin the origin position
+    */
+    virtual void setOrigin(Position & origin) {
+        frame.setOrigin(origin);
+    }
+
+    /**Returns true once the origin is set*/
+    virtual bool hasOrigin() {
+        return frame.hasOrigin();
+    }
+
+    /**Returns the origin of the local frame*/
+    Position & getOrigin() {
+        return frame.getOrigin();
+    }
+
+    /**
+    * Converts a local (north, east) position into a geographic position
+    *
+    * @param north meters north of the origin
+    * @param east meters east of the origin
+    * @param position receives the geographic position
+    */
+    void toGeographic(double north, double east, Position & position) {
+        frame.toGeographic(north, east, position);
+    }
+
+    /**
+    * Adds a sounding at a local position
+    *
+    * @param north meters north of the origin
+    * @param east meters east of the origin
+    * @param z the sounding depth
+    */
+    virtual void add(double north, double east, double z) {
+        int32_t cellColumn = getCellColumn(east);
+        int32_t cellRow = getCellRow(north);
+
+        Tile * tile = getTile(Frame::getTileIndex(cellColumn), Frame::getTileIndex(cellRow), true);
+        tile->cells[Frame::getCellOffset(tile->column, tile->row, cellColumn, cellRow)].add(z);
+    }
+
+    /**
+    * Replaces the statistics of a cell
+    *
+    * @param cellColumn cell column, east of the origin
+    * @param cellRow cell row, north of the origin
+    * @param cell the new statistics
+    */
+    void setCell(int32_t cellColumn, int32_t cellRow, DtmCell & cell) {
+        Tile * tile = getTile(Frame::getTileIndex(cellColumn), Frame::getTileIndex(cellRow), true);
+        tile->cells[Frame::getCellOffset(tile->column, tile->row, cellColumn, cellRow)] = cell;
+    }
+
+    /**
+    * Returns the cell containing a local position
+    *
+    * @param north meters north of the origin
+    * @param east meters east of the origin
+    * @return the cell, or NULL if no sounding landed in it
+    */
+    DtmCell * getCell(double north, double east) {
+        int32_t cellColumn = getCellColumn(east);
+        int32_t cellRow = getCellRow(north);
+
+        Tile * tile = getTile(Frame::getTileIndex(cellColumn), Frame::getTileIndex(cellRow), false);
+
+        if (!tile) {
+            return NULL;
+        }
+
+        DtmCell & cell = tile->cells[Frame::getCellOffset(tile->column, tile->row, cellColumn, cellRow)];
+
+        return (cell.count > 0) ? &cell : NULL;
+    }
+
+    /**Returns the cell column of an easting*/
+    int32_t getCellColumn(double east) {
+        return frame.getCellColumn(east);
+    }
+
+    /**Returns the cell row of a northing*/
+    int32_t getCellRow(double north) {
+        return frame.getCellRow(north);
+    }
+
+    /**Returns the tiles, by key*/
+    std::unordered_map<uint64_t, Tile*> & getTiles() {
+        return tiles;
+    }
+
+    /**Returns the number of tiles*/
+    unsigned int getNumberOfTiles() {
+        return tiles.size();
+    }
+
+    /**Returns the number of cells holding at least one sounding*/
+    uint64_t getNumberOfCells() {
+        uint64_t total = 0;
+
+        for (auto i = tiles.begin(); i != tiles.end(); i++) {
+            for (auto cell = i->second->cells.begin(); cell != i->second->cells.end(); cell++) {
+                if (cell->count > 0) {
+                    total++;
+                }
+            }
+        }
+
+        return total;
+    }
+
+    /**Returns the size of a cell in meters*/
+    double getCellSize() {
+        return frame.getCellSize();
+    }
+
+    /**
+    * Writes every cell holding data as "longitude latitude count mean min max stddev" lines
+    *
+    * @param out the output stream
+    */
+    void writeXyz(std::ostream & out) {
+        Position position(0, 0, 0, 0);
+
+        for (auto i = tiles.begin(); i != tiles.end(); i++) {
+            Tile * tile = i->second;
+
+            for (int row = 0; row < TILE_SIZE; row++) {
+                for (int column = 0; column < TILE_SIZE; column++) {
+                    DtmCell & cell = tile->cells[row * TILE_SIZE + column];
+
+                    if (cell.count > 0) {
+                        frame.cellToGeographic(tile->column * TILE_SIZE + column, tile->row * TILE_SIZE + row, position);
+
+                        out << std::fixed;
+                        out.precision(9);
+                        out << position.getLongitude() << " " << position.getLatitude() << " " << cell.count << " ";
+                        out.precision(3);
+                        out << cell.mean << " " << cell.min << " " << cell.max << " " << cell.getStandardDeviation() << std::endl;
+                    }
+                }
+            }
+        }
+    }
+
+private:
+
+    /**Returns a tile, creating it if asked to. Consecutive soundings usually share a tile, so the last one is kept at hand*/
+    Tile * getTile(int32_t column, int32_t row, bool create) {
+        if (lastTile && lastTile->column == column && lastTile->row == row) {
+            return lastTile;
+        }
+
+        uint64_t key = Frame::getTileKey(column, row);
+
+        auto i = tiles.find(key);
+
+        if (i != tiles.end()) {
+            lastTile = i->second;
+            return lastTile;
+        }
+
+        if (!create) {
+            return NULL;
+        }
+
+        lastTile = new Tile(column, row);
+        tiles[key] = lastTile;
+        return lastTile;
+    }
+
+    /**Local frame and cell size*/
+    Frame frame;
+
+    /**Tiles, by key*/
+    std::unordered_map<uint64_t, Tile*> tiles;
+
+    /**Tile that received the last sounding*/
+    Tile * lastTile;
+};
+
+#endif /* DTMGRID_HPP */
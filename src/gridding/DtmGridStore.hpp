@@ -0,0 +1,607 @@
+/*
+* Copyright 2020 © Centre Interdisciplinaire de développement en Cartographie des Océans (CIDCO), Tous droits réservés
+*/
+
+#ifndef DTMGRIDSTORE_HPP
+#define DTMGRIDSTORE_HPP
+
+#include <cstdint>
+#include <cstdio>
+#include <cmath>
+#include <string>
+#include <list>
+#include <vector>
+#include <unordered_map>
+#include <unordered_set>
+#include <mutex>
+#include <atomic>
+#include <thread>
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#include <direct.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#include "../Position.hpp"
+#include "../utils/Exception.hpp"
+#include "DtmGrid.hpp"
+#include "DtmGridWriter.hpp"
+
+/*!
+* \brief Out-of-core DTM grid, stored as one memory-mapped file per tile
+*
+* The store is a directory holding:
+* - "grid.meta": the cell size and origin of the grid
+* - "tiles.idx": the column and row of every tile, appended as tiles are created
+* - "<column>_<row>.tile": the TILE_SIZE x TILE_SIZE DtmCell of a tile, row-major, in the native byte order
+*
+* Tiles are mapped on demand, and the least recently used unpinned tile is unmapped once more than
+* maxMappedTiles are mapped, so the grid can be far larger than memory.
+*
+* add() may be called from many threads. Each thread keeps the last tile it wrote to pinned, so soundings landing
+* in that tile only take the lock of the tile; the store lock is only held when a thread moves to another tile,
+* to look it up, map or unmap it. flush() unpins the tiles of every thread, and must not run during add().
+*/
+class DtmGridStore : public DtmGridWriter {
+public:
+
+    /**Number of cells on each side of a tile, same as DtmGrid*/
+    static const int TILE_SIZE = DtmGrid::TILE_SIZE;
+
+    /**Number of cells in a tile*/
+    static const unsigned int TILE_CELLS = TILE_SIZE * TILE_SIZE;
+
+    /**
+    * Opens a store, creating it if the directory holds none
+    *
+    * @param directory the store directory
+    * @param cellSize size of a cell in meters, must match an existing store
+    * @param maxMappedTiles number of tiles kept mapped
+    */
+    DtmGridStore(std::string directory, double cellSize, unsigned int maxMappedTiles = 256) : directory(directory), cellSize(cellSize), maxMappedTiles(maxMappedTiles), originSet(false), id(nextId()) {
+        if (cellSize <= 0) {
+            throw new Exception("Grid cell size must be positive");
+        }
+
+        if (maxMappedTiles == 0) {
+            throw new Exception("At least one tile must be mapped");
+        }
+
+#ifdef _WIN32
+        _mkdir(directory.c_str());
+#else
+        mkdir(directory.c_str(), 0755);
+#endif
+
+        if (!readMetadata()) {
+            writeMetadata();
+        }
+
+        readIndex();
+    }
+
+    /**Unmaps every tile. Their content is on disk*/
+    ~DtmGridStore() {
+        for (auto i = mapped.begin(); i != mapped.end(); i++) {
+            unmap(i->second);
+            delete i->second;
+        }
+    }
+
+    /**
+    * Sets the origin of the local frame and saves it
+    *
+    * @param origin the origin position
+    */
+    virtual void setOrigin(Position & origin) {
+        std::lock_guard<std::mutex> lock(storeMutex);
+
+        this->origin = origin;
+        originSet = true;
+        writeMetadata();
+    }
+
+    /**Returns true once the origin is set. Thread safe*/
+    virtual bool hasOrigin() {
+        return originSet.load();
+    }
+
+    /**Returns the origin of the local frame*/
+    Position & getOrigin() {
+        return origin;
+    }
+
+    /**
+    * Adds a sounding at a local position. Thread safe
+    *
+    * @param north meters north of the origin
+    * @param east meters east of the origin
+    * @param z the sounding depth
+    */
+    virtual void add(double north, double east, double z) {
+        int32_t cellColumn = (int32_t) std::floor(east / cellSize);
+        int32_t cellRow = (int32_t) std::floor(north / cellSize);
+
+        int32_t tileColumn = DtmGrid::Frame::getTileIndex(cellColumn);
+        int32_t tileRow = DtmGrid::Frame::getTileIndex(cellRow);
+
+        TileCache * cache = getThreadCache();
+        MappedTile * tile = cache->tile;
+
+        if (!tile || tile->column != tileColumn || tile->row != tileRow) {
+            tile = repin(cache, tileColumn, tileRow);
+        }
+
+        std::lock_guard<std::mutex> lock(tile->mutex);
+        tile->cells[DtmGrid::Frame::getCellOffset(tile->column, tile->row, cellColumn, cellRow)].add(z);
+    }
+
+    /**
+    * Copies the cell containing a local position. Thread safe
+    *
+    * @param north meters north of the origin
+    * @param east meters east of the origin
+    * @param cell receives the cell
+    * @return false if no sounding landed in the cell
+    */
+    bool getCell(double north, double east, DtmCell & cell) {
+        int32_t cellColumn = (int32_t) std::floor(east / cellSize);
+        int32_t cellRow = (int32_t) std::floor(north / cellSize);
+
+        MappedTile * tile = acquire(DtmGrid::Frame::getTileIndex(cellColumn), DtmGrid::Frame::getTileIndex(cellRow), false);
+
+        if (!tile) {
+            return false;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(tile->mutex);
+            cell = tile->cells[DtmGrid::Frame::getCellOffset(tile->column, tile->row, cellColumn, cellRow)];
+        }
+
+        release(tile);
+
+        return cell.count > 0;
+    }
+
+    /**
+    * Copies the cells holding data inside a local bounding box into an in-memory grid.
+    * Only the tiles overlapping the box are mapped
+    *
+    * @param minNorth southern edge of the box
+    * @param minEast western edge of the box
+    * @param maxNorth northern edge of the box
+    * @param maxEast eastern edge of the box
+    * @param grid receives the cells. Its cell size must be the one of the store
+    */
+    void extract(double minNorth, double minEast, double maxNorth, double maxEast, DtmGrid & grid) {
+        if (grid.getCellSize() != cellSize) {
+            throw new Exception("Extracted grid cell size does not match the store");
+        }
+
+        if (originSet && !grid.hasOrigin()) {
+            grid.setOrigin(origin);
+        }
+
+        int32_t minColumn = (int32_t) std::floor(minEast / cellSize);
+        int32_t maxColumn = (int32_t) std::floor(maxEast / cellSize);
+        int32_t minRow = (int32_t) std::floor(minNorth / cellSize);
+        int32_t maxRow = (int32_t) std::floor(maxNorth / cellSize);
+
+        int32_t minTileColumn = DtmGrid::Frame::getTileIndex(minColumn);
+        int32_t maxTileColumn = DtmGrid::Frame::getTileIndex(maxColumn);
+        int32_t minTileRow = DtmGrid::Frame::getTileIndex(minRow);
+        int32_t maxTileRow = DtmGrid::Frame::getTileIndex(maxRow);
+
+        //the index is usually much smaller than the range of tiles covered by a large box
+        std::vector<std::pair<int32_t, int32_t> > overlapping;
+        {
+            std::lock_guard<std::mutex> lock(storeMutex);
+
+            for (auto i = index.begin(); i != index.end(); i++) {
+                int32_t column = (int32_t) (uint32_t) (*i >> 32);
+                int32_t row = (int32_t) (uint32_t) (*i & 0xFFFFFFFF);
+
+                if (column >= minTileColumn && column <= maxTileColumn && row >= minTileRow && row <= maxTileRow) {
+                    overlapping.push_back(std::make_pair(column, row));
+                }
+            }
+        }
+
+        for (auto i = overlapping.begin(); i != overlapping.end(); i++) {
+            MappedTile * tile = acquire(i->first, i->second, false);
+
+            if (!tile) {
+                continue;
+            }
+
+            int32_t firstColumn = std::max(minColumn, tile->column * TILE_SIZE);
+            int32_t lastColumn = std::min(maxColumn, tile->column * TILE_SIZE + TILE_SIZE - 1);
+            int32_t firstRow = std::max(minRow, tile->row * TILE_SIZE);
+            int32_t lastRow = std::min(maxRow, tile->row * TILE_SIZE + TILE_SIZE - 1);
+
+            {
+                std::lock_guard<std::mutex> lock(tile->mutex);
+
+                for (int32_t row = firstRow; row <= lastRow; row++) {
+                    for (int32_t column = firstColumn; column <= lastColumn; column++) {
+                        DtmCell & cell = tile->cells[DtmGrid::Frame::getCellOffset(tile->column, tile->row, column, row)];
+
+                        if (cell.count > 0) {
+                            grid.setCell(column, row, cell);
+                        }
+                    }
+                }
+            }
+
+            release(tile);
+        }
+    }
+
+    /**Unpins the tiles the writing threads kept, and writes the mapped tiles to disk*/
+    void flush() {
+        std::lock_guard<std::mutex> lock(storeMutex);
+
+        for (auto i = caches.begin(); i != caches.end(); i++) {
+            if (i->tile) {
+                i->tile->pins--;
+                i->tile = NULL;
+            }
+        }
+
+        evict();
+
+        for (auto i = mapped.begin(); i != mapped.end(); i++) {
+#ifdef _WIN32
+            FlushViewOfFile(i->second->cells, TILE_CELLS * sizeof(DtmCell));
+#else
+            msync(i->second->cells, TILE_CELLS * sizeof(DtmCell), MS_SYNC);
+#endif
+        }
+    }
+
+    /**Returns the number of tiles in the store*/
+    unsigned int getNumberOfTiles() {
+        std::lock_guard<std::mutex> lock(storeMutex);
+        return index.size();
+    }
+
+    /**Returns the number of tiles currently mapped*/
+    unsigned int getNumberOfMappedTiles() {
+        std::lock_guard<std::mutex> lock(storeMutex);
+        return mapped.size();
+    }
+
+    /**Returns the size of a cell in meters*/
+    double getCellSize() {
+        return cellSize;
+    }
+
+private:
+
+    /**A tile mapped in memory*/
+    class MappedTile {
+    public:
+        /**Tile column, in tiles east of the origin*/
+        int32_t column;
+
+        /**Tile row, in tiles north of the origin*/
+        int32_t row;
+
+        /**The mapped cells*/
+        DtmCell * cells;
+
+        /**Guards the cells*/
+        std::mutex mutex;
+
+        /**Number of users of the tile. A pinned tile is never unmapped*/
+        unsigned int pins;
+
+        /**Position in the LRU list*/
+        std::list<MappedTile*>::iterator lruPosition;
+    };
+
+    /**The tile a thread last wrote to, kept pinned*/
+    typedef struct {
+        std::thread::id thread;
+        MappedTile * tile;
+    } TileCache;
+
+    /**The tile cache of the calling thread for the store it last wrote to*/
+    typedef struct {
+        uint64_t store;
+        TileCache * cache;
+    } ThreadCache;
+
+    /**Returns a store identifier that is never reused, unlike the address of a store*/
+    static uint64_t nextId() {
+        static std::atomic<uint64_t> lastId(0);
+        return ++lastId;
+    }
+
+    /**Returns the tile cache of the calling thread, creating it on the first sounding of the thread*/
+    TileCache * getThreadCache() {
+        static thread_local ThreadCache local = {0, NULL};
+
+        if (local.store == id) {
+            return local.cache;
+        }
+
+        std::lock_guard<std::mutex> lock(storeMutex);
+        std::thread::id thread = std::this_thread::get_id();
+        TileCache * cache = NULL;
+
+        for (auto i = caches.begin(); i != caches.end(); i++) {
+            if (i->thread == thread) {
+                cache = &(*i);
+                break;
+            }
+        }
+
+        if (!cache) {
+            TileCache created = {thread, NULL};
+            caches.push_back(created);
+            cache = &caches.back();
+        }
+
+        local.store = id;
+        local.cache = cache;
+
+        return cache;
+    }
+
+    /**Moves the pin of a thread to another tile, mapping or creating it if needed*/
+    MappedTile * repin(TileCache * cache, int32_t column, int32_t row) {
+        std::lock_guard<std::mutex> lock(storeMutex);
+
+        if (cache->tile) {
+            cache->tile->pins--;
+        }
+
+        cache->tile = acquireLocked(column, row, true);
+
+        return cache->tile;
+    }
+
+    /**Returns the path of a tile file*/
+    std::string getTilePath(int32_t column, int32_t row) {
+        std::stringstream path;
+        path << directory << "/" << column << "_" << row << ".tile";
+        return path.str();
+    }
+
+    /**Returns a pinned tile, mapping it (and creating it if asked to) if needed*/
+    MappedTile * acquire(int32_t column, int32_t row, bool create) {
+        std::lock_guard<std::mutex> lock(storeMutex);
+        return acquireLocked(column, row, create);
+    }
+
+    /**Same as acquire(), with the store lock held*/
+    MappedTile * acquireLocked(int32_t column, int32_t row, bool create) {
+        uint64_t key = DtmGrid::Frame::getTileKey(column, row);
+
+        auto i = mapped.find(key);
+
+        if (i != mapped.end()) {
+            MappedTile * tile = i->second;
+            tile->pins++;
+            lru.splice(lru.begin(), lru, tile->lruPosition);
+            return tile;
+        }
+
+        bool exists = index.count(key) > 0;
+
+        if (!exists && !create) {
+            return NULL;
+        }
+
+        MappedTile * tile = new MappedTile();
+        tile->column = column;
+        tile->row = row;
+        tile->pins = 1;
+        tile->cells = map(getTilePath(column, row));
+
+        if (!exists) {
+            index.insert(key);
+            appendIndex(column, row);
+        }
+
+        mapped[key] = tile;
+        lru.push_front(tile);
+        tile->lruPosition = lru.begin();
+
+        evict();
+
+        return tile;
+    }
+
+    /**Unpins a tile returned by acquire()*/
+    void release(MappedTile * tile) {
+        std::lock_guard<std::mutex> lock(storeMutex);
+        tile->pins--;
+    }
+
+    /**Unmaps the least recently used unpinned tiles until at most maxMappedTiles are mapped*/
+    void evict() {
+        auto i = lru.end();
+
+        while (mapped.size() > maxMappedTiles && i != lru.begin()) {
+            i--;
+
+            MappedTile * tile = *i;
+
+            if (tile->pins == 0) {
+                mapped.erase(DtmGrid::Frame::getTileKey(tile->column, tile->row));
+                unmap(tile);
+                delete tile;
+                i = lru.erase(i);
+            }
+        }
+    }
+
+    /**Maps a tile file, creating it filled with empty cells if needed*/
+    DtmCell * map(std::string path) {
+        size_t size = TILE_CELLS * sizeof(DtmCell);
+
+#ifdef _WIN32
+        HANDLE file = CreateFileA(path.c_str(), GENERIC_READ | GENERIC_WRITE, 0, NULL, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+
+        if (file == INVALID_HANDLE_VALUE) {
+            throw new Exception("Cannot open tile file: " + path);
+        }
+
+        //the mapping grows a new file to its size, filled with zeroes
+        HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READWRITE, 0, (DWORD) size, NULL);
+        CloseHandle(file);
+
+        if (mapping == NULL) {
+            throw new Exception("Cannot map tile file: " + path);
+        }
+
+        void * cells = MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, size);
+        CloseHandle(mapping);
+
+        if (cells == NULL) {
+            throw new Exception("Cannot map tile file: " + path);
+        }
+#else
+        int file = open(path.c_str(), O_RDWR | O_CREAT, 0644);
+
+        if (file < 0) {
+            throw new Exception("Cannot open tile file: " + path);
+        }
+
+        //a new file is grown to its size, filled with zeroes
+        struct stat status;
+
+        if (fstat(file, &status) != 0 || ((size_t) status.st_size < size && ftruncate(file, size) != 0)) {
+            close(file);
+            throw new Exception("Cannot size tile file: " + path);
+        }
+
+        void * cells = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, file, 0);
+        close(file);
+
+        if (cells == MAP_FAILED) {
+            throw new Exception("Cannot map tile file: " + path);
+        }
+#endif
+
+        //an all-zero DtmCell is an empty cell
+        return (DtmCell *) cells;
+    }
+
+    /**Unmaps a tile. The system writes it back to its file*/
+    void unmap(MappedTile * tile) {
+#ifdef _WIN32
+        UnmapViewOfFile(tile->cells);
+#else
+        munmap(tile->cells, TILE_CELLS * sizeof(DtmCell));
+#endif
+    }
+
+    /**Reads the cell size and origin of an existing store*/
+    bool readMetadata() {
+        std::ifstream in(directory + "/grid.meta");
+
+        if (!in) {
+            return false;
+        }
+
+        double storedCellSize;
+        int hasStoredOrigin;
+        double latitude, longitude, height;
+
+        if (!(in >> storedCellSize >> hasStoredOrigin >> latitude >> longitude >> height)) {
+            throw new Exception("Invalid grid store metadata in " + directory);
+        }
+
+        if (storedCellSize != cellSize) {
+            throw new Exception("Grid store " + directory + " has a different cell size");
+        }
+
+        if (hasStoredOrigin) {
+            origin = Position(0, latitude, longitude, height);
+            originSet = true;
+        }
+
+        return true;
+    }
+
+    /**Writes the cell size and origin of the store*/
+    void writeMetadata() {
+        std::ofstream out(directory + "/grid.meta", std::ofstream::trunc);
+
+        if (!out) {
+            throw new Exception("Cannot write grid store metadata in " + directory);
+        }
+
+        out.precision(17);
+        out << cellSize << " " << (originSet ? 1 : 0) << " " << origin.getLatitude() << " " << origin.getLongitude() << " " << origin.getEllipsoidalHeight() << std::endl;
+    }
+
+    /**Reads the tiles of an existing store*/
+    void readIndex() {
+        std::ifstream in(directory + "/tiles.idx");
+        int32_t column, row;
+
+        while (in >> column >> row) {
+            index.insert(DtmGrid::Frame::getTileKey(column, row));
+        }
+    }
+
+    /**Records a new tile*/
+    void appendIndex(int32_t column, int32_t row) {
+        std::ofstream out(directory + "/tiles.idx", std::ofstream::app);
+
+        if (!out) {
+            throw new Exception("Cannot write grid store index in " + directory);
+        }
+
+        out << column << " " << row << std::endl;
+    }
+
+    /**Store directory*/
+    std::string directory;
+
+    /**Size of a cell in meters*/
+    double cellSize;
+
+    /**Number of tiles kept mapped*/
+    unsigned int maxMappedTiles;
+
+    /**Origin of the local frame*/
+    Position origin{0, 0, 0, 0};
+
+    /**True once the origin is set*/
+    std::atomic<bool> originSet;
+
+    /**Identifier of the store, telling the thread caches of different stores apart*/
+    uint64_t id;
+
+    /**Guards the index, the mapped tiles, the LRU list and the thread caches*/
+    std::mutex storeMutex;
+
+    /**Tile caches of the threads that wrote to the store. A list, so the caches do not move*/
+    std::list<TileCache> caches;
+
+    /**Keys of every tile in the store*/
+    std::unordered_set<uint64_t> index;
+
+    /**Mapped tiles, by key*/
+    std::unordered_map<uint64_t, MappedTile*> mapped;
+
+    /**Mapped tiles, most recently used first*/
+    std::list<MappedTile*> lru;
+};
+
+#endif /* DTMGRIDSTORE_HPP */
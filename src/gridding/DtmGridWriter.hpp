@@ -0,0 +1,39 @@
+/*
+* Copyright 2020 © Centre Interdisciplinaire de développement en Cartographie des Océans (CIDCO), Tous droits réservés
+*/
+
+#ifndef DTMGRIDWRITER_HPP
+#define DTMGRIDWRITER_HPP
+
+#include "../Position.hpp"
+
+/*!
+* \brief Anything soundings can be gridded into, in memory (DtmGrid) or on disk (DtmGridStore)
+*/
+class DtmGridWriter {
+public:
+
+    virtual ~DtmGridWriter() {
+    }
+
+    /**
+    * Sets the origin of the local frame
+    *
+    * @param origin the origin position
+    */
+    virtual void setOrigin(Position & origin) = 0;
+
+    /**Returns true once the origin is set*/
+    virtual bool hasOrigin() = 0;
+
+    /**
+    * Adds a sounding at a local position
+    *
+    * @param north meters north of the origin
+    * @param east meters east of the origin
+    * @param z the sounding depth
+    */
+    virtual void add(double north, double east, double z) = 0;
+};
+
+#endif /* DTMGRIDWRITER_HPP */
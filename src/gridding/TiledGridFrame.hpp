@@ -0,0 +1,140 @@
+/*
+* Copyright 2020 © Centre Interdisciplinaire de développement en Cartographie des Océans (CIDCO), Tous droits réservés
+*/
+
+#ifndef TILEDGRIDFRAME_HPP
+#define TILEDGRIDFRAME_HPP
+
+#include <cstdint>
+#include <cmath>
+#include <Eigen/Dense>
+#include "../Position.hpp"
+#include "../math/CoordinateTransform.hpp"
+#include "../utils/Exception.hpp"
+
+/*!
+* \brief Frame and cell indexing shared by the tiled rasters (DtmGrid, SidescanMosaic)
+*
+* Cells are square, in a local geodetic frame (north, east, down) centered on an origin. Cell and tile
+* indices grow east (columns) and north (rows) and may be negative, tiles holding TILE_SIZE x TILE_SIZE cells.
+*/
+template<int TILE_SIZE>
+class TiledGridFrame {
+public:
+
+    /**
+    * Creates a frame without origin
+    *
+    * @param cellSize size of a cell in meters
+    */
+    TiledGridFrame(double cellSize) : cellSize(cellSize), originSet(false) {
+        if (cellSize <= 0) {
+            throw new Exception("Grid cell size must be positive");
+        }
+    }
+
+    /**
+    * Sets the origin of the local frame
+    *
+    * @param origin the origin position
+    */
+    void setOrigin(Position & origin) {
+        this->origin = origin;
+        CoordinateTransform::getPositionECEF(originEcef, this->origin);
+        CoordinateTransform::getTerrestialToLocalGeodeticReferenceFrameMatrix(trf2lgf, this->origin);
+        originSet = true;
+    }
+
+    /**Returns true once the origin is set*/
+    bool hasOrigin() {
+        return originSet;
+    }
+
+    /**Returns the origin of the local frame*/
+    Position & getOrigin() {
+        return origin;
+    }
+
+    /**
+    * Converts an ECEF position into the local frame
+    *
+    * @param ecef the ECEF position
+    * @param local receives north, east, down in meters
+    */
+    void toLocal(Eigen::Vector3d & ecef, Eigen::Vector3d & local) {
+        local = trf2lgf * (ecef - originEcef);
+    }
+
+    /**
+    * Converts a local (north, east) position into a geographic position
+    *
+    * @param north meters north of the origin
+    * @param east meters east of the origin
+    * @param position receives the geographic position
+    */
+    void toGeographic(double north, double east, Position & position) {
+        Eigen::Vector3d local(north, east, 0);
+        Eigen::Vector3d ecef = originEcef + trf2lgf.transpose() * local;
+        CoordinateTransform::convertECEFToLongitudeLatitudeElevation(ecef, position);
+    }
+
+    /**
+    * Converts the center of a cell into a geographic position
+    *
+    * @param cellColumn cell column, east of the origin
+    * @param cellRow cell row, north of the origin
+    * @param position receives the geographic position
+    */
+    void cellToGeographic(int32_t cellColumn, int32_t cellRow, Position & position) {
+        toGeographic(((double) cellRow + 0.5) * cellSize, ((double) cellColumn + 0.5) * cellSize, position);
+    }
+
+    /**Returns the cell column of an easting*/
+    int32_t getCellColumn(double east) {
+        return (int32_t) std::floor(east / cellSize);
+    }
+
+    /**Returns the cell row of a northing*/
+    int32_t getCellRow(double north) {
+        return (int32_t) std::floor(north / cellSize);
+    }
+
+    /**Returns the size of a cell in meters*/
+    double getCellSize() {
+        return cellSize;
+    }
+
+    /**Tile index of a cell index, rounding towards negative infinity*/
+    static int32_t getTileIndex(int32_t cell) {
+        return (cell >= 0) ? cell / TILE_SIZE : -((-cell - 1) / TILE_SIZE) - 1;
+    }
+
+    /**Returns the key of a tile*/
+    static uint64_t getTileKey(int32_t column, int32_t row) {
+        return ((uint64_t) (uint32_t) column << 32) | (uint32_t) row;
+    }
+
+    /**Returns the row-major offset of a cell in the tile at (tileColumn, tileRow), which must hold it*/
+    static unsigned int getCellOffset(int32_t tileColumn, int32_t tileRow, int32_t cellColumn, int32_t cellRow) {
+        return (cellRow - tileRow * TILE_SIZE) * TILE_SIZE + (cellColumn - tileColumn * TILE_SIZE);
+    }
+
+private:
+
+    /**Size of a cell in meters*/
+    double cellSize;
+
+    /**Origin of the local frame*/
+    Position origin{0, 0, 0, 0};
+
+    /**True once the origin is set*/
+    bool originSet;
+
+    /**Origin in ECEF*/
+    Eigen::Vector3d originEcef;
+
+    /**ECEF to local frame rotation at the origin*/
+    Eigen::Matrix3d trf2lgf;
+};
+
+#endif /* TILEDGRIDFRAME_HPP */
@@ -0,0 +1,173 @@
+/*
+* Copyright 2020 © Centre Interdisciplinaire de développement en Cartographie des Océans (CIDCO), Tous droits réservés
+*/
+
+#ifndef ATTITUDESERIES_HPP
+#define ATTITUDESERIES_HPP
+
+#include <cstdint>
+#include <climits>
+#include <vector>
+#include <algorithm>
+#include <Eigen/Dense>
+#include "../Attitude.hpp"
+#include "../utils/Constants.hpp"
+
+/*!
+* \brief Time series of attitudes interpolated as unit quaternions
+*
+* Each attitude is converted to a unit quaternion once, when it is added. Rotations between two attitudes
+* are interpolated along the shortest arc, with a normalised lerp or a slerp, so there are no angles to wrap
+* and opposite headings are not ambiguous. The rotation matrix of the last lookup is kept, since all the
+* beams of a ping share its timestamp.
+*/
+class AttitudeSeries {
+public:
+
+    /**
+    * Creates an empty attitude series
+    *
+    * @param slerp true to interpolate with a slerp, false for a normalised lerp
+    */
+    AttitudeSeries(bool slerp = false) : slerp(slerp), cachedIndex(UINT_MAX), cachedTimestamp(0) {
+    }
+
+    /**
+    * Adds an attitude, after the attitudes already added
+    *
+    * @param attitude the attitude, in timestamp order
+    */
+    void add(Attitude & attitude) {
+        Eigen::Quaterniond q;
+        toQuaternion(q, attitude.getRoll(), attitude.getPitch(), attitude.getHeading());
+
+        timestamps.push_back(attitude.getTimestamp());
+        quaternions.push_back(q);
+        cachedIndex = UINT_MAX;
+    }
+
+    /**
+    * Adds attitudes, after the attitudes already added
+    *
+    * @param attitudes the attitudes, sorted by timestamp
+    */
+    void add(std::vector<Attitude> & attitudes) {
+        timestamps.reserve(timestamps.size() + attitudes.size());
+        quaternions.reserve(quaternions.size() + attitudes.size());
+
+        for (auto i = attitudes.begin(); i != attitudes.end(); i++) {
+            add(*i);
+        }
+    }
+
+    /**Returns the number of attitudes*/
+    unsigned int size() const {
+        return timestamps.size();
+    }
+
+    /**Returns the timestamp of an attitude*/
+    uint64_t getTimestamp(unsigned int index) const {
+        return timestamps[index];
+    }
+
+    /**Returns the unit quaternion of an attitude*/
+    const Eigen::Quaterniond & getQuaternion(unsigned int index) const {
+        return quaternions[index];
+    }
+
+    /**
+    * Computes the IMU to NED rotation at a timestamp, interpolated between an attitude and the next one
+    *
+    * @param imu2ned the rotation matrix, as CoordinateTransform::getDCM would give
+    * @param index the attitude before the timestamp, the last one gives its own rotation
+    * @param timestamp time in microsecond since 1st January 1970
+    */
+    void getImu2Ned(Eigen::Matrix3d & imu2ned, unsigned int index, uint64_t timestamp) {
+        if (index == cachedIndex && timestamp == cachedTimestamp) {
+            imu2ned = cachedImu2Ned;
+            return;
+        }
+
+        const Eigen::Quaterniond & q1 = quaternions[index];
+
+        if (index + 1 >= timestamps.size() || timestamps[index + 1] == timestamps[index]) {
+            cachedImu2Ned = q1.toRotationMatrix();
+        }
+        else {
+            const Eigen::Quaterniond & q2 = quaternions[index + 1];
+            double ratio = ((double) timestamp - (double) timestamps[index]) / (double) (timestamps[index + 1] - timestamps[index]);
+
+            Eigen::Quaterniond q;
+
+            if (slerp) {
+                q = q1.slerp(ratio, q2);
+            }
+            else {
+                //q and -q are the same rotation, the closest one gives the shortest arc
+                double sign = (q1.dot(q2) < 0) ? -1.0 : 1.0;
+                q.coeffs() = q1.coeffs() * (1 - ratio) + q2.coeffs() * (sign * ratio);
+                q.normalize();
+            }
+
+            cachedImu2Ned = q.toRotationMatrix();
+        }
+
+        cachedIndex = index;
+        cachedTimestamp = timestamp;
+        imu2ned = cachedImu2Ned;
+    }
+
+    /**
+    * Computes the IMU to NED rotation at a timestamp
+    *
+    * @param imu2ned the rotation matrix, as CoordinateTransform::getDCM would give
+    * @param timestamp time in microsecond since 1st January 1970
+    * @return false if the timestamp is outside of the series
+    */
+    bool getImu2Ned(Eigen::Matrix3d & imu2ned, uint64_t timestamp) {
+        if (timestamps.empty() || timestamp < timestamps.front() || timestamp > timestamps.back()) {
+            return false;
+        }
+
+        unsigned int index = std::upper_bound(timestamps.begin(), timestamps.end(), timestamp) - timestamps.begin() - 1;
+        getImu2Ned(imu2ned, index, timestamp);
+
+        return true;
+    }
+
+    /**
+    * Converts roll, pitch and heading to the unit quaternion of the IMU to NED rotation
+    *
+    * @param q the unit quaternion
+    * @param rollDegrees the roll angle
+    * @param pitchDegrees the pitch angle
+    * @param headingDegrees the heading angle
+    */
+    static void toQuaternion(Eigen::Quaterniond & q, double rollDegrees, double pitchDegrees, double headingDegrees) {
+        q = Eigen::AngleAxisd(headingDegrees * D2R, Eigen::Vector3d::UnitZ())
+                * Eigen::AngleAxisd(pitchDegrees * D2R, Eigen::Vector3d::UnitY())
+                * Eigen::AngleAxisd(rollDegrees * D2R, Eigen::Vector3d::UnitX());
+    }
+
+private:
+
+    /**true to interpolate with a slerp, false for a normalised lerp*/
+    bool slerp;
+
+    /**Timestamps of the attitudes*/
+    std::vector<uint64_t> timestamps;
+
+    /**Unit quaternions of the attitudes*/
+    std::vector<Eigen::Quaterniond, Eigen::aligned_allocator<Eigen::Quaterniond> > quaternions;
+
+    /**Attitude index of the last lookup, UINT_MAX if none*/
+    unsigned int cachedIndex;
+
+    /**Timestamp of the last lookup*/
+    uint64_t cachedTimestamp;
+
+    /**Rotation of the last lookup*/
+    Eigen::Matrix3d cachedImu2Ned;
+};
+
+#endif /* ATTITUDESERIES_HPP */
@@ -18,6 +18,7 @@
 #endif
 
 #include <vector>
+#include <algorithm>
 #include <Eigen/Dense>
 #include "../Position.hpp"
 #include "../utils/Constants.hpp"
@@ -95,63 +96,95 @@ public:
         double Z = a_inverse * ec * std::abs(z);
 
         //double R = std::sqrt(pp + z * z);
-        std::vector<double> S(numberOfIterations + 1, 0);
-        std::vector<double> C(numberOfIterations + 1, 0);
-
-        std::vector<double> D(numberOfIterations + 1, 0);
-        std::vector<double> F(numberOfIterations + 1, 0);
-
-        std::vector<double> A(numberOfIterations + 1, 0);
-        std::vector<double> B(numberOfIterations + 1, 0);
-
-        S[0] = Z; //starter variables. See (Fukushima, 2006) p.691 equation (17)
-        C[0] = ec*P; //starter variables. See (Fukushima, 2006) p.691 equation (17)
-        A[0] = std::sqrt(S[0] * S[0] + C[0] * C[0]);
-        B[0] = 1.5 * e2 * e2 * P * S[0] * S[0] * C[0] * C[0] * (A[0] - ec); //starter variables. See (Fukushima, 2006) p.691 equation  (18)
-
-        unsigned int iterationNumber = 1;
-
-        while (iterationNumber <= numberOfIterations) {
-
-            D[iterationNumber - 1] =
-                    Z * A[iterationNumber - 1] * A[iterationNumber - 1] * A[iterationNumber - 1] +
-                    e2 * S[iterationNumber - 1] * S[iterationNumber - 1] * S[iterationNumber - 1];
-            F[iterationNumber - 1] =
-                    P * A[iterationNumber - 1] * A[iterationNumber - 1] * A[iterationNumber - 1] -
-                    e2 * C[iterationNumber - 1] * C[iterationNumber - 1] * C[iterationNumber - 1];
-
-            S[iterationNumber] =
-                    D[iterationNumber - 1] * F[iterationNumber - 1] -
-                    B[iterationNumber - 1] * S[iterationNumber - 1];
-            C[iterationNumber] =
-                    F[iterationNumber - 1] * F[iterationNumber - 1] -
-                    B[iterationNumber - 1] * C[iterationNumber - 1];
-
-            A[iterationNumber] = std::sqrt(
-                    S[iterationNumber] * S[iterationNumber] +
-                    C[iterationNumber] * C[iterationNumber]);
-
-            B[iterationNumber] =
-                    1.5 *
-                    e2 * S[iterationNumber] *
-                    C[iterationNumber] * C[iterationNumber] *
-                    ((P * S[iterationNumber] - Z * C[iterationNumber]) * A[iterationNumber] -
-                    e2 * S[iterationNumber] * C[iterationNumber]);
-
-            ++iterationNumber;
-        }
+        double S, C, A;
+        iterate(P, Z, S, C, A);
 
         double lon = estimateLongitude(x, y, p);
 
-        double Cc = ec*C[numberOfIterations];
-        double lat = estimateLatitude(z, S[numberOfIterations], Cc);
-        double h = estimateHeight(z, p, A[numberOfIterations], S[numberOfIterations], Cc);
+        double Cc = ec*C;
+        double lat = estimateLatitude(z, S, Cc);
+        double h = estimateHeight(z, p, A, S, Cc);
 
         positionGeographic.setLatitude(lat*R2D);
         positionGeographic.setLongitude(lon*R2D);
         positionGeographic.setEllipsoidalHeight(h);
     }
 
+    /**
+     * Converts ECEF positions to longitudes, latitudes and heights, in degrees and meters
+     *
+     * The iterations run over blocks of positions, one step at a time, in loops without branches
+     * that the compiler can vectorise. Positions on the axis of the Earth or on the equator are
+     * converted one at a time afterwards. Results are those of the conversion of a single position.
+     *
+     * @param x ECEF x of the positions
+     * @param y ECEF y of the positions
+     * @param z ECEF z of the positions
+     * @param nbPositions number of positions
+     * @param longitudes receives the longitudes
+     * @param latitudes receives the latitudes
+     * @param heights receives the ellipsoidal heights
+     */
+    void ecefToLongitudeLatitudeElevation(const double * x, const double * y, const double * z, unsigned int nbPositions, double * longitudes, double * latitudes, double * heights) {
+        const unsigned int blockSize = 256;
+
+        double P[blockSize], Z[blockSize], S[blockSize], C[blockSize], A[blockSize], B[blockSize];
+
+        for (unsigned int first = 0; first < nbPositions; first += blockSize) {
+            unsigned int n = std::min(blockSize, nbPositions - first);
+            const double * bx = x + first;
+            const double * by = y + first;
+            const double * bz = z + first;
+
+            //starter variables. See (Fukushima, 2006) p.691 equations (17) and (18)
+            for (unsigned int i = 0; i < n; i++) {
+                P[i] = std::sqrt(bx[i] * bx[i] + by[i] * by[i]) * a_inverse;
+                Z[i] = a_inverse * ec * std::abs(bz[i]);
+                S[i] = Z[i];
+                C[i] = ec * P[i];
+                A[i] = std::sqrt(S[i] * S[i] + C[i] * C[i]);
+                B[i] = 1.5 * e2 * e2 * P[i] * S[i] * S[i] * C[i] * C[i] * (A[i] - ec);
+            }
+
+            for (unsigned int iteration = 0; iteration < numberOfIterations; iteration++) {
+                for (unsigned int i = 0; i < n; i++) {
+                    double D = Z[i] * A[i] * A[i] * A[i] + e2 * S[i] * S[i] * S[i];
+                    double F = P[i] * A[i] * A[i] * A[i] - e2 * C[i] * C[i] * C[i];
+
+                    double Sn = D * F - B[i] * S[i];
+                    double Cn = F * F - B[i] * C[i];
+
+                    S[i] = Sn;
+                    C[i] = Cn;
+                    A[i] = std::sqrt(S[i] * S[i] + C[i] * C[i]);
+                    B[i] = 1.5 * e2 * S[i] * C[i] * C[i] * ((P[i] * S[i] - Z[i] * C[i]) * A[i] - e2 * S[i] * C[i]);
+                }
+            }
+
+            for (unsigned int i = 0; i < n; i++) {
+                double p = std::sqrt(bx[i] * bx[i] + by[i] * by[i]);
+                double Cc = ec * C[i];
+
+                longitudes[first + i] = estimateLongitude(bx[i], by[i], p) * R2D;
+                latitudes[first + i] = estimateLatitude(bz[i], S[i], Cc) * R2D;
+                heights[first + i] = estimateHeight(bz[i], p, A[i], S[i], Cc);
+            }
+        }
+
+        //the center of the Earth, the poles and the equator
+        for (unsigned int i = 0; i < nbPositions; i++) {
+            if ((x[i] == 0.0 && y[i] == 0.0) || z[i] == 0.0) {
+                Eigen::Vector3d ecefPosition(x[i], y[i], z[i]);
+                Position position(0, 0, 0, 0);
+                ecefToLongitudeLatitudeElevation(ecefPosition, position);
+
+                longitudes[i] = position.getLongitude();
+                latitudes[i] = position.getLatitude();
+                heights[i] = position.getEllipsoidalHeight();
+            }
+        }
+    }
+
     double estimateLongitude(double x, double y, double p) {
         // Vermeille (2004), stable longitude calculation
         // atan(y/x) suffers when x = 0
@@ -176,6 +209,29 @@ public:
     double estimateHeight(double z, double p, double A, double S, double Cc) {
         return (p * Cc + std::abs(z) * S - b * A) / std::sqrt(Cc * Cc + S * S);
     }
+
+private:
+
+    /**Runs Halley's iterations from the starter variables of P and Z. See (Fukushima, 2006) p.691 equations (17) to (20)*/
+    void iterate(double P, double Z, double & S, double & C, double & A) {
+        S = Z;
+        C = ec*P;
+        A = std::sqrt(S * S + C * C);
+        double B = 1.5 * e2 * e2 * P * S * S * C * C * (A - ec);
+
+        for (unsigned int iteration = 0; iteration < numberOfIterations; iteration++) {
+            double D = Z * A * A * A + e2 * S * S * S;
+            double F = P * A * A * A - e2 * C * C * C;
+
+            double Sn = D * F - B * S;
+            double Cn = F * F - B * C;
+
+            S = Sn;
+            C = Cn;
+            A = std::sqrt(S * S + C * C);
+            B = 1.5 * e2 * S * C * C * ((P * S - Z * C) * A - e2 * S * C);
+        }
+    }
 };
 
 #endif /* CARTESIANTOGEODETICFUKUSHIMA_HPP */
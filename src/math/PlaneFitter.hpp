@@ -10,6 +10,9 @@
 #ifndef PLANEFITTER_HPP
 #define PLANEFITTER_HPP
 
+#include <cstdint>
+#include <cmath>
+#include <algorithm>
 #include <Eigen/Dense>
 
 class PlaneFitter {
@@ -82,5 +85,118 @@ public:
 
 };
 
+/*!
+ * \brief Moments of a point cloud, accumulated point by point, to fit a plane in constant memory
+ *
+ * Keeps the number of points, their mean and the sums of the products of their deviations from the mean, updated
+ * like Welford's variance. Partial accumulators, over parts of a cloud processed in parallel, can be merged.
+ * The fitted plane is the least squares solution of z = Ax + By + C that PlaneFitter::fitPlane finds.
+ */
+class PlaneFitAccumulator {
+public:
+
+    PlaneFitAccumulator() : count(0), mean(Eigen::Vector3d::Zero()), moments(Eigen::Matrix3d::Zero()) {
+    }
+
+    /**Adds a point*/
+    void add(double x, double y, double z) {
+        Eigen::Vector3d point(x, y, z);
+        Eigen::Vector3d delta = point - mean;
+
+        count++;
+        mean += delta / count;
+        moments += delta * (point - mean).transpose();
+    }
+
+    /**Adds the points of another accumulator*/
+    void merge(const PlaneFitAccumulator & other) {
+        if (other.count == 0) {
+            return;
+        }
+
+        uint64_t total = count + other.count;
+        Eigen::Vector3d delta = other.mean - mean;
+
+        moments += other.moments + delta * delta.transpose() * ((double) count * other.count / total);
+        mean += delta * ((double) other.count / total);
+        count = total;
+    }
+
+    /**
+     * Fits a plane to the points added
+     *
+     * @param planeGeneralFormParams the plane ax + by + cz + d = 0, with a unit normal
+     * @return false if the points do not define a plane z = Ax + By + C
+     */
+    bool fitPlane(Eigen::Vector4d & planeGeneralFormParams) const {
+        if (count < 3) {
+            return false;
+        }
+
+        //normal equations of the centered points
+        Eigen::Matrix2d xy;
+        xy << moments(0, 0), moments(0, 1), moments(1, 0), moments(1, 1);
+
+        double determinant = xy.determinant();
+
+        if (!(std::fabs(determinant) > 1e-12 * xy.squaredNorm())) {
+            return false;
+        }
+
+        Eigen::Vector2d slopes = xy.inverse() * Eigen::Vector2d(moments(0, 2), moments(1, 2));
+
+        Eigen::Vector3d zForm(slopes(0), slopes(1), mean(2) - slopes(0) * mean(0) - slopes(1) * mean(1));
+        PlaneFitter::convertPlaneZform2GeneralForm(zForm, planeGeneralFormParams);
+
+        return true;
+    }
+
+    /**
+     * Returns the mean residual of the points to a plane
+     *
+     * @param planeGeneralFormParams the plane ax + by + cz + d = 0, with a unit normal
+     */
+    double getResidualMean(const Eigen::Vector4d & planeGeneralFormParams) const {
+        return planeGeneralFormParams.head<3>().dot(mean) + planeGeneralFormParams(3);
+    }
+
+    /**
+     * Returns the standard deviation of the residuals of the points to a plane
+     *
+     * @param planeGeneralFormParams the plane ax + by + cz + d = 0, with a unit normal
+     */
+    double getResidualStandardDeviation(const Eigen::Vector4d & planeGeneralFormParams) const {
+        if (count < 2) {
+            return 0;
+        }
+
+        Eigen::Vector3d normal = planeGeneralFormParams.head<3>();
+        double variance = normal.dot(moments * normal) / (count - 1);
+
+        return std::sqrt(std::max(variance, 0.0));
+    }
+
+    /**Returns the number of points*/
+    uint64_t getCount() const {
+        return count;
+    }
+
+    /**Returns the mean of the points*/
+    const Eigen::Vector3d & getMean() const {
+        return mean;
+    }
+
+private:
+
+    /**Number of points*/
+    uint64_t count;
+
+    /**Mean of the points*/
+    Eigen::Vector3d mean;
+
+    /**Sums of the products of the deviations from the mean*/
+    Eigen::Matrix3d moments;
+};
+
 #endif /* PLANEFITTER_HPP */
 
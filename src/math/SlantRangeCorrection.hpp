@@ -2,7 +2,7 @@
 * Copyright 2019 © Centre Interdisciplinaire de développement en Cartographie des Océans (CIDCO), Tous droits réservés
 */
 
-/* 
+/*
  * @author Guillaume Labbé-Morissette
  */
 
@@ -10,38 +10,180 @@
 #define SLANTRANGECORRECTION_HPP
 
 #include <vector>
+#include <cmath>
+#include <algorithm>
+#include <cstdint>
+#include <unordered_map>
+#include <type_traits>
+
+/*!
+* \brief Slant range to ground range remap for one geometry
+*
+* Each ground range bin is gathered from the two slant range samples around it, linearly interpolated,
+* so every bin gets a value and no hole is left behind.
+*/
+class SlantRangeRemapPlan {
+public:
+
+    /**
+     * Builds the plan
+     *
+     * @param nbSamples number of slant range samples
+     * @param theta angle between the nadir and the slant, roll included (degrees)
+     */
+    SlantRangeRemapPlan(unsigned int nbSamples,double theta) : nbSamples(nbSamples) {
+        double sT = std::abs(sin(theta*(M_PI/180)));
+
+        unsigned int nbBins = (nbSamples > 0) ? ceil(nbSamples * sT) : 0;
+
+        lower.resize(nbBins);
+        upper.resize(nbBins);
+        weights.resize(nbBins);
+
+        for(unsigned int j=0;j<nbBins;j++){
+            //slant range sample position of the ground range bin
+            double position = std::min(j / sT,(double)(nbSamples-1));
+            unsigned int index = floor(position);
+
+            lower[j] = index;
+            upper[j] = std::min(index+1,nbSamples-1);
+            weights[j] = position - index;
+        }
+    }
+
+    /**
+     * Remaps the samples into ground range bins
+     *
+     * @param samples the slant range samples, as many as the plan was built for
+     * @param out receives the ground range bins
+     */
+    template<typename T>
+    void apply(const T * samples,std::vector<T> & out) const {
+        unsigned int nbBins = lower.size();
+        out.resize(nbBins);
 
+        for(unsigned int j=0;j<nbBins;j++){
+            double low = samples[lower[j]];
+            double high = samples[upper[j]];
 
+            out[j] = convert<T>(low + weights[j] * (high - low));
+        }
+    }
+
+    /**Returns the number of slant range samples the plan expects*/
+    unsigned int getNumberOfSamples() const { return nbSamples;}
+
+    /**Returns the number of ground range bins*/
+    unsigned int getNumberOfBins() const { return lower.size();}
+
+private:
+
+    /**Integer samples are rounded, floating point samples kept as is*/
+    template<typename T>
+    static typename std::enable_if<std::is_integral<T>::value,T>::type convert(double value){
+        return (T)(value + 0.5);
+    }
+
+    template<typename T>
+    static typename std::enable_if<!std::is_integral<T>::value,T>::type convert(double value){
+        return (T)value;
+    }
+
+    unsigned int nbSamples;
+
+    /**Slant range sample before each bin*/
+    std::vector<uint32_t> lower;
+
+    /**Slant range sample after each bin*/
+    std::vector<uint32_t> upper;
+
+    /**Weight of the upper sample*/
+    std::vector<float> weights;
+};
+
+/*!
+* \brief Slant range correction
+*
+* An instance caches the remap plans it builds, keyed by sample count and slant angle (roll included, bucketed),
+* so successive pings with the same geometry only pay for the gather.
+* With the flat bottom model used here, the remap does not depend on the slant range itself.
+*/
 class SlantRangeCorrection{
 public:
+
+    /**
+     * Creates a correction with an empty plan cache
+     *
+     * @param angleBucket size in degrees of the slant angle buckets sharing a plan
+     * @param maximumPlans number of plans kept before the cache is emptied
+     */
+    SlantRangeCorrection(double angleBucket = 0.1,unsigned int maximumPlans = 256) : angleBucket(angleBucket), maximumPlans(maximumPlans) {
+    }
+
+    /**
+     *
+     * @param samples the samples, sampled along the slant
+     * @param slantRange distance along the slant
+     * @param roll roll, taken as positive = starboard
+     * @param beamAngle taken from the nadir
+     */
+    template<typename T>
+    static void correct(std::vector<T> & samples,double slantRange,double roll,double beamAngle,std::vector<T> & out){
+        SlantRangeRemapPlan plan(samples.size(),beamAngle - roll);
+        plan.apply(samples.data(),out);
+    }
+
     /**
-     * 
+     * Same as correct(), with a cached plan
+     *
      * @param samples the samples, sampled along the slant
      * @param slantRange distance along the slant
      * @param roll roll, taken as positive = starboard
      * @param beamAngle taken from the nadir
      */
-    static void correct(std::vector<double> & samples,double slantRange,double roll,double beamAngle,std::vector<double> & out){
-        double theta = beamAngle - roll;
-        double sT = sin(theta*(M_PI/180));
-        
-        double groundRangePixels =  ceil(std::abs(samples.size() * sT)); //in pixels
-        
-        //reproject pixels into bins according to the slant range
-        //std::cerr << "Theta: " << theta << std::endl;
-        //std::cerr << "Slant: " <<  samples.size() << " pixels     Ground: " << groundRangePixels << "pixels" << std::endl;
-        
-        out.resize(groundRangePixels);
-        
-        for(unsigned int i=0;i<samples.size();i++){
-            int pixelIndex = floor(std::abs(sT * i)); 
-
-            //std::cerr << "Index: " << i << "       New index: " << pixelIndex << std::endl;
-            out[pixelIndex]=samples[i];
+    template<typename T>
+    void apply(std::vector<T> & samples,double slantRange,double roll,double beamAngle,std::vector<T> & out){
+        getPlan(samples.size(),slantRange,roll,beamAngle).apply(samples.data(),out);
+    }
+
+    /**
+     * Returns the plan for a geometry, building it if it is not cached
+     *
+     * @param nbSamples number of slant range samples
+     * @param slantRange distance along the slant
+     * @param roll roll, taken as positive = starboard
+     * @param beamAngle taken from the nadir
+     */
+    const SlantRangeRemapPlan & getPlan(unsigned int nbSamples,double slantRange,double roll,double beamAngle){
+        int32_t bucket = (int32_t) floor((beamAngle - roll) / angleBucket + 0.5);
+        uint64_t key = ((uint64_t)nbSamples << 32) | (uint32_t) bucket;
+
+        auto i = plans.find(key);
+
+        if(i != plans.end()){
+            return i->second;
+        }
+
+        if(plans.size() >= maximumPlans){
+            plans.clear();
         }
+
+        return plans.insert(std::make_pair(key,SlantRangeRemapPlan(nbSamples,bucket * angleBucket))).first->second;
     }
-    
+
+    /**Returns the number of cached plans*/
+    unsigned int getNumberOfPlans(){ return plans.size();}
+
+private:
+
+    /**Size in degrees of the slant angle buckets*/
+    double angleBucket;
+
+    /**Number of plans kept*/
+    unsigned int maximumPlans;
+
+    /**Cached plans, by sample count and angle bucket*/
+    std::unordered_map<uint64_t,SlantRangeRemapPlan> plans;
 };
 
 #endif /* SLANTRANGECORRECTION_HPP */
-
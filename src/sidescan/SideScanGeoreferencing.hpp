@@ -12,9 +12,56 @@
 #ifndef SIDESCANGEOREFERENCING_HPP
 #define SIDESCANGEOREFERENCING_HPP
 
+#include <vector>
+#include <cmath>
 #include <Eigen/Dense>
 #include "../Position.hpp"
 #include "../math/CoordinateTransform.hpp"
+#include "../math/CartesianToGeodeticFukushima.hpp"
+#include "../utils/Constants.hpp"
+
+/*!
+* \brief Positions of the samples of one sidescan ping, port samples first then starboard samples
+*
+* Coordinates are kept in separate arrays, reused from one ping to the next.
+*/
+class SideScanSamplePositions {
+public:
+
+    /**Returns the number of positions*/
+    unsigned int size() {
+        return x.size();
+    }
+
+    /**Returns true if the geodetic coordinates were computed*/
+    bool hasGeodetic() {
+        return latitudes.size() == x.size();
+    }
+
+    /**Number of port samples, at the start of the arrays. Port sample i is at index i*/
+    unsigned int nbPortSamples = 0;
+
+    /**Number of starboard samples. Starboard sample i is at index nbPortSamples + i*/
+    unsigned int nbStarboardSamples = 0;
+
+    /**ECEF x coordinates*/
+    std::vector<double> x;
+
+    /**ECEF y coordinates*/
+    std::vector<double> y;
+
+    /**ECEF z coordinates*/
+    std::vector<double> z;
+
+    /**Latitudes (degrees), empty unless requested*/
+    std::vector<double> latitudes;
+
+    /**Longitudes (degrees), empty unless requested*/
+    std::vector<double> longitudes;
+
+    /**Ellipsoidal heights, empty unless requested*/
+    std::vector<double> heights;
+};
 
 class SideScanGeoreferencing {
 public:
@@ -35,6 +82,85 @@ public:
 
         CoordinateTransform::convertECEFToLongitudeLatitudeElevation(objectPositionEcef, georeferencedPosition);
     }
+
+    /**
+     * Georeferences every sample of a ping in one call. Sample i of a channel lies i * distancePerSample
+     * across track from the tow point, which trails the antenna by the layback
+     *
+     * @param antennaPosition the antenna position
+     * @param antenna2TowPointLeverArmEcef the lever arm from the antenna to the tow point, in ECEF
+     * @param layback distance from the tow point back to the towfish, in meters along the heading
+     * @param heading heading in degrees
+     * @param distancePerSample ground distance between samples, in meters
+     * @param nbPortSamples number of port samples
+     * @param nbStarboardSamples number of starboard samples
+     * @param positions receives the ECEF positions of the samples
+     * @param geodetic also compute latitudes, longitudes and heights
+     */
+    static void georeferenceSideScanPing(
+            Position & antennaPosition,
+            Eigen::Vector3d & antenna2TowPointLeverArmEcef,
+            double layback,
+            double heading,
+            double distancePerSample,
+            unsigned int nbPortSamples,
+            unsigned int nbStarboardSamples,
+            SideScanSamplePositions & positions,
+            bool geodetic = false
+            ) {
+
+        Eigen::Vector3d antennaEcef;
+        CoordinateTransform::getPositionECEF(antennaEcef, antennaPosition);
+
+        Eigen::Matrix3d ned2ecef;
+        CoordinateTransform::ned2ecef(ned2ecef, antennaPosition);
+
+        double ch = std::cos(heading * D2R);
+        double sh = std::sin(heading * D2R);
+
+        Eigen::Vector3d layBackEcef = ned2ecef * Eigen::Vector3d(-layback * ch, -layback * sh, 0);
+        Eigen::Vector3d towfishEcef = antennaEcef + antenna2TowPointLeverArmEcef + layBackEcef;
+
+        //starboard is 90 degrees clockwise from the heading
+        Eigen::Vector3d starboardStepEcef = ned2ecef * Eigen::Vector3d(-sh * distancePerSample, ch * distancePerSample, 0);
+
+        unsigned int nbSamples = nbPortSamples + nbStarboardSamples;
+
+        positions.nbPortSamples = nbPortSamples;
+        positions.nbStarboardSamples = nbStarboardSamples;
+        positions.x.resize(nbSamples);
+        positions.y.resize(nbSamples);
+        positions.z.resize(nbSamples);
+
+        //the samples of a channel lie on a straight line in ECEF
+        for (unsigned int i = 0; i < nbPortSamples; i++) {
+            positions.x[i] = towfishEcef(0) - i * starboardStepEcef(0);
+            positions.y[i] = towfishEcef(1) - i * starboardStepEcef(1);
+            positions.z[i] = towfishEcef(2) - i * starboardStepEcef(2);
+        }
+
+        for (unsigned int i = 0; i < nbStarboardSamples; i++) {
+            positions.x[nbPortSamples + i] = towfishEcef(0) + i * starboardStepEcef(0);
+            positions.y[nbPortSamples + i] = towfishEcef(1) + i * starboardStepEcef(1);
+            positions.z[nbPortSamples + i] = towfishEcef(2) + i * starboardStepEcef(2);
+        }
+
+        if (geodetic) {
+            positions.latitudes.resize(nbSamples);
+            positions.longitudes.resize(nbSamples);
+            positions.heights.resize(nbSamples);
+
+            CartesianToGeodeticFukushima cart2geo(2);
+            cart2geo.ecefToLongitudeLatitudeElevation(
+                    positions.x.data(), positions.y.data(), positions.z.data(), nbSamples,
+                    positions.longitudes.data(), positions.latitudes.data(), positions.heights.data());
+        }
+        else {
+            positions.latitudes.clear();
+            positions.longitudes.clear();
+            positions.heights.clear();
+        }
+    }
 };
 
 #endif /* SIDESCANGEOREFERENCING_HPP */
@@ -0,0 +1,289 @@
+/*
+* Copyright 2020 © Centre Interdisciplinaire de développement en Cartographie des Océans (CIDCO), Tous droits réservés
+*/
+
+#ifndef SIDESCANMOSAIC_HPP
+#define SIDESCANMOSAIC_HPP
+
+#include <cstdint>
+#include <vector>
+#include <unordered_map>
+#include <ostream>
+#include <Eigen/Dense>
+#include "../Position.hpp"
+#include "../gridding/TiledGridFrame.hpp"
+
+/**How a cell combines the samples that fall into it*/
+enum MosaicBlending { BLEND_LAST, BLEND_MAX, BLEND_AVERAGE };
+
+/*!
+* \brief Tiled sidescan mosaic raster
+*
+* Cells are square, in a local geodetic frame (north, east) centered on an origin set once, usually the first ping.
+* Tiles of TILE_SIZE x TILE_SIZE cells are only created where samples land, so memory follows coverage.
+*
+* Tiles are spread over NB_SHARDS independent maps. Cells of different shards can be written concurrently,
+* which is how SidescanMosaicker accumulates in parallel without locks.
+*/
+class SidescanMosaic {
+public:
+
+    /**Number of cells on each side of a tile*/
+    static const int TILE_SIZE = 256;
+
+    /**Number of independent tile maps*/
+    static const unsigned int NB_SHARDS = 64;
+
+    /**Local frame and cell indexing of the mosaic*/
+    typedef TiledGridFrame<TILE_SIZE> Frame;
+
+    /**A block of TILE_SIZE x TILE_SIZE cells*/
+    class Tile {
+    public:
+        Tile(int32_t column, int32_t row) : column(column), row(row), values(TILE_SIZE * TILE_SIZE, 0), counts(TILE_SIZE * TILE_SIZE, 0) {
+        }
+
+        /**Tile column, in tiles east of the origin*/
+        int32_t column;
+
+        /**Tile row, in tiles north of the origin*/
+        int32_t row;
+
+        /**Cell values, row-major from the south-west corner*/
+        std::vector<float> values;
+
+        /**Number of samples blended in each cell*/
+        std::vector<uint32_t> counts;
+    };
+
+    /**
+    * Creates an empty mosaic
+    *
+    * @param cellSize size of a cell in meters
+    * @param blending how samples landing in the same cell are combined
+    */
+    SidescanMosaic(double cellSize, MosaicBlending blending = BLEND_AVERAGE) : frame(cellSize), blending(blending), shards(NB_SHARDS) {
+    }
+
+    /**Destroys the mosaic and its tiles*/
+    ~SidescanMosaic() {
+        for (auto shard = shards.begin(); shard != shards.end(); shard++) {
+            for (auto i = shard->begin(); i != shard->end(); i++) {
+                delete i->second;
+            }
+        }
+    }
+
+    /**
+    * Sets the origin of the local frame. Must be done before any sample is added
+    *
+    * @param origin the origin position
+    */
+    void setOrigin(Position & origin) {
+        frame.setOrigin(origin);
+    }
+
+    /**Returns true once the origin is set*/
+    bool hasOrigin() {
+        return frame.hasOrigin();
+    }
+
+    /**
+    * Converts an ECEF position into the local frame of the mosaic
+    *
+    * @param ecef the ECEF position
+    * @param local receives north, east, down in meters
+    */
+    void toLocal(Eigen::Vector3d & ecef, Eigen::Vector3d & local) {
+        frame.toLocal(ecef, local);
+    }
+
+    /**
+    * Converts a local (north, east) position into a geographic position
+    *
+    * @param north meters north of the origin
+    * @param east meters east of the origin
+    * @param position receives the geographic position
+    */
+    void toGeographic(double north, double east, Position & position) {
+        frame.toGeographic(north, east, position);
+    }
+
+    /**
+    * Adds a sample at a local position
+    *
+    * @param north meters north of the origin
+    * @param east meters east of the origin
+    * @param value sample value
+    */
+    void add(double north, double east, float value) {
+        addToCell(getCellColumn(east), getCellRow(north), value);
+    }
+
+    /**
+    * Blends a value into a cell. Only one thread at a time may write to a given shard (see getShard())
+    *
+    * @param cellColumn cell column, east of the origin
+    * @param cellRow cell row, north of the origin
+    * @param value sample value
+    */
+    void addToCell(int32_t cellColumn, int32_t cellRow, float value) {
+        Tile * tile = getTile(Frame::getTileIndex(cellColumn), Frame::getTileIndex(cellRow), true);
+        unsigned int index = Frame::getCellOffset(tile->column, tile->row, cellColumn, cellRow);
+
+        float & cell = tile->values[index];
+        uint32_t & count = tile->counts[index];
+
+        count++;
+
+        switch (blending) {
+            case BLEND_LAST:
+                cell = value;
+                break;
+
+            case BLEND_MAX:
+                if (count == 1 || value > cell) {
+                    cell = value;
+                }
+                break;
+
+            case BLEND_AVERAGE:
+                cell += (value - cell) / count;
+                break;
+        }
+    }
+
+    /**
+    * Returns the value of the cell containing a local position
+    *
+    * @param north meters north of the origin
+    * @param east meters east of the origin
+    * @param value receives the value
+    * @return false if no sample landed in the cell
+    */
+    bool getValue(double north, double east, double & value) {
+        int32_t cellColumn = getCellColumn(east);
+        int32_t cellRow = getCellRow(north);
+
+        Tile * tile = getTile(Frame::getTileIndex(cellColumn), Frame::getTileIndex(cellRow), false);
+
+        if (!tile) {
+            return false;
+        }
+
+        unsigned int index = Frame::getCellOffset(tile->column, tile->row, cellColumn, cellRow);
+
+        if (tile->counts[index] == 0) {
+            return false;
+        }
+
+        value = tile->values[index];
+        return true;
+    }
+
+    /**Returns the cell column of an easting*/
+    int32_t getCellColumn(double east) {
+        return frame.getCellColumn(east);
+    }
+
+    /**Returns the cell row of a northing*/
+    int32_t getCellRow(double north) {
+        return frame.getCellRow(north);
+    }
+
+    /**Returns the shard holding a cell*/
+    static unsigned int getShard(int32_t cellColumn, int32_t cellRow) {
+        uint32_t hash = (uint32_t) Frame::getTileIndex(cellColumn) * 73856093u ^ (uint32_t) Frame::getTileIndex(cellRow) * 19349663u;
+        return hash % NB_SHARDS;
+    }
+
+    /**Returns the tiles of a shard*/
+    std::unordered_map<uint64_t, Tile*> & getShardTiles(unsigned int shard) {
+        return shards[shard];
+    }
+
+    /**Returns the number of tiles*/
+    unsigned int getNumberOfTiles() {
+        unsigned int total = 0;
+
+        for (auto shard = shards.begin(); shard != shards.end(); shard++) {
+            total += shard->size();
+        }
+
+        return total;
+    }
+
+    /**Returns the size of a cell in meters*/
+    double getCellSize() {
+        return frame.getCellSize();
+    }
+
+    /**Returns the blending mode*/
+    MosaicBlending getBlending() {
+        return blending;
+    }
+
+    /**
+    * Writes every cell holding data as "longitude latitude value" lines
+    *
+    * @param out the output stream
+    */
+    void writeXyz(std::ostream & out) {
+        Position position(0, 0, 0, 0);
+
+        for (auto shard = shards.begin(); shard != shards.end(); shard++) {
+            for (auto i = shard->begin(); i != shard->end(); i++) {
+                Tile * tile = i->second;
+
+                for (int row = 0; row < TILE_SIZE; row++) {
+                    for (int column = 0; column < TILE_SIZE; column++) {
+                        unsigned int index = row * TILE_SIZE + column;
+
+                        if (tile->counts[index] > 0) {
+                            frame.cellToGeographic(tile->column * TILE_SIZE + column, tile->row * TILE_SIZE + row, position);
+
+                            out << std::fixed;
+                            out.precision(9);
+                            out << position.getLongitude() << " " << position.getLatitude() << " ";
+                            out.precision(3);
+                            out << tile->values[index] << std::endl;
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+private:
+
+    /**Returns a tile, creating it if asked to*/
+    Tile * getTile(int32_t column, int32_t row, bool create) {
+        uint64_t key = Frame::getTileKey(column, row);
+        std::unordered_map<uint64_t, Tile*> & shard = shards[getShard(column * TILE_SIZE, row * TILE_SIZE)];
+
+        auto i = shard.find(key);
+
+        if (i != shard.end()) {
+            return i->second;
+        }
+
+        if (!create) {
+            return NULL;
+        }
+
+        Tile * tile = new Tile(column, row);
+        shard[key] = tile;
+        return tile;
+    }
+
+    /**Local frame and cell size*/
+    Frame frame;
+
+    /**How samples are combined*/
+    MosaicBlending blending;
+
+    /**Tiles, by shard then by key*/
+    std::vector<std::unordered_map<uint64_t, Tile*> > shards;
+};
+
+#endif /* SIDESCANMOSAIC_HPP */
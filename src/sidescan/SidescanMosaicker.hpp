@@ -0,0 +1,303 @@
+/*
+* Copyright 2020 © Centre Interdisciplinaire de développement en Cartographie des Océans (CIDCO), Tous droits réservés
+*/
+
+#ifndef SIDESCANMOSAICKER_HPP
+#define SIDESCANMOSAICKER_HPP
+
+#include <cstdint>
+#include <cmath>
+#include <vector>
+#include <mutex>
+#include <algorithm>
+#include <Eigen/Dense>
+#include "../datagrams/DatagramEventHandler.hpp"
+#include "../math/CoordinateTransform.hpp"
+#include "../utils/Constants.hpp"
+#include "SidescanPing.hpp"
+#include "SidescanMosaic.hpp"
+#include "SideScanGeoreferencing.hpp"
+#include "../utils/WorkerPool.hpp"
+
+/*!
+* \brief Builds a sidescan mosaic from a stream of pings
+*
+* Pings are queued until a batch is full, then the batch is mosaicked in two parallel passes:
+* the pings are split between the threads, which georeference every sample, then each thread blends
+* the samples of the mosaic shards it owns. The threads are kept from one batch to the next.
+* Pings are released after their batch, so a whole survey goes through in one pass with only one batch in memory.
+*
+* Channel 0 is taken as port and channel 1 as starboard, other channels are ignored. Sample i lies
+* i * distancePerSample away from the towfish, which trails the antenna by the layback. The heading is
+* taken from the ping attitude when there is one, otherwise from the course made good.
+* Missing samples are NaN, and are not mosaicked.
+*
+* Call flush() once parsing is done to mosaic the last batch.
+*/
+class SidescanMosaicker : public DatagramEventHandler {
+public:
+
+    /**
+    * Creates a mosaicker
+    *
+    * @param mosaic the mosaic receiving the samples
+    * @param nbThreads number of threads, 0 to use every core
+    * @param batchSize number of pings mosaicked at once
+    */
+    SidescanMosaicker(SidescanMosaic & mosaic, unsigned int nbThreads = 0, unsigned int batchSize = 512)
+    : mosaic(mosaic), pool(nbThreads), nbThreads(pool.getNumberOfThreads()), batchSize(batchSize), heading(0), headingKnown(false), nbPings(0), nbSamples(0) {
+        if (this->batchSize == 0) {
+            this->batchSize = 1;
+        }
+
+        buckets.resize(this->nbThreads, std::vector<std::vector<CellSample> >(SidescanMosaic::NB_SHARDS));
+    }
+
+    /**Destroys the mosaicker. Pings that were not flushed are dropped*/
+    ~SidescanMosaicker() {
+        releasePings();
+    }
+
+    /**
+    * Queues a ping, mosaicking the batch once it is full
+    *
+    * @param ping the sidescan ping
+    */
+    void processSidescanData(SidescanPing * ping) {
+        if (ping->getPosition() == NULL || ping->getChannelNumber() < 0 || ping->getChannelNumber() > 1) {
+            if (!arena) delete ping;
+            return;
+        }
+
+        if (!mosaic.hasOrigin()) {
+            mosaic.setOrigin(*ping->getPosition());
+        }
+
+        Batched batched;
+        batched.ping = ping;
+        batched.heading = 0;
+        batch.push_back(batched);
+
+        if (batch.size() >= batchSize) {
+            flush();
+        }
+    }
+
+    /**Mosaics the queued pings*/
+    void flush() {
+        if (batch.empty()) {
+            return;
+        }
+
+        computeHeadings();
+
+        //Georeference the samples, each thread taking a contiguous range of pings
+        unsigned int nbWorkers = (batch.size() < nbThreads) ? batch.size() : nbThreads;
+        unsigned int pingsPerWorker = (batch.size() + nbWorkers - 1) / nbWorkers;
+
+        pool.run(nbWorkers, [this, pingsPerWorker](unsigned int worker) {
+            unsigned int first = worker * pingsPerWorker;
+            unsigned int last = std::min<unsigned int>(first + pingsPerWorker, batch.size());
+
+            georeferencePings(worker, first, last);
+        });
+
+        //Blend the samples, each thread owning a set of shards. Workers are visited in ping order, so BLEND_LAST keeps the latest ping
+        pool.run(nbThreads, [this, nbWorkers](unsigned int owner) {
+            for (unsigned int shard = owner; shard < SidescanMosaic::NB_SHARDS; shard += nbThreads) {
+                for (unsigned int worker = 0; worker < nbWorkers; worker++) {
+                    std::vector<CellSample> & samples = buckets[worker][shard];
+
+                    for (auto i = samples.begin(); i != samples.end(); i++) {
+                        mosaic.addToCell(i->column, i->row, i->value);
+                    }
+
+                    samples.clear();
+                }
+            }
+        });
+
+        nbPings += batch.size();
+        releasePings();
+    }
+
+    /**Returns the number of pings mosaicked*/
+    uint64_t getNumberOfPings() {
+        return nbPings;
+    }
+
+    /**Returns the number of samples mosaicked*/
+    uint64_t getNumberOfSamples() {
+        return nbSamples;
+    }
+
+private:
+
+    /**A ping waiting in the batch*/
+    typedef struct {
+        SidescanPing * ping;
+        double heading;
+    } Batched;
+
+    /**A georeferenced sample, bound to a cell*/
+    typedef struct {
+        int32_t column;
+        int32_t row;
+        float value;
+    } CellSample;
+
+    /**Assigns a heading to every ping of the batch, in order*/
+    void computeHeadings() {
+        unsigned int firstKnown = batch.size();
+
+        for (unsigned int i = 0; i < batch.size(); i++) {
+            SidescanPing * ping = batch[i].ping;
+
+            if (ping->getAttitude()) {
+                heading = ping->getAttitude()->getHeading() * D2R;
+                headingKnown = true;
+            }
+            else {
+                //course made good, once we moved far enough from the last fix used
+                Eigen::Vector3d ecef;
+                Eigen::Vector3d local;
+                CoordinateTransform::getPositionECEF(ecef, *ping->getPosition());
+                mosaic.toLocal(ecef, local);
+
+                if (!trackStarted) {
+                    trackReference = local;
+                    trackStarted = true;
+                }
+                else {
+                    double north = local(0) - trackReference(0);
+                    double east = local(1) - trackReference(1);
+
+                    if (north * north + east * east > MINIMUM_COURSE_DISTANCE * MINIMUM_COURSE_DISTANCE) {
+                        heading = std::atan2(east, north);
+                        headingKnown = true;
+                        trackReference = local;
+                    }
+                }
+            }
+
+            batch[i].heading = heading;
+
+            if (headingKnown && firstKnown == batch.size()) {
+                firstKnown = i;
+            }
+        }
+
+        //pings before the first known heading get that heading
+        for (unsigned int i = 0; i < firstKnown && firstKnown < batch.size(); i++) {
+            batch[i].heading = batch[firstKnown].heading;
+        }
+    }
+
+    /**Georeferences the samples of a range of pings into the buckets of a worker*/
+    void georeferencePings(unsigned int worker, unsigned int first, unsigned int last) {
+        std::vector<std::vector<CellSample> > & shards = buckets[worker];
+        uint64_t count = 0;
+
+        SideScanSamplePositions positions;
+        Eigen::Vector3d noLeverArm(0, 0, 0);
+        Eigen::Vector3d local;
+
+        double cellSize = mosaic.getCellSize();
+
+        for (unsigned int p = first; p < last; p++) {
+            SidescanPing * ping = batch[p].ping;
+            unsigned int nbSamples = ping->getNumberOfSamples();
+            bool port = (ping->getChannelNumber() == 0);
+
+            SideScanGeoreferencing::georeferenceSideScanPing(
+                    *ping->getPosition(),
+                    noLeverArm,
+                    ping->getLayback(),
+                    batch[p].heading * R2D,
+                    ping->getDistancePerSample(),
+                    port ? nbSamples : 0,
+                    port ? 0 : nbSamples,
+                    positions);
+
+            for (unsigned int i = 0; i < nbSamples; i++) {
+                double value = ping->getSample(i);
+
+                if (std::isnan(value)) {
+                    continue;
+                }
+
+                Eigen::Vector3d ecef(positions.x[i], positions.y[i], positions.z[i]);
+                mosaic.toLocal(ecef, local);
+
+                CellSample sample;
+                sample.column = (int32_t) std::floor(local(1) / cellSize);
+                sample.row = (int32_t) std::floor(local(0) / cellSize);
+                sample.value = (float) value;
+
+                shards[SidescanMosaic::getShard(sample.column, sample.row)].push_back(sample);
+                count++;
+            }
+        }
+
+        std::lock_guard<std::mutex> lock(countMutex);
+        nbSamples += count;
+    }
+
+    /**Deletes the pings of the batch, or recycles the arena they were carved from*/
+    void releasePings() {
+        if (arena) {
+            arena->reset();
+        }
+        else {
+            for (auto i = batch.begin(); i != batch.end(); i++) {
+                delete i->ping;
+            }
+        }
+
+        batch.clear();
+    }
+
+    /**Distance in meters the antenna must travel before the course made good is updated*/
+    static constexpr double MINIMUM_COURSE_DISTANCE = 1.0;
+
+    /**The mosaic being built*/
+    SidescanMosaic & mosaic;
+
+    /**The threads mosaicking the batches*/
+    WorkerPool pool;
+
+    /**Number of threads*/
+    unsigned int nbThreads;
+
+    /**Number of pings per batch*/
+    unsigned int batchSize;
+
+    /**Pings waiting to be mosaicked*/
+    std::vector<Batched> batch;
+
+    /**Georeferenced samples, by worker then by mosaic shard. Kept between batches to reuse their memory*/
+    std::vector<std::vector<std::vector<CellSample> > > buckets;
+
+    /**Last heading (radians)*/
+    double heading;
+
+    /**True once a heading was found*/
+    bool headingKnown;
+
+    /**True once the course made good has a starting point*/
+    bool trackStarted = false;
+
+    /**Local position where the course made good was last updated*/
+    Eigen::Vector3d trackReference;
+
+    /**Number of pings mosaicked*/
+    uint64_t nbPings;
+
+    /**Number of samples mosaicked*/
+    uint64_t nbSamples;
+
+    /**Guards nbSamples*/
+    std::mutex countMutex;
+};
+
+#endif /* SIDESCANMOSAICKER_HPP */
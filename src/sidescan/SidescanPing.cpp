@@ -10,14 +10,16 @@
 
 #include "SidescanPing.hpp"
 
-SidescanPing::SidescanPing() : attitude(NULL), position(NULL) {
+SidescanPing::SidescanPing() : sampleType(SAMPLE_DOUBLE), attitude(NULL), position(NULL), ownsAttitudeAndPosition(true) {
 }
 
-SidescanPing::SidescanPing(const SidescanPing& orig) {
+SidescanPing::SidescanPing(const SidescanPing& orig) : sampleType(SAMPLE_DOUBLE), attitude(NULL), position(NULL), ownsAttitudeAndPosition(true) {
 }
 
 SidescanPing::~SidescanPing() {
-    if(attitude) delete attitude;
-    if(position) delete position;
+    if(ownsAttitudeAndPosition){
+        if(attitude) delete attitude;
+        if(position) delete position;
+    }
 }
 
@@ -14,9 +14,12 @@
 
 #include <vector>
 #include <cstdint>
+#include <stdexcept>
 #include "../Position.hpp"
 #include "../Attitude.hpp"
 
+/**Type in which the samples of a ping are stored*/
+enum SampleType { SAMPLE_DOUBLE, SAMPLE_FLOAT, SAMPLE_UINT8, SAMPLE_UINT16, SAMPLE_UINT32 };
 
 class SidescanPing {
 public:
@@ -28,10 +31,105 @@ public:
     double getDistancePerSample(){ return distancePerSample;};
     
     
-    std::vector<double> & getSamples(){ return samples;};
+    /**
+     * Returns the samples as doubles. Samples kept in a narrower type are widened to double for good, which gives up
+     * their memory savings: prefer copySamples() or getSample() to read them
+     */
+    std::vector<double> & getSamples(){
+        if(sampleType != SAMPLE_DOUBLE){
+            std::vector<double> widened;
+            copySamples(widened);
+            setSamples(std::move(widened));
+        }
+        
+        return samples;
+    };
     
-    void setSamples(std::vector<double> & s){
-        samples = s;
+    /**
+     * Copies the samples, widened to double whatever their storage type
+     * 
+     * @param destination receives the samples
+     */
+    void copySamples(std::vector<double> & destination) const {
+        destination.resize(getNumberOfSamples());
+
+        for(unsigned int i=0;i<destination.size();i++){
+            destination[i] = getSample(i);
+        }
+    }
+    
+    /**
+     * Copies the samples. They are kept in the element type of the vector
+     */
+    template<typename T>
+    void setSamples(const std::vector<T> & s){
+        allocateSamples<T>(0) = s;
+    }
+    
+    /**
+     * Takes the content of a sample vector without copying it. They are kept in the element type of the vector
+     */
+    template<typename T>
+    void setSamples(std::vector<T> && s){
+        allocateSamples<T>(0) = std::move(s);
+    }
+    
+    /**
+     * Clears the samples and switches their storage to type T
+     * 
+     * @param nbSamples number of samples to make room for
+     * @return the sample vector, to be filled by the caller
+     */
+    template<typename T>
+    std::vector<T> & allocateSamples(unsigned int nbSamples){
+        clearSamples();
+        sampleType = typeOf((T*)NULL);
+        
+        std::vector<T> & storage = storageOf((T*)NULL);
+        storage.resize(nbSamples);
+        return storage;
+    }
+    
+    /**
+     * Returns the samples in their storage type
+     */
+    template<typename T>
+    std::vector<T> & getTypedSamples(){
+        if(typeOf((T*)NULL) != sampleType){
+            throw std::invalid_argument("Samples are not stored in the requested type");
+        }
+        
+        return storageOf((T*)NULL);
+    }
+    
+    SampleType getSampleType() const { return sampleType;};
+    
+    unsigned int getNumberOfSamples() const {
+        switch(sampleType){
+            case SAMPLE_FLOAT:  return floatSamples.size();
+            case SAMPLE_UINT8:  return uint8Samples.size();
+            case SAMPLE_UINT16: return uint16Samples.size();
+            case SAMPLE_UINT32: return uint32Samples.size();
+            default:            return samples.size();
+        }
+    }
+    
+    double getSample(unsigned int i) const {
+        switch(sampleType){
+            case SAMPLE_FLOAT:  return floatSamples[i];
+            case SAMPLE_UINT8:  return uint8Samples[i];
+            case SAMPLE_UINT16: return uint16Samples[i];
+            case SAMPLE_UINT32: return uint32Samples[i];
+            default:            return samples[i];
+        }
+    }
+    
+    /**
+     * Returns the memory held by the samples, in bytes
+     */
+    size_t getSamplesMemory(){
+        return samples.capacity() * sizeof(double) + floatSamples.capacity() * sizeof(float)
+             + uint8Samples.capacity() + uint16Samples.capacity() * sizeof(uint16_t) + uint32Samples.capacity() * sizeof(uint32_t);
     }
     
     int getChannelNumber(){ return channelNumber;};
@@ -52,8 +150,39 @@ public:
     double getSensorDepth(){return sensorDepth;}
     void setSensorDepth(double sensorDepth){this->sensorDepth = sensorDepth;}
     
+    /**
+     * Sets whether the attitude and position are deleted along with the ping. They are not when they belong to an Arena
+     */
+    void setOwnsAttitudeAndPosition(bool owns){ ownsAttitudeAndPosition = owns;}
+    
 private:
-    std::vector<double> samples; //we will boil down all the types to double. This is not a pretty hack, but we need to support every sample type
+    void clearSamples(){
+        std::vector<double>().swap(samples);
+        std::vector<float>().swap(floatSamples);
+        std::vector<uint8_t>().swap(uint8Samples);
+        std::vector<uint16_t>().swap(uint16Samples);
+        std::vector<uint32_t>().swap(uint32Samples);
+    }
+    
+    static SampleType typeOf(double *){ return SAMPLE_DOUBLE;}
+    static SampleType typeOf(float *){ return SAMPLE_FLOAT;}
+    static SampleType typeOf(uint8_t *){ return SAMPLE_UINT8;}
+    static SampleType typeOf(uint16_t *){ return SAMPLE_UINT16;}
+    static SampleType typeOf(uint32_t *){ return SAMPLE_UINT32;}
+    
+    std::vector<double> &   storageOf(double *){ return samples;}
+    std::vector<float> &    storageOf(float *){ return floatSamples;}
+    std::vector<uint8_t> &  storageOf(uint8_t *){ return uint8Samples;}
+    std::vector<uint16_t> & storageOf(uint16_t *){ return uint16Samples;}
+    std::vector<uint32_t> & storageOf(uint32_t *){ return uint32Samples;}
+    
+    //samples are kept in the type they were given, only the vector matching sampleType is used
+    SampleType  sampleType;
+    std::vector<double>   samples;
+    std::vector<float>    floatSamples;
+    std::vector<uint8_t>  uint8Samples;
+    std::vector<uint16_t> uint16Samples;
+    std::vector<uint32_t> uint32Samples;
     double      distancePerSample;
     int         channelNumber;
     uint64_t    timestamp;
@@ -61,6 +190,7 @@ private:
     Position *  position;
     double      layback;
     double      sensorDepth;
+    bool        ownsAttitudeAndPosition;
 };
 
 #endif /* SIDESCANPING_HPP */
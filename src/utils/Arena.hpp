@@ -0,0 +1,195 @@
+/*
+* Copyright 2020 © Centre Interdisciplinaire de développement en Cartographie des Océans (CIDCO), Tous droits réservés
+*/
+
+#ifndef ARENA_HPP
+#define ARENA_HPP
+
+#include <cstdlib>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <new>
+#include <utility>
+#include "Exception.hpp"
+
+/*!
+* \brief Slab-based arena allocator
+*
+* Objects are carved sequentially from large slabs and are all released at once by reset().
+* Slabs are kept after a reset, so a steady stream of datagrams reuses the same memory instead of going back to the heap.
+*
+* Objects built with create() get their destructor called by reset() (in reverse order of creation).
+* Raw memory from allocate() is simply rewound.
+*
+* An arena is not thread-safe.
+*/
+class Arena {
+public:
+
+    /**
+    * Creates an arena
+    *
+    * @param slabSize size in bytes of each slab. Allocations larger than this get their own slab
+    */
+    Arena(size_t slabSize = 1 << 20) : slabSize(slabSize), currentSlab(0) {
+    }
+
+    /**Destroys the arena, calling the destructors of its objects and freeing its slabs*/
+    ~Arena() {
+        release();
+    }
+
+    /**
+    * Returns a block of raw memory that stays valid until the next reset() or release()
+    *
+    * @param size number of bytes
+    * @param alignment required alignment, must be a power of two
+    */
+    void * allocate(size_t size, size_t alignment = alignof(std::max_align_t)) {
+        while (currentSlab < slabs.size()) {
+            Slab & slab = slabs[currentSlab];
+
+            uintptr_t base = (uintptr_t) slab.data;
+            uintptr_t aligned = (base + slab.used + alignment - 1) & ~(uintptr_t) (alignment - 1);
+            size_t end = (aligned - base) + size;
+
+            if (end <= slab.size) {
+                slab.used = end;
+                return (void*) aligned;
+            }
+
+            currentSlab++;
+        }
+
+        //No room left in the existing slabs, grab a new one
+        size_t newSlabSize = (size + alignment > slabSize) ? size + alignment : slabSize;
+
+        Slab slab;
+        slab.data = (unsigned char*) malloc(newSlabSize);
+        slab.size = newSlabSize;
+        slab.used = 0;
+
+        if (slab.data == NULL) {
+            throw new Exception("Arena: out of memory");
+        }
+
+        slabs.push_back(slab);
+        currentSlab = slabs.size() - 1;
+
+        return allocate(size, alignment);
+    }
+
+    /**
+    * Builds an object inside the arena. The arena owns it: never delete it, it will be destroyed on reset()
+    *
+    * @param args the arguments passed to the constructor of T
+    */
+    template<typename T, typename... Args>
+    T * create(Args&&... args) {
+        void * memory = allocate(sizeof (T), alignof(T));
+        T * object = new (memory) T(std::forward<Args>(args)...);
+
+        Finalizer finalizer;
+        finalizer.destroy = &Arena::destroy<T>;
+        finalizer.object = object;
+        finalizers.push_back(finalizer);
+
+        return object;
+    }
+
+    /**
+    * Destroys all objects and rewinds the slabs. Memory is kept for reuse
+    */
+    void reset() {
+        for (auto i = finalizers.rbegin(); i != finalizers.rend(); i++) {
+            i->destroy(i->object);
+        }
+
+        finalizers.clear();
+
+        for (auto i = slabs.begin(); i != slabs.end(); i++) {
+            i->used = 0;
+        }
+
+        currentSlab = 0;
+    }
+
+    /**
+    * Destroys all objects and gives the slabs back to the heap
+    */
+    void release() {
+        reset();
+
+        for (auto i = slabs.begin(); i != slabs.end(); i++) {
+            free(i->data);
+        }
+
+        slabs.clear();
+    }
+
+    /**Returns the number of bytes currently handed out, alignment padding included*/
+    size_t getBytesUsed() {
+        size_t total = 0;
+
+        for (auto i = slabs.begin(); i != slabs.end(); i++) {
+            total += i->used;
+        }
+
+        return total;
+    }
+
+    /**Returns the number of bytes reserved from the heap*/
+    size_t getCapacity() {
+        size_t total = 0;
+
+        for (auto i = slabs.begin(); i != slabs.end(); i++) {
+            total += i->size;
+        }
+
+        return total;
+    }
+
+    /**Returns the number of slabs reserved from the heap*/
+    size_t getNumberOfSlabs() {
+        return slabs.size();
+    }
+
+private:
+
+    Arena(const Arena &);
+    Arena & operator=(const Arena &);
+
+    template<typename T>
+    static void destroy(void * object) {
+        ((T*) object)->~T();
+    }
+
+    /**A chunk of memory obtained from the heap*/
+    typedef struct {
+        unsigned char * data;
+        size_t size;
+        size_t used;
+    } Slab;
+
+    /**Destructor to call on reset()*/
+    typedef struct {
+        void (*destroy)(void *);
+        void * object;
+    } Finalizer;
+
+    /**Default slab size in bytes*/
+    size_t slabSize;
+
+    /**Index of the slab being carved*/
+    size_t currentSlab;
+
+    /**Slabs obtained from the heap*/
+    std::vector<Slab> slabs;
+
+    /**Destructors of the objects built with create()*/
+    std::vector<Finalizer> finalizers;
+};
+
+#endif /* ARENA_HPP */
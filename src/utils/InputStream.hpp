@@ -0,0 +1,567 @@
+/*
+* Copyright 2020 © Centre Interdisciplinaire de développement en Cartographie des Océans (CIDCO), Tous droits réservés
+*/
+
+#ifndef INPUTSTREAM_HPP
+#define INPUTSTREAM_HPP
+
+#include <cstdio>
+#include <cstring>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <algorithm>
+#include <zlib.h>
+#ifdef MBES_WITH_ZSTD
+#include <zstd.h>
+#endif
+#include "Exception.hpp"
+#include "Stats.hpp"
+
+/*!
+* \brief Sequential binary input read by the datagram parsers
+*
+* Mirrors the subset of stdio the parsers use (fread, forward fseek, feof, ftell), so a plain file and a
+* compressed one are read the same way. open() looks at the first bytes of the file to pick the implementation.
+*/
+class InputStream {
+public:
+
+    /**Destroys the stream and closes its file*/
+    virtual ~InputStream() {
+    }
+
+    /**
+    * Reads items, like fread
+    *
+    * @param buffer receives the items
+    * @param size size of an item
+    * @param count number of items
+    * @return the number of complete items read
+    */
+    virtual size_t read(void * buffer, size_t size, size_t count) = 0;
+
+    /**
+    * Skips bytes forward, like fseek(SEEK_CUR)
+    *
+    * @param nbBytes number of bytes skipped
+    */
+    virtual void skip(uint64_t nbBytes) = 0;
+
+    /**Returns true once a read came up short, like feof*/
+    virtual bool eof() = 0;
+
+    /**Returns the number of (uncompressed) bytes read or skipped so far*/
+    virtual uint64_t tell() = 0;
+
+    /**
+    * Opens a file, which may be compressed with gzip or zstd whatever its name
+    *
+    * @param filename the name of the file
+    * @return the stream, to be deleted by the caller, or NULL if the file cannot be opened
+    */
+    static InputStream * open(const std::string & filename);
+};
+
+/*!
+* \brief Uncompressed file
+*/
+class FileInputStream : public InputStream {
+public:
+
+    /**
+    * Creates a stream over an open file
+    *
+    * @param file the file, closed with the stream
+    */
+    FileInputStream(FILE * file) : file(file) {
+    }
+
+    /**Closes the file*/
+    ~FileInputStream() {
+        fclose(file);
+    }
+
+    size_t read(void * buffer, size_t size, size_t count) {
+        size_t nbRead = fread(buffer, size, count, file);
+        STATS_COUNT(STATS_BYTES_READ, nbRead * size);
+        return nbRead;
+    }
+
+    void skip(uint64_t nbBytes) {
+        fseek(file, nbBytes, SEEK_CUR);
+        STATS_COUNT(STATS_BYTES_SKIPPED, nbBytes);
+    }
+
+    bool eof() {
+        return feof(file);
+    }
+
+    uint64_t tell() {
+        return ftell(file);
+    }
+
+private:
+
+    /**The file*/
+    FILE * file;
+};
+
+/*!
+* \brief Streaming decompressor of a compressed format
+*/
+class Decompressor {
+public:
+
+    /**Destroys the decompressor*/
+    virtual ~Decompressor() {
+    }
+
+    /**
+    * Decompresses as much as possible of the input into the output. Throws on corrupt data
+    *
+    * @param in compressed bytes
+    * @param inSize number of compressed bytes
+    * @param consumed receives the number of compressed bytes used
+    * @param out receives the decompressed bytes
+    * @param outSize room in the output
+    * @param produced receives the number of decompressed bytes
+    */
+    virtual void decompress(const unsigned char * in, size_t inSize, size_t & consumed, unsigned char * out, size_t outSize, size_t & produced) = 0;
+
+    /**Returns true if the bytes given so far end on a complete member or frame*/
+    virtual bool isAtEnd() = 0;
+};
+
+/*!
+* \brief gzip (and zlib) decompressor. Concatenated members, as written by pigz or bgzip, are read one after the other
+*/
+class GzipDecompressor : public Decompressor {
+public:
+
+    /**Creates a decompressor*/
+    GzipDecompressor() : ended(false) {
+        memset(&stream, 0, sizeof (z_stream));
+
+        //15 bit window, detect the gzip or zlib header
+        if (inflateInit2(&stream, 15 + 32) != Z_OK) {
+            throw new Exception("Couldn't initialize the gzip decompressor");
+        }
+    }
+
+    /**Destroys the decompressor*/
+    ~GzipDecompressor() {
+        inflateEnd(&stream);
+    }
+
+    void decompress(const unsigned char * in, size_t inSize, size_t & consumed, unsigned char * out, size_t outSize, size_t & produced) {
+        if (ended && inSize > 0) {
+            //next member
+            inflateReset(&stream);
+            ended = false;
+        }
+
+        stream.next_in = (Bytef *) in;
+        stream.avail_in = inSize;
+        stream.next_out = out;
+        stream.avail_out = outSize;
+
+        int status = inflate(&stream, Z_NO_FLUSH);
+
+        if (status == Z_STREAM_END) {
+            ended = true;
+        } else if (status != Z_OK && status != Z_BUF_ERROR) {
+            throw new Exception("Corrupt gzip data");
+        }
+
+        consumed = inSize - stream.avail_in;
+        produced = outSize - stream.avail_out;
+    }
+
+    bool isAtEnd() {
+        return ended;
+    }
+
+private:
+
+    /**zlib state*/
+    z_stream stream;
+
+    /**true once a member is complete*/
+    bool ended;
+};
+
+#ifdef MBES_WITH_ZSTD
+
+/*!
+* \brief zstd decompressor. Concatenated frames are read one after the other
+*/
+class ZstdDecompressor : public Decompressor {
+public:
+
+    /**Creates a decompressor*/
+    ZstdDecompressor() : stream(ZSTD_createDStream()), ended(false) {
+        if (!stream) {
+            throw new Exception("Couldn't initialize the zstd decompressor");
+        }
+
+        ZSTD_initDStream(stream);
+    }
+
+    /**Destroys the decompressor*/
+    ~ZstdDecompressor() {
+        ZSTD_freeDStream(stream);
+    }
+
+    void decompress(const unsigned char * in, size_t inSize, size_t & consumed, unsigned char * out, size_t outSize, size_t & produced) {
+        ZSTD_inBuffer input = {in, inSize, 0};
+        ZSTD_outBuffer output = {out, outSize, 0};
+
+        size_t status = ZSTD_decompressStream(stream, &output, &input);
+
+        if (ZSTD_isError(status)) {
+            throw new Exception(std::string("Corrupt zstd data: ") + ZSTD_getErrorName(status));
+        }
+
+        //0 once a frame is decoded and flushed. A call without progress after that asks for the next frame
+        if (status == 0) {
+            ended = true;
+        } else if (input.pos > 0 || output.pos > 0) {
+            ended = false;
+        }
+
+        consumed = input.pos;
+        produced = output.pos;
+    }
+
+    bool isAtEnd() {
+        return ended;
+    }
+
+private:
+
+    /**zstd state*/
+    ZSTD_DStream * stream;
+
+    /**true once a frame is complete*/
+    bool ended;
+};
+
+#endif
+
+/*!
+* \brief Compressed file, decompressed by a thread of its own
+*
+* The thread reads the file and decompresses it into a few blocks ahead of the parser, so decompression overlaps
+* with decoding and nothing is written to disk. Once the parser is done with a block, it goes back to the thread.
+* Corrupt or truncated data is reported by read() and skip(), as an Exception, when the parser reaches it.
+*/
+class CompressedInputStream : public InputStream {
+public:
+
+    /**
+    * Creates a stream over an open file and starts decompressing it
+    *
+    * @param file the compressed file, closed with the stream
+    * @param decompressor the decompressor of its format, deleted with the stream
+    * @param blockSize number of decompressed bytes in a block
+    * @param nbBlocks number of blocks decompressed ahead of the parser
+    */
+    CompressedInputStream(FILE * file, Decompressor * decompressor, unsigned int blockSize = 1 << 20, unsigned int nbBlocks = 4) :
+    file(file),
+    decompressor(decompressor),
+    blocks(nbBlocks),
+    current(NULL),
+    position(0),
+    offset(0),
+    eofReached(false),
+    finished(false),
+    stopping(false) {
+        for (unsigned int i = 0; i < nbBlocks; i++) {
+            blocks[i].data.resize(blockSize);
+            blocks[i].size = 0;
+            freeBlocks.push_back(&blocks[i]);
+        }
+
+        worker = std::thread(&CompressedInputStream::run, this);
+    }
+
+    /**Stops the decompression thread and closes the file*/
+    ~CompressedInputStream() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+
+        changed.notify_all();
+        worker.join();
+
+        delete decompressor;
+        fclose(file);
+    }
+
+    size_t read(void * buffer, size_t size, size_t count) {
+        size_t copied = consume((unsigned char *) buffer, size * count);
+        return (size > 0) ? copied / size : 0;
+    }
+
+    void skip(uint64_t nbBytes) {
+        consume(NULL, nbBytes);
+    }
+
+    bool eof() {
+        return eofReached;
+    }
+
+    uint64_t tell() {
+        return offset;
+    }
+
+private:
+
+    /**Block of decompressed bytes*/
+    typedef struct {
+        std::vector<unsigned char> data;
+        size_t size;
+    } Block;
+
+    /**
+    * Copies (or drops, if the destination is NULL) the next decompressed bytes
+    *
+    * @return the number of bytes copied, short at the end of the stream
+    */
+    size_t consume(unsigned char * destination, uint64_t nbBytes) {
+        uint64_t done = 0;
+
+        while (done < nbBytes) {
+            if (!current || position == current->size) {
+                if (!nextBlock()) {
+                    eofReached = true;
+                    break;
+                }
+            }
+
+            size_t n = std::min<uint64_t>(nbBytes - done, current->size - position);
+
+            if (destination) {
+                memcpy(destination + done, &current->data[position], n);
+            }
+
+            position += n;
+            done += n;
+        }
+
+        offset += done;
+
+        STATS_COUNT(destination ? STATS_BYTES_READ : STATS_BYTES_SKIPPED, done);
+
+        return done;
+    }
+
+    /**Hands the current block back to the thread and waits for the next one. Returns false at the end of the stream*/
+    bool nextBlock() {
+        std::unique_lock<std::mutex> lock(mutex);
+
+        if (current) {
+            freeBlocks.push_back(current);
+            current = NULL;
+            changed.notify_all();
+        }
+
+        if (finished) {
+            return false;
+        }
+
+        changed.wait(lock, [this]() {
+            return !filledBlocks.empty();
+        });
+
+        current = filledBlocks.front();
+        filledBlocks.pop_front();
+        position = 0;
+
+        //NULL marks the end of the stream
+        if (!current) {
+            finished = true;
+
+            if (!error.empty()) {
+                throw new Exception(error);
+            }
+
+            return false;
+        }
+
+        return true;
+    }
+
+    /**Waits for a free block. Returns NULL if the stream is being destroyed*/
+    Block * freeBlock() {
+        std::unique_lock<std::mutex> lock(mutex);
+
+        changed.wait(lock, [this]() {
+            return stopping || !freeBlocks.empty();
+        });
+
+        if (stopping) {
+            return NULL;
+        }
+
+        Block * block = freeBlocks.front();
+        freeBlocks.pop_front();
+
+        return block;
+    }
+
+    /**Hands a block to the parser, NULL for the end of the stream*/
+    void publish(Block * block) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            filledBlocks.push_back(block);
+        }
+
+        changed.notify_all();
+    }
+
+    /**Body of the decompression thread*/
+    void run() {
+        std::vector<unsigned char> input(1 << 16);
+        size_t inputBegin = 0;
+        size_t inputEnd = 0;
+        bool inputEof = false;
+        bool ended = false;
+
+        try {
+            while (!ended) {
+                Block * block = freeBlock();
+
+                if (!block) {
+                    return;
+                }
+
+                block->size = 0;
+
+                while (block->size < block->data.size()) {
+                    if (inputBegin == inputEnd && !inputEof) {
+                        inputBegin = 0;
+                        inputEnd = fread(&input[0], 1, input.size(), file);
+                        inputEof = (inputEnd == 0);
+                    }
+
+                    size_t consumed = 0;
+                    size_t produced = 0;
+
+                    decompressor->decompress(&input[inputBegin], inputEnd - inputBegin, consumed, &block->data[block->size], block->data.size() - block->size, produced);
+
+                    inputBegin += consumed;
+                    block->size += produced;
+
+                    if (consumed == 0 && produced == 0) {
+                        //no progress: all the input went through and all the output came out
+                        if (!inputEof) {
+                            throw new Exception("Corrupt compressed data");
+                        }
+
+                        if (!decompressor->isAtEnd()) {
+                            throw new Exception("Truncated compressed data");
+                        }
+
+                        ended = true;
+                        break;
+                    }
+                }
+
+                if (block->size > 0) {
+                    publish(block);
+                } else {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    freeBlocks.push_back(block);
+                }
+            }
+        } catch (Exception * e) {
+            std::lock_guard<std::mutex> lock(mutex);
+            error = e->what();
+            delete e;
+        }
+
+        publish(NULL);
+    }
+
+    /**The compressed file*/
+    FILE * file;
+
+    /**Decompressor of the format of the file*/
+    Decompressor * decompressor;
+
+    /**All the blocks*/
+    std::vector<Block> blocks;
+
+    /**Blocks waiting to be filled by the thread*/
+    std::deque<Block *> freeBlocks;
+
+    /**Blocks waiting to be read by the parser, in order*/
+    std::deque<Block *> filledBlocks;
+
+    /**Block being read by the parser*/
+    Block * current;
+
+    /**Next byte of the current block*/
+    size_t position;
+
+    /**Number of decompressed bytes read or skipped*/
+    uint64_t offset;
+
+    /**true once a read came up short*/
+    bool eofReached;
+
+    /**true once the parser reached the end of the stream*/
+    bool finished;
+
+    /**true when the stream is being destroyed*/
+    bool stopping;
+
+    /**Error met by the thread*/
+    std::string error;
+
+    /**Guards the block queues, the error and the stop flag*/
+    std::mutex mutex;
+
+    /**Signals a change of the block queues or of the stop flag*/
+    std::condition_variable changed;
+
+    /**The decompression thread*/
+    std::thread worker;
+};
+
+inline InputStream * InputStream::open(const std::string & filename) {
+    FILE * file = fopen(filename.c_str(), "rb");
+
+    if (!file) {
+        return NULL;
+    }
+
+    unsigned char magic[4] = {0, 0, 0, 0};
+    size_t nbRead = fread(magic, 1, sizeof (magic), file);
+    rewind(file);
+
+    //gzip magic, deflate method and no reserved flag. The magic alone can be the length of an uncompressed datagram
+    if (nbRead == 4 && magic[0] == 0x1f && magic[1] == 0x8b && magic[2] == 0x08 && (magic[3] & 0xe0) == 0) {
+        return new CompressedInputStream(file, new GzipDecompressor());
+    }
+
+    if (nbRead == 4 && magic[0] == 0x28 && magic[1] == 0xb5 && magic[2] == 0x2f && magic[3] == 0xfd) {
+#ifdef MBES_WITH_ZSTD
+        return new CompressedInputStream(file, new ZstdDecompressor());
+#else
+        fclose(file);
+        throw new Exception("zstd compressed files need a build with zstd support (make ZSTD=1): " + filename);
+#endif
+    }
+
+    return new FileInputStream(file);
+}
+
+#endif /* INPUTSTREAM_HPP */
@@ -7,6 +7,98 @@
 
 #include "NmeaUtils.hpp"
 
+/**
+* Splits a sentence into fields and checks its checksum, the exclusive or of the characters between '$' and '*'
+*
+* @param sentence the sentence
+* @param length number of characters of the sentence
+*/
+void NmeaSentence::parse(const char * sentence, unsigned int length){
+  const char * c = sentence;
+  const char * end = sentence + length;
+
+  if(c < end && (*c == '$' || *c == '!')){
+    c++;
+  }
+
+  unsigned char sum = 0;
+
+  nbFields = 1;
+  fields[0] = c;
+
+  for(; c < end && *c != '*' && *c != '\r' && *c != '\n' && *c != 0; c++){
+    sum ^= (unsigned char) *c;
+
+    if(*c == ','){
+      if(nbFields <= maxFields){
+        lengths[nbFields - 1] = c - fields[nbFields - 1];
+      }
+
+      if(nbFields < maxFields){
+        fields[nbFields] = c + 1;
+      }
+
+      nbFields++;
+    }
+  }
+
+  if(nbFields > maxFields){
+    nbFields = maxFields;
+  }
+  else{
+    lengths[nbFields - 1] = c - fields[nbFields - 1];
+  }
+
+  checksumPresent = false;
+  checksumValid = false;
+
+  if(end - c >= 3 && *c == '*' && isxdigit((unsigned char) c[1]) && isxdigit((unsigned char) c[2])){
+    char hex[3] = {c[1], c[2], 0};
+    checksumPresent = true;
+    checksumValid = (strtol(hex, NULL, 16) == sum);
+  }
+}
+
+int NmeaSentence::findType(const char * type) const{
+  unsigned int typeLength = strlen(type);
+
+  //talker and type in the address field, such as GPGGA
+  if(lengths[0] >= typeLength && strncmp(fields[0] + lengths[0] - typeLength, type, typeLength) == 0){
+    return 0;
+  }
+
+  //proprietary sentence, such as PTNL,GGK
+  if(nbFields > 1 && lengths[0] > 0 && fields[0][0] == 'P' && lengths[1] == typeLength && strncmp(fields[1], type, typeLength) == 0){
+    return 1;
+  }
+
+  return -1;
+}
+
+bool NmeaSentence::startsWith(unsigned int index, const char * prefix) const{
+  unsigned int prefixLength = strlen(prefix);
+
+  return index < nbFields && lengths[index] >= prefixLength && strncmp(fields[index], prefix, prefixLength) == 0;
+}
+
+double NmeaSentence::getDouble(unsigned int index) const{
+  if(index >= nbFields){
+    return std::numeric_limits<double>::quiet_NaN();
+  }
+
+  return NmeaUtils::parseDouble(fields[index], fields[index] + lengths[index]);
+}
+
+int NmeaSentence::getInt(unsigned int index) const{
+  double value = getDouble(index);
+
+  return std::isnan(value) ? 0 : (int) value;
+}
+
+char NmeaSentence::getChar(unsigned int index) const{
+  return (index < nbFields && lengths[index] > 0) ? fields[index][0] : 0;
+}
+
 /**
 * Extracts ellipsoidal height from GGK
 *
@@ -14,13 +106,11 @@
 * @return
 */
 double NmeaUtils::extractHeightFromGGK(std::string & ggkString){
-  std::stringstream ss(ggkString);
-  std::string token;
+  NmeaSentence sentence(ggkString.c_str(), ggkString.size());
+  NmeaGGK ggk;
 
-  while(std::getline(ss,token,',')){
-    if(token.find("EHT")!= std::string::npos){
-      return atof(token.substr(3).c_str());
-    }
+  if(extractGGK(sentence, ggk)){
+    return ggk.ellipsoidalHeight;
   }
 
   return std::numeric_limits<double>::quiet_NaN();
@@ -32,32 +122,208 @@ double NmeaUtils::extractHeightFromGGK(std::string & ggkString){
 * @return
 */
 double NmeaUtils::extractHeightFromGGA(std::string & ggaString){
-  std::stringstream ss(ggaString);
-  std::string token;
+  NmeaSentence sentence(ggaString.c_str(), ggaString.size());
+  NmeaGGA gga;
+
+  if(extractGGA(sentence, gga)){
+    return gga.orthometricHeight + gga.geoidSeparation;
+  }
 
-  double orthometricHeight = std::numeric_limits<double>::quiet_NaN();
-  double geoidSeperation   = std::numeric_limits<double>::quiet_NaN();
+  return std::numeric_limits<double>::quiet_NaN();
+}
 
-  int i=0;
+/**
+* Extracts a GGA sentence
+*
+* @param sentence the sentence
+* @param gga the fields of the sentence, NaN when empty
+* @return false if the sentence is not a GGA or its checksum is wrong
+*/
+bool NmeaUtils::extractGGA(NmeaSentence & sentence, NmeaGGA & gga){
+  int type = sentence.findType("GGA");
 
-  while(std::getline(ss,token,',')){
-    if(i==9){
-      //orthometric height
-      orthometricHeight = atof(token.c_str());
-    }
-    else if(i==11){
-      //geoid seperation
-      geoidSeperation = atof(token.c_str());
+  if(type < 0 || !sentence.isChecksumValid()){
+    return false;
+  }
+
+  gga.time = parseTime(sentence, type + 1);
+  gga.latitude = parseCoordinate(sentence, type + 2);
+  gga.longitude = parseCoordinate(sentence, type + 4);
+  gga.quality = sentence.getInt(type + 6);
+  gga.nbSatellites = sentence.getInt(type + 7);
+  gga.hdop = sentence.getDouble(type + 8);
+  gga.orthometricHeight = sentence.getDouble(type + 9);
+  gga.geoidSeparation = sentence.getDouble(type + 11);
+
+  return true;
+}
+
+/**
+* Extracts a GGK sentence, from its GPGGK or PTNL,GGK form
+*
+* @param sentence the sentence
+* @param ggk the fields of the sentence, NaN when empty
+* @return false if the sentence is not a GGK or its checksum is wrong
+*/
+bool NmeaUtils::extractGGK(NmeaSentence & sentence, NmeaGGK & ggk){
+  int type = sentence.findType("GGK");
+
+  if(type < 0 || !sentence.isChecksumValid()){
+    return false;
+  }
+
+  //the field after the date is skipped
+  ggk.time = parseTime(sentence, type + 1);
+  ggk.latitude = parseCoordinate(sentence, type + 3);
+  ggk.longitude = parseCoordinate(sentence, type + 5);
+  ggk.quality = sentence.getInt(type + 7);
+  ggk.nbSatellites = sentence.getInt(type + 8);
+  ggk.dop = sentence.getDouble(type + 9);
+  ggk.ellipsoidalHeight = std::numeric_limits<double>::quiet_NaN();
+
+  //the height is prefixed with EHT
+  for(unsigned int i = type + 1; i < sentence.getNumberOfFields(); i++){
+    if(sentence.startsWith(i, "EHT")){
+      ggk.ellipsoidalHeight = parseDouble(sentence.getField(i) + 3, sentence.getField(i) + sentence.getFieldLength(i));
+      break;
     }
+  }
+
+  return true;
+}
+
+/**
+* Extracts a GST sentence
+*
+* @param sentence the sentence
+* @param gst the fields of the sentence, NaN when empty
+* @return false if the sentence is not a GST or its checksum is wrong
+*/
+bool NmeaUtils::extractGST(NmeaSentence & sentence, NmeaGST & gst){
+  int type = sentence.findType("GST");
+
+  if(type < 0 || !sentence.isChecksumValid()){
+    return false;
+  }
 
-    if(!std::isnan(orthometricHeight) && !std::isnan(geoidSeperation)){
-      return orthometricHeight + geoidSeperation;
+  gst.time = parseTime(sentence, type + 1);
+  gst.rms = sentence.getDouble(type + 2);
+  gst.semiMajorError = sentence.getDouble(type + 3);
+  gst.semiMinorError = sentence.getDouble(type + 4);
+  gst.orientation = sentence.getDouble(type + 5);
+  gst.latitudeError = sentence.getDouble(type + 6);
+  gst.longitudeError = sentence.getDouble(type + 7);
+  gst.heightError = sentence.getDouble(type + 8);
+
+  return true;
+}
+
+/**
+* Extracts an HDT sentence
+*
+* @param sentence the sentence
+* @param hdt the fields of the sentence, NaN when empty
+* @return false if the sentence is not an HDT or its checksum is wrong
+*/
+bool NmeaUtils::extractHDT(NmeaSentence & sentence, NmeaHDT & hdt){
+  int type = sentence.findType("HDT");
+
+  if(type < 0 || !sentence.isChecksumValid()){
+    return false;
+  }
+
+  hdt.heading = sentence.getDouble(type + 1);
+
+  return true;
+}
+
+/**
+* Parses a decimal number, without reading past its end
+*
+* Numbers of up to 15 digits are exact integers divided by an exact power of ten, which rounds like strtod.
+* Longer numbers and exponents are copied to the stack for strtod.
+*
+* @param begin first character of the number
+* @param end character after the number
+* @return the number, NaN if there is no digit
+*/
+double NmeaUtils::parseDouble(const char * begin, const char * end){
+  static const double powersOfTen[] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15};
+
+  const char * c = begin;
+  bool negative = false;
+
+  if(c < end && (*c == '-' || *c == '+')){
+    negative = (*c == '-');
+    c++;
+  }
+
+  uint64_t mantissa = 0;
+  unsigned int nbDigits = 0;
+  unsigned int nbDecimals = 0;
+  bool point = false;
+
+  for(; c < end; c++){
+    if(*c >= '0' && *c <= '9'){
+      mantissa = mantissa * 10 + (*c - '0');
+      nbDigits++;
+      nbDecimals += point;
     }
+    else if(*c == '.' && !point){
+      point = true;
+    }
+    else{
+      break;
+    }
+  }
 
-    i++;
+  if(nbDigits == 0){
+    return std::numeric_limits<double>::quiet_NaN();
   }
 
-  return std::numeric_limits<double>::quiet_NaN();
+  if(nbDigits <= 15 && (c == end || (*c != 'e' && *c != 'E'))){
+    double value = (double) mantissa / powersOfTen[nbDecimals];
+    return negative ? -value : value;
+  }
+
+  char number[64];
+  unsigned int length = std::min<unsigned int>(end - begin, sizeof(number) - 1);
+  memcpy(number, begin, length);
+  number[length] = 0;
+
+  return strtod(number, NULL);
+}
+
+/**
+* Parses an hhmmss.ss time field
+*
+* @param sentence the sentence
+* @param index the field
+* @return seconds since midnight, NaN if the field is empty
+*/
+double NmeaUtils::parseTime(NmeaSentence & sentence, unsigned int index){
+  double hhmmss = sentence.getDouble(index);
+  double hours = std::floor(hhmmss / 10000);
+  double minutes = std::floor((hhmmss - hours * 10000) / 100);
+
+  return hours * 3600 + minutes * 60 + (hhmmss - hours * 10000 - minutes * 100);
+}
+
+/**
+* Parses a (d)ddmm.mmmm coordinate field followed by its N, S, E or W field
+*
+* @param sentence the sentence
+* @param index the coordinate field
+* @return decimal degrees, negative south and west, NaN if the field is empty
+*/
+double NmeaUtils::parseCoordinate(NmeaSentence & sentence, unsigned int index){
+  double dddmm = sentence.getDouble(index);
+  double degrees = std::floor(dddmm / 100);
+  double coordinate = degrees + (dddmm - degrees * 100) / 60;
+
+  char hemisphere = sentence.getChar(index + 1);
+
+  return (hemisphere == 'S' || hemisphere == 'W') ? -coordinate : coordinate;
 }
 
 #endif
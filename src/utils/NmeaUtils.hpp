@@ -10,7 +10,137 @@
 #include <sstream>
 #include <iostream>
 #include <cstdlib>
+#include <cstring>
+#include <cstdint>
+#include <cctype>
 #include <cmath>
+#include <algorithm>
+
+/*!
+* \brief NMEA sentence split into fields in place
+*
+* The fields point into the sentence, which must outlive them: nothing is copied or allocated.
+* The leading '$' and the "*hh" checksum are not part of the fields.
+*/
+class NmeaSentence {
+public:
+
+  /**
+  * Splits a sentence into fields
+  *
+  * @param sentence the sentence, with or without the leading '$'
+  * @param length number of characters of the sentence, which stops earlier at '*', a line end or a null
+  */
+  NmeaSentence(const char * sentence, unsigned int length){
+    parse(sentence, length);
+  }
+
+  /**
+  * Splits a null terminated sentence into fields
+  *
+  * @param sentence the sentence, with or without the leading '$'
+  */
+  explicit NmeaSentence(const char * sentence){
+    parse(sentence, strlen(sentence));
+  }
+
+  /**Returns the number of fields, the address field included*/
+  unsigned int getNumberOfFields() const { return nbFields; }
+
+  /**Returns the first character of a field*/
+  const char * getField(unsigned int index) const { return fields[index]; }
+
+  /**Returns the number of characters of a field*/
+  unsigned int getFieldLength(unsigned int index) const { return lengths[index]; }
+
+  /**Returns true if the sentence ends with a "*hh" checksum*/
+  bool hasChecksum() const { return checksumPresent; }
+
+  /**Returns true if the sentence has no checksum or a correct one*/
+  bool isChecksumValid() const { return !checksumPresent || checksumValid; }
+
+  /**
+  * Returns the index of the field holding the sentence type, -1 if it is not this type.
+  * The type is the end of the address field, such as GGA in GPGGA, or the field after a proprietary PTNL address.
+  *
+  * @param type the sentence type, such as "GGA"
+  */
+  int findType(const char * type) const;
+
+  /**Returns true if a field starts with a prefix*/
+  bool startsWith(unsigned int index, const char * prefix) const;
+
+  /**Returns the number in a field, NaN if the field is missing, empty or not a number*/
+  double getDouble(unsigned int index) const;
+
+  /**Returns the integer in a field, 0 if the field is missing, empty or not a number*/
+  int getInt(unsigned int index) const;
+
+  /**Returns the first character of a field, 0 if the field is missing or empty*/
+  char getChar(unsigned int index) const;
+
+private:
+
+  void parse(const char * sentence, unsigned int length);
+
+  /**Most fields kept, the following ones are ignored*/
+  static const unsigned int maxFields = 32;
+
+  /**First character of each field*/
+  const char * fields[maxFields];
+
+  /**Number of characters of each field*/
+  unsigned int lengths[maxFields];
+
+  /**Number of fields*/
+  unsigned int nbFields;
+
+  /**True if the sentence ends with a checksum*/
+  bool checksumPresent;
+
+  /**True if the checksum matches the sentence*/
+  bool checksumValid;
+};
+
+/**GGA sentence: position fix with orthometric height*/
+typedef struct {
+  double time;              //seconds since midnight UTC
+  double latitude;          //decimal degrees, negative south
+  double longitude;         //decimal degrees, negative west
+  int    quality;           //fix quality
+  int    nbSatellites;
+  double hdop;
+  double orthometricHeight; //meters
+  double geoidSeparation;   //meters
+} NmeaGGA;
+
+/**GGK sentence (Trimble): position fix with ellipsoidal height*/
+typedef struct {
+  double time;              //seconds since midnight UTC
+  double latitude;          //decimal degrees, negative south
+  double longitude;         //decimal degrees, negative west
+  int    quality;           //fix quality
+  int    nbSatellites;
+  double dop;
+  double ellipsoidalHeight; //meters
+} NmeaGGK;
+
+/**GST sentence: position error statistics*/
+typedef struct {
+  double time;              //seconds since midnight UTC
+  double rms;               //RMS of the pseudorange residuals
+  double semiMajorError;    //meters
+  double semiMinorError;    //meters
+  double orientation;       //degrees from true north
+  double latitudeError;     //meters
+  double longitudeError;    //meters
+  double heightError;       //meters
+} NmeaGST;
+
+/**HDT sentence: true heading*/
+typedef struct {
+  double heading;           //degrees
+} NmeaHDT;
 
 /*!
 * \brief NmeaUtils class
@@ -20,6 +150,15 @@ class NmeaUtils{
 public:
   static double extractHeightFromGGK(std::string & ggkString);
   static double extractHeightFromGGA(std::string & ggaString);
+
+  static bool extractGGA(NmeaSentence & sentence, NmeaGGA & gga);
+  static bool extractGGK(NmeaSentence & sentence, NmeaGGK & ggk);
+  static bool extractGST(NmeaSentence & sentence, NmeaGST & gst);
+  static bool extractHDT(NmeaSentence & sentence, NmeaHDT & hdt);
+
+  static double parseDouble(const char * begin, const char * end);
+  static double parseTime(NmeaSentence & sentence, unsigned int index);
+  static double parseCoordinate(NmeaSentence & sentence, unsigned int index);
 };
 
 #endif
@@ -0,0 +1,326 @@
+/*
+* Copyright 2020 © Centre Interdisciplinaire de développement en Cartographie des Océans (CIDCO), Tous droits réservés
+*/
+
+#ifndef POINTTEXTREADER_HPP
+#define POINTTEXTREADER_HPP
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cctype>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <iostream>
+#include "../filter/PointBatch.hpp"
+
+/*!
+* \brief Reads "x y z quality intensity" point lines in large blocks
+*
+* Accepts the same lines as sscanf("%lf %lf %lf %d %d"). Numbers are parsed by hand; a number the fast path
+* cannot convert exactly (too many digits, large exponent, hexadecimal, inf, nan) is handed to strtod.
+* Malformed lines are reported on std::cerr as "Error at line N". A line holding only "0" ends the input.
+*/
+class PointTextReader {
+public:
+
+    /**
+    * Creates a point reader
+    *
+    * @param in the input file
+    * @param bufferSize size of the blocks read from the file
+    */
+    PointTextReader(FILE * in, unsigned int bufferSize = 1 << 20) : in(in), buffer(bufferSize), begin(0), end(0), lineNumber(0), eof(false), finished(false) {
+    }
+
+    /**
+    * Reads the next points into a batch
+    *
+    * @param batch receives the points, cleared first
+    * @param maxPoints maximum number of points read
+    * @return false once the input is exhausted and no point was read
+    */
+    bool read(PointBatch & batch, unsigned int maxPoints) {
+        batch.clear();
+
+        while (batch.size() < maxPoints && !finished) {
+            char * start = &buffer[0] + begin;
+            char * newline = (char *) memchr(start, '\n', end - begin);
+
+            if (!newline) {
+                if (eof) {
+                    //the last line may lack its end of line
+                    if (begin < end) {
+                        processLine(start, &buffer[0] + end, batch);
+                        begin = end;
+                    }
+
+                    finished = true;
+                    break;
+                }
+
+                fill();
+                continue;
+            }
+
+            processLine(start, newline, batch);
+            begin = (newline - &buffer[0]) + 1;
+        }
+
+        return batch.size() > 0;
+    }
+
+    /**Returns the number of lines read*/
+    unsigned int getNumberOfLines() {
+        return lineNumber;
+    }
+
+    /**
+    * Parses a floating point number, skipping leading whitespace
+    *
+    * @param p start of the number, moved past it
+    * @param end end of the line
+    * @param value receives the number
+    * @return false if no number starts at p
+    */
+    static bool parseDouble(const char * & p, const char * end, double & value) {
+        static const double powersOf10[] = {
+            1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+            1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+        };
+
+        skipWhitespace(p, end);
+
+        const char * s = p;
+        bool negative = false;
+
+        if (s < end && (*s == '+' || *s == '-')) {
+            negative = (*s == '-');
+            s++;
+        }
+
+        uint64_t mantissa = 0;
+        int digits = 0;
+        int exponent = 0;
+        bool anyDigit = false;
+
+        for (; s < end && *s >= '0' && *s <= '9'; s++) {
+            anyDigit = true;
+            accumulate(mantissa, digits, exponent, *s - '0', false);
+        }
+
+        if (s < end && *s == '.') {
+            s++;
+
+            for (; s < end && *s >= '0' && *s <= '9'; s++) {
+                anyDigit = true;
+                accumulate(mantissa, digits, exponent, *s - '0', true);
+            }
+        }
+
+        if (anyDigit && s < end && (*s == 'e' || *s == 'E')) {
+            const char * e = s + 1;
+            bool negativeExponent = false;
+
+            if (e < end && (*e == '+' || *e == '-')) {
+                negativeExponent = (*e == '-');
+                e++;
+            }
+
+            int explicitExponent = 0;
+
+            for (; e < end && *e >= '0' && *e <= '9'; e++) {
+                if (explicitExponent < 100000) {
+                    explicitExponent = explicitExponent * 10 + (*e - '0');
+                }
+            }
+
+            //like sscanf, an exponent without digits is consumed and ignored
+            exponent += negativeExponent ? -explicitExponent : explicitExponent;
+            s = e;
+        }
+
+        //Clinger's fast path: both the mantissa and the power of 10 are exact doubles, so one operation rounds correctly
+        bool exact = anyDigit && digits <= 15 && exponent >= -22 && exponent <= 22;
+        bool followedByNumberText = (s < end && (isalnum((unsigned char) *s) || *s == '.'));
+
+        if (exact && !followedByNumberText) {
+            if (mantissa == 0) {
+                value = 0;
+            }
+            else if (exponent < 0) {
+                value = (double) mantissa / powersOf10[-exponent];
+            }
+            else {
+                value = (double) mantissa * powersOf10[exponent];
+            }
+
+            if (negative) {
+                value = -value;
+            }
+
+            p = s;
+            return true;
+        }
+
+        return parseDoubleSlow(p, end, value);
+    }
+
+    /**
+    * Parses a decimal integer like %d, skipping leading whitespace
+    *
+    * @param p start of the number, moved past it
+    * @param end end of the line
+    * @param value receives the number
+    * @return false if no number starts at p
+    */
+    static bool parseInteger(const char * & p, const char * end, int64_t & value) {
+        skipWhitespace(p, end);
+
+        const char * s = p;
+        bool negative = false;
+
+        if (s < end && (*s == '+' || *s == '-')) {
+            negative = (*s == '-');
+            s++;
+        }
+
+        if (s >= end || *s < '0' || *s > '9') {
+            return false;
+        }
+
+        uint64_t magnitude = 0;
+
+        for (; s < end && *s >= '0' && *s <= '9'; s++) {
+            magnitude = magnitude * 10 + (*s - '0');
+        }
+
+        value = negative ? -(int64_t) magnitude : (int64_t) magnitude;
+        p = s;
+        return true;
+    }
+
+private:
+
+    /**Skips the whitespace sscanf skips*/
+    static void skipWhitespace(const char * & p, const char * end) {
+        while (p < end && (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\v' || *p == '\f')) {
+            p++;
+        }
+    }
+
+    /**Adds a digit to a mantissa of at most 19 significant digits, counting the digits beyond in the exponent*/
+    static void accumulate(uint64_t & mantissa, int & digits, int & exponent, int digit, bool fraction) {
+        if (mantissa == 0 && digit == 0) {
+            //leading zeros are not significant
+            if (fraction) {
+                exponent--;
+            }
+            return;
+        }
+
+        if (digits < 19) {
+            mantissa = mantissa * 10 + digit;
+
+            if (fraction) {
+                exponent--;
+            }
+        }
+        else if (!fraction) {
+            exponent++;
+        }
+
+        //digits beyond 15 leave the fast path, so dropping them is harmless
+        digits++;
+    }
+
+    /**Parses a number with strtod*/
+    static bool parseDoubleSlow(const char * & p, const char * end, double & value) {
+        const char * tokenEnd = p;
+
+        while (tokenEnd < end && *tokenEnd != ' ' && *tokenEnd != '\t' && *tokenEnd != '\r' && *tokenEnd != '\v' && *tokenEnd != '\f') {
+            tokenEnd++;
+        }
+
+        //strtod needs a terminated string
+        std::string token(p, tokenEnd);
+        char * parsedEnd;
+        value = strtod(token.c_str(), &parsedEnd);
+
+        if (parsedEnd == token.c_str()) {
+            return false;
+        }
+
+        p += parsedEnd - token.c_str();
+        return true;
+    }
+
+    /**Parses one line into the batch, or reports it*/
+    void processLine(const char * line, const char * lineEnd, PointBatch & batch) {
+        lineNumber++;
+
+        if (lineEnd - line == 1 && line[0] == '0') {
+            finished = true;
+            return;
+        }
+
+        const char * p = line;
+        double x, y, z;
+        int64_t quality, intensity;
+
+        if (parseDouble(p, lineEnd, x) && parseDouble(p, lineEnd, y) && parseDouble(p, lineEnd, z) && parseInteger(p, lineEnd, quality) && parseInteger(p, lineEnd, intensity)) {
+            batch.add(0, x, y, z, (uint32_t) quality, (uint32_t) intensity);
+        }
+        else {
+            std::cerr << "Error at line " << lineNumber << std::endl;
+        }
+    }
+
+    /**Moves the unread bytes to the front of the buffer and reads more after them*/
+    void fill() {
+        size_t remaining = end - begin;
+
+        if (remaining > 0 && begin > 0) {
+            memmove(&buffer[0], &buffer[0] + begin, remaining);
+        }
+
+        begin = 0;
+        end = remaining;
+
+        //a line longer than the buffer
+        if (end == buffer.size()) {
+            buffer.resize(buffer.size() * 2);
+        }
+
+        size_t nbRead = fread(&buffer[0] + end, 1, buffer.size() - end, in);
+        end += nbRead;
+
+        if (nbRead == 0) {
+            eof = true;
+        }
+    }
+
+    /**the input file*/
+    FILE * in;
+
+    /**block of input*/
+    std::vector<char> buffer;
+
+    /**first unread byte of the buffer*/
+    size_t begin;
+
+    /**end of the bytes read in the buffer*/
+    size_t end;
+
+    /**number of lines read*/
+    unsigned int lineNumber;
+
+    /**true once the file is exhausted*/
+    bool eof;
+
+    /**true once the input is over*/
+    bool finished;
+};
+
+#endif /* POINTTEXTREADER_HPP */
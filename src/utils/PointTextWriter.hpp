@@ -0,0 +1,176 @@
+/*
+* Copyright 2020 © Centre Interdisciplinaire de développement en Cartographie des Océans (CIDCO), Tous droits réservés
+*/
+
+#ifndef POINTTEXTWRITER_HPP
+#define POINTTEXTWRITER_HPP
+
+#include <cstdio>
+#include <cstdint>
+#include <cmath>
+#include <vector>
+
+/*!
+* \brief Writes "x y z quality intensity" point lines in large chunks
+*
+* Lines are identical to printf("%.6lf %.6lf %.6lf %d %d\n"). Coordinates are formatted by hand when the
+* rounding to 6 decimals is unambiguous, and by snprintf otherwise.
+*/
+class PointTextWriter {
+public:
+
+    /**
+    * Creates a point writer
+    *
+    * @param out the output file
+    * @param chunkSize number of bytes gathered before writing to the file
+    */
+    PointTextWriter(FILE * out, unsigned int chunkSize = 1 << 20) : out(out), buffer(chunkSize + MAX_LINE_LENGTH), chunkSize(chunkSize), used(0) {
+    }
+
+    /**Writes what is left to the file*/
+    ~PointTextWriter() {
+        flush();
+    }
+
+    /**
+    * Writes a point
+    *
+    * @param x x position of the point
+    * @param y y position of the point
+    * @param z z position of the point
+    * @param quality quality of the point
+    * @param intensity intensity of the point
+    */
+    void write(double x, double y, double z, uint32_t quality, uint32_t intensity) {
+        char * p = &buffer[0] + used;
+
+        p = appendFixed(p, x);
+        *p++ = ' ';
+        p = appendFixed(p, y);
+        *p++ = ' ';
+        p = appendFixed(p, z);
+        *p++ = ' ';
+        p = appendInteger(p, (int32_t) quality);
+        *p++ = ' ';
+        p = appendInteger(p, (int32_t) intensity);
+        *p++ = '\n';
+
+        used = p - &buffer[0];
+
+        if (used >= chunkSize) {
+            writeChunk();
+        }
+    }
+
+    /**Writes the gathered lines to the file and flushes it*/
+    void flush() {
+        writeChunk();
+        fflush(out);
+    }
+
+    /**
+    * Formats a number like "%.6lf"
+    *
+    * @param p where to write the number
+    * @param value the number
+    * @return the end of the number
+    */
+    static char * appendFixed(char * p, double value) {
+        double magnitude = std::fabs(value);
+
+        //below 1e7, the scaled value is within 0.001 of the exact one, so rounding is only in doubt near a half
+        if (!(magnitude < 1e7)) {
+            return p + snprintf(p, MAX_NUMBER_LENGTH, "%.6lf", value);
+        }
+
+        double scaled = magnitude * 1e6;
+        double whole = std::floor(scaled);
+        double fraction = scaled - whole;
+
+        if (fraction > 0.49 && fraction < 0.51) {
+            return p + snprintf(p, MAX_NUMBER_LENGTH, "%.6lf", value);
+        }
+
+        uint64_t micro = (uint64_t) whole + ((fraction > 0.5) ? 1 : 0);
+
+        if (std::signbit(value)) {
+            *p++ = '-';
+        }
+
+        p = appendUnsigned(p, micro / 1000000);
+        *p++ = '.';
+
+        uint64_t decimals = micro % 1000000;
+
+        for (int i = 5; i >= 0; i--) {
+            p[i] = '0' + decimals % 10;
+            decimals /= 10;
+        }
+
+        return p + 6;
+    }
+
+    /**
+    * Formats an integer like "%d"
+    *
+    * @param p where to write the number
+    * @param value the number
+    * @return the end of the number
+    */
+    static char * appendInteger(char * p, int32_t value) {
+        if (value < 0) {
+            *p++ = '-';
+            return appendUnsigned(p, (uint64_t) (-(int64_t) value));
+        }
+
+        return appendUnsigned(p, (uint64_t) value);
+    }
+
+private:
+
+    /**Longest "%.6lf" of a double*/
+    static const unsigned int MAX_NUMBER_LENGTH = 330;
+
+    /**Longest line*/
+    static const unsigned int MAX_LINE_LENGTH = 3 * MAX_NUMBER_LENGTH + 2 * 12 + 5;
+
+    /**Writes the digits of an unsigned integer*/
+    static char * appendUnsigned(char * p, uint64_t value) {
+        char digits[20];
+        int nbDigits = 0;
+
+        do {
+            digits[nbDigits++] = '0' + value % 10;
+            value /= 10;
+        } while (value > 0);
+
+        while (nbDigits > 0) {
+            *p++ = digits[--nbDigits];
+        }
+
+        return p;
+    }
+
+    /**Writes the gathered lines to the file*/
+    void writeChunk() {
+        if (used > 0) {
+            fwrite(&buffer[0], 1, used, out);
+            used = 0;
+        }
+    }
+
+    /**the output file*/
+    FILE * out;
+
+    /**gathered lines*/
+    std::vector<char> buffer;
+
+    /**number of bytes gathered before writing*/
+    unsigned int chunkSize;
+
+    /**number of bytes gathered*/
+    size_t used;
+};
+
+#endif /* POINTTEXTWRITER_HPP */
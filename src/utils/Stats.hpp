@@ -0,0 +1,460 @@
+/*
+* Copyright 2020 © Centre Interdisciplinaire de développement en Cartographie des Océans (CIDCO), Tous droits réservés
+*/
+
+#ifndef STATS_HPP
+#define STATS_HPP
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <map>
+#include <atomic>
+#include <mutex>
+#include <chrono>
+#include <iostream>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <algorithm>
+
+/**Processing stages timed by Stats*/
+enum StatsStage {
+    STATS_PARSING,          //reading and decoding datagrams
+    STATS_TIME_CONVERSION,  //converting datagram dates to timestamps
+    STATS_INTERPOLATION,    //interpolating positions and attitudes at pings
+    STATS_SVP_SELECTION,    //choosing the sound velocity profile of a ping
+    STATS_GEOREFERENCING,   //rotating and translating beams, without their raytracing
+    STATS_RAYTRACING,       //raytracing beams
+    STATS_OUTPUT,           //formatting and writing results
+    STATS_NB_STAGES
+};
+
+/**Events counted by Stats*/
+enum StatsCounter {
+    STATS_BYTES_READ,       //bytes read from input files, decompressed
+    STATS_BYTES_SKIPPED,    //bytes skipped in input files without being read
+    STATS_DATAGRAMS,        //datagrams decoded
+    STATS_PINGS,            //pings (beams) georeferenced
+    STATS_REJECTED_PINGS,   //pings dropped for lack of navigation around them
+    STATS_POINTS_WRITTEN,   //points or cells written
+    STATS_NB_COUNTERS
+};
+
+/*!
+* \brief Process-wide timing and counters, to find which stage of a run is slow
+*
+* Collection is off until enable() is called, typically by parseArguments() when a tool gets --stats: until then,
+* each probe costs a test of a flag. Building with -DMBES_NO_STATS removes the probes altogether.
+*
+* Stage times are exclusive: time spent in a stage nested in another one (raytracing in georeferencing, time
+* conversion in parsing) is only counted once, in the inner stage. Times of threads add up.
+*/
+class Stats {
+public:
+
+    /**Starts collecting, and the wall clock of the run*/
+    static void enable() {
+        getInstance().startTime = now();
+        enabled() = true;
+    }
+
+    /**Stops collecting*/
+    static void disable() {
+        enabled() = false;
+    }
+
+    /**Returns true if statistics are collected*/
+    static bool isEnabled() {
+        return enabled();
+    }
+
+    /**Clears the statistics, and restarts the wall clock*/
+    static void reset() {
+        Stats & stats = getInstance();
+
+        for (unsigned int i = 0; i < STATS_NB_STAGES; i++) {
+            stats.stageTimes[i] = 0;
+            stats.stageCalls[i] = 0;
+        }
+
+        for (unsigned int i = 0; i < STATS_NB_COUNTERS; i++) {
+            stats.counters[i] = 0;
+        }
+
+        std::lock_guard<std::mutex> lock(stats.mutex);
+        stats.datagrams.clear();
+        stats.startTime = now();
+    }
+
+    /**
+    * Adds to a counter
+    *
+    * @param counter the counter
+    * @param n the amount added
+    */
+    static void count(StatsCounter counter, uint64_t n = 1) {
+        getInstance().counters[counter].fetch_add(n, std::memory_order_relaxed);
+    }
+
+    /**
+    * Counts a datagram by its type
+    *
+    * @param parser the parser of the datagram, which names its type the first time it is seen
+    * @param tag the type of the datagram
+    */
+    template<typename Parser>
+    static void countDatagram(Parser & parser, int tag) {
+        Stats & stats = getInstance();
+        stats.counters[STATS_DATAGRAMS].fetch_add(1, std::memory_order_relaxed);
+
+        std::lock_guard<std::mutex> lock(stats.mutex);
+        std::map<int, DatagramCount>::iterator i = stats.datagrams.find(tag);
+
+        if (i == stats.datagrams.end()) {
+            DatagramCount datagramCount;
+            datagramCount.name = parser.getName(tag);
+            datagramCount.count = 1;
+            stats.datagrams[tag] = datagramCount;
+        } else {
+            i->second.count++;
+        }
+    }
+
+    /**
+    * Adds time to a stage
+    *
+    * @param stage the stage
+    * @param nanoseconds the time spent in the stage
+    */
+    static void addTime(StatsStage stage, uint64_t nanoseconds) {
+        Stats & stats = getInstance();
+        stats.stageTimes[stage].fetch_add(nanoseconds, std::memory_order_relaxed);
+        stats.stageCalls[stage].fetch_add(1, std::memory_order_relaxed);
+    }
+
+    /**Returns the time spent in a stage (seconds)*/
+    static double getTime(StatsStage stage) {
+        return getInstance().stageTimes[stage] / 1e9;
+    }
+
+    /**Returns the number of times a stage was entered*/
+    static uint64_t getCalls(StatsStage stage) {
+        return getInstance().stageCalls[stage];
+    }
+
+    /**Returns the value of a counter*/
+    static uint64_t getCount(StatsCounter counter) {
+        return getInstance().counters[counter];
+    }
+
+    /**Returns the number of datagrams of a type*/
+    static uint64_t getDatagramCount(int tag) {
+        Stats & stats = getInstance();
+        std::lock_guard<std::mutex> lock(stats.mutex);
+        std::map<int, DatagramCount>::iterator i = stats.datagrams.find(tag);
+
+        return (i == stats.datagrams.end()) ? 0 : i->second.count;
+    }
+
+    /**Returns the time elapsed since enable() or reset() (seconds)*/
+    static double getWallTime() {
+        return (now() - getInstance().startTime) / 1e9;
+    }
+
+    /**Returns the current time of the monotonic clock (nanoseconds)*/
+    static uint64_t now() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    /**Returns the name of a stage*/
+    static const char * getName(StatsStage stage) {
+        static const char * names[STATS_NB_STAGES] = {"parsing", "time conversion", "interpolation", "svp selection", "georeferencing", "raytracing", "output"};
+        return names[stage];
+    }
+
+    /**Returns the name of a counter*/
+    static const char * getName(StatsCounter counter) {
+        static const char * names[STATS_NB_COUNTERS] = {"bytes read", "bytes skipped", "datagrams", "pings", "rejected pings", "points written"};
+        return names[counter];
+    }
+
+    /**
+    * Writes a summary for a person to read
+    *
+    * @param out the output
+    */
+    static void print(std::ostream & out) {
+        Stats & stats = getInstance();
+        double wallTime = getWallTime();
+        double stagesTime = 0;
+
+        out << "[+] Statistics" << std::endl;
+        out << std::fixed << std::setprecision(3);
+
+        for (unsigned int i = 0; i < STATS_NB_STAGES; i++) {
+            double time = getTime((StatsStage) i);
+            stagesTime += time;
+
+            out << "    " << std::left << std::setw(16) << getName((StatsStage) i) << std::right << std::setw(10) << time << " s"
+                    << std::setw(12) << getCalls((StatsStage) i) << " calls" << std::endl;
+        }
+
+        out << "    " << std::left << std::setw(16) << "other" << std::right << std::setw(10) << std::max(0.0, wallTime - stagesTime) << " s" << std::endl;
+        out << "    " << std::left << std::setw(16) << "wall time" << std::right << std::setw(10) << wallTime << " s" << std::endl;
+
+        for (unsigned int i = 0; i < STATS_NB_COUNTERS; i++) {
+            out << "    " << std::left << std::setw(16) << getName((StatsCounter) i) << std::right << std::setw(12) << getCount((StatsCounter) i) << std::endl;
+        }
+
+        std::lock_guard<std::mutex> lock(stats.mutex);
+
+        for (std::map<int, DatagramCount>::iterator i = stats.datagrams.begin(); i != stats.datagrams.end(); i++) {
+            out << "    datagram " << std::left << std::setw(7) << i->first << std::right << std::setw(12) << i->second.count << "  " << i->second.name << std::endl;
+        }
+
+        out.unsetf(std::ios_base::floatfield);
+        out << std::setprecision(6);
+    }
+
+    /**
+    * Writes the statistics as a JSON object
+    *
+    * @param out the output
+    */
+    static void writeJson(std::ostream & out) {
+        Stats & stats = getInstance();
+        std::ostringstream json;
+        json << std::setprecision(9);
+
+        json << "{\n  \"wallTime\": " << getWallTime() << ",\n  \"stages\": {";
+
+        for (unsigned int i = 0; i < STATS_NB_STAGES; i++) {
+            json << ((i > 0) ? "," : "") << "\n    \"" << getName((StatsStage) i) << "\": {\"time\": " << getTime((StatsStage) i)
+                    << ", \"calls\": " << getCalls((StatsStage) i) << "}";
+        }
+
+        json << "\n  },\n  \"counters\": {";
+
+        for (unsigned int i = 0; i < STATS_NB_COUNTERS; i++) {
+            json << ((i > 0) ? "," : "") << "\n    \"" << getName((StatsCounter) i) << "\": " << getCount((StatsCounter) i);
+        }
+
+        json << "\n  },\n  \"datagrams\": [";
+
+        {
+            std::lock_guard<std::mutex> lock(stats.mutex);
+
+            for (std::map<int, DatagramCount>::iterator i = stats.datagrams.begin(); i != stats.datagrams.end(); i++) {
+                json << ((i != stats.datagrams.begin()) ? "," : "") << "\n    {\"tag\": " << i->first << ", \"name\": \"" << escape(i->second.name)
+                        << "\", \"count\": " << i->second.count << "}";
+            }
+        }
+
+        json << "\n  ]\n}\n";
+
+        out << json.str();
+    }
+
+    /**
+    * Takes --stats or --stats=file.json out of the arguments of a tool. If it is there, enables the statistics and
+    * reports them when the tool exits: as a summary on std::cerr, or as JSON in the file
+    *
+    * @param argc the number of arguments, decreased if the option is taken out
+    * @param argv the arguments
+    * @return true if the option was there
+    */
+    static bool parseArguments(int & argc, char ** argv) {
+        bool found = false;
+        int kept = 1;
+
+        for (int i = 1; i < argc; i++) {
+            if (strcmp(argv[i], "--stats") == 0) {
+                found = true;
+            } else if (strncmp(argv[i], "--stats=", 8) == 0) {
+                found = true;
+                getInstance().jsonFilename = argv[i] + 8;
+            } else {
+                argv[kept++] = argv[i];
+            }
+        }
+
+        argc = kept;
+        argv[argc] = NULL;
+
+        if (found) {
+#ifdef MBES_NO_STATS
+            std::cerr << "[-] Statistics were left out of this build (MBES_NO_STATS)" << std::endl;
+#else
+            enable();
+            atexit(&Stats::report);
+#endif
+        }
+
+        return found;
+    }
+
+    /**Reports the statistics where parseArguments() was asked to*/
+    static void report() {
+        std::string & filename = getInstance().jsonFilename;
+
+        if (filename.empty()) {
+            print(std::cerr);
+            return;
+        }
+
+        std::ofstream out(filename.c_str());
+
+        if (out) {
+            writeJson(out);
+        } else {
+            std::cerr << "[-] Couldn't write statistics to " << filename << std::endl;
+        }
+    }
+
+private:
+
+    /**Count of a type of datagram*/
+    typedef struct {
+        std::string name;
+        uint64_t count;
+    } DatagramCount;
+
+    /**Creates empty statistics*/
+    Stats() : startTime(now()) {
+        for (unsigned int i = 0; i < STATS_NB_STAGES; i++) {
+            stageTimes[i] = 0;
+            stageCalls[i] = 0;
+        }
+
+        for (unsigned int i = 0; i < STATS_NB_COUNTERS; i++) {
+            counters[i] = 0;
+        }
+    }
+
+    /**Returns the statistics of the process*/
+    static Stats & getInstance() {
+        static Stats stats;
+        return stats;
+    }
+
+    /**Returns the flag telling if statistics are collected*/
+    static bool & enabled() {
+        static bool flag = false;
+        return flag;
+    }
+
+    /**Escapes a string for JSON*/
+    static std::string escape(const std::string & s) {
+        std::string escaped;
+
+        for (unsigned int i = 0; i < s.size(); i++) {
+            if (s[i] == '"' || s[i] == '\\') {
+                escaped += '\\';
+            }
+
+            escaped += s[i];
+        }
+
+        return escaped;
+    }
+
+    /**time spent in each stage (nanoseconds)*/
+    std::atomic<uint64_t> stageTimes[STATS_NB_STAGES];
+
+    /**number of times each stage was entered*/
+    std::atomic<uint64_t> stageCalls[STATS_NB_STAGES];
+
+    /**the counters*/
+    std::atomic<uint64_t> counters[STATS_NB_COUNTERS];
+
+    /**count of each type of datagram, by tag*/
+    std::map<int, DatagramCount> datagrams;
+
+    /**guards the datagram counts*/
+    std::mutex mutex;
+
+    /**start of the wall clock (nanoseconds)*/
+    uint64_t startTime;
+
+    /**file the statistics are written to as JSON, empty for a summary on std::cerr*/
+    std::string jsonFilename;
+};
+
+/*!
+* \brief Times a stage from its construction to its destruction, when statistics are collected
+*
+* Timers of a thread nest: the time of an inner timer is taken out of the time of the outer one.
+*/
+class StatsTimer {
+public:
+
+    /**
+    * Starts timing a stage
+    *
+    * @param stage the stage
+    */
+    StatsTimer(StatsStage stage) : stage(stage), active(Stats::isEnabled()), childrenTime(0) {
+        if (active) {
+            parent = current();
+            current() = this;
+            start = Stats::now();
+        }
+    }
+
+    /**Stops timing the stage*/
+    ~StatsTimer() {
+        if (active) {
+            uint64_t elapsed = Stats::now() - start;
+            Stats::addTime(stage, elapsed - childrenTime);
+
+            if (parent) {
+                parent->childrenTime += elapsed;
+            }
+
+            current() = parent;
+        }
+    }
+
+private:
+
+    /**Returns the innermost timer of the thread*/
+    static StatsTimer *& current() {
+        static thread_local StatsTimer * timer = NULL;
+        return timer;
+    }
+
+    /**the stage*/
+    StatsStage stage;
+
+    /**true if statistics were collected when the timer started*/
+    bool active;
+
+    /**time of the timers nested in this one (nanoseconds)*/
+    uint64_t childrenTime;
+
+    /**start of the stage (nanoseconds)*/
+    uint64_t start;
+
+    /**the timer this one is nested in*/
+    StatsTimer * parent;
+};
+
+#define STATS_CONCATENATE_(a, b) a##b
+#define STATS_CONCATENATE(a, b) STATS_CONCATENATE_(a, b)
+
+#ifdef MBES_NO_STATS
+#define STATS_STAGE(stage)
+#define STATS_COUNT(counter, n)
+#define STATS_DATAGRAM(parser, tag)
+#else
+/**Times the rest of the enclosing block as a stage*/
+#define STATS_STAGE(stage) StatsTimer STATS_CONCATENATE(statsTimer, __LINE__)(stage)
+/**Adds to a counter*/
+#define STATS_COUNT(counter, n) do { if (Stats::isEnabled()) Stats::count(counter, n); } while (0)
+/**Counts a datagram by its type*/
+#define STATS_DATAGRAM(parser, tag) do { if (Stats::isEnabled()) Stats::countDatagram(parser, tag); } while (0)
+#endif
+
+#endif /* STATS_HPP */
@@ -0,0 +1,147 @@
+/*
+* Copyright 2020 © Centre Interdisciplinaire de développement en Cartographie des Océans (CIDCO), Tous droits réservés
+*/
+
+#ifndef TIMESERIES_HPP
+#define TIMESERIES_HPP
+
+#include <cstdint>
+#include <vector>
+#include <algorithm>
+#include "TimestampSort.hpp"
+
+/*!
+* \brief Samples sorted by timestamp, such as positions or attitudes, with lookups by time
+*
+* A sample type only needs a getTimestamp() method. Lookups give the index of the last sample before a
+* timestamp, the first sample of the pair to interpolate between. seek() keeps a cursor, so increasing
+* timestamps cost O(1) amortised, and falls back to a binary search when the timestamp goes backward or
+* jumps far ahead. find() always does a binary search and leaves the cursor alone.
+*/
+template<typename T>
+class TimeSeries {
+public:
+
+    /**Creates an empty time series*/
+    TimeSeries() : cursor(0) {
+    }
+
+    /**
+    * Adds a sample. The series must be sorted before lookups if samples are not added in timestamp order
+    *
+    * @param sample the sample
+    */
+    void push_back(const T & sample) {
+        samples.push_back(sample);
+    }
+
+    /**Sorts the samples by timestamp, keeping the order of samples with the same timestamp*/
+    void sort() {
+        TimestampSort::sort(samples);
+
+        cursor = 0;
+    }
+
+    /**Returns the number of samples*/
+    unsigned int size() const {
+        return samples.size();
+    }
+
+    /**Returns true if there is no sample*/
+    bool empty() const {
+        return samples.empty();
+    }
+
+    /**Returns a sample*/
+    T & operator[](unsigned int index) {
+        return samples[index];
+    }
+
+    /**Returns the timestamp of a sample*/
+    uint64_t getTimestamp(unsigned int index) {
+        return samples[index].getTimestamp();
+    }
+
+    typename std::vector<T>::iterator begin() {
+        return samples.begin();
+    }
+
+    typename std::vector<T>::iterator end() {
+        return samples.end();
+    }
+
+    /**Returns the samples*/
+    std::vector<T> & getSamples() {
+        return samples;
+    }
+
+    /**
+    * Returns the index of the last sample before a timestamp, 0 if there is none, moving the cursor
+    *
+    * @param timestamp time in microsecond since 1st January 1970
+    */
+    unsigned int seek(uint64_t timestamp) {
+        if (cursor >= samples.size() || (cursor > 0 && samples[cursor].getTimestamp() >= timestamp)) {
+            cursor = find(timestamp);
+            return cursor;
+        }
+
+        for (unsigned int steps = 0; cursor + 1 < samples.size() && samples[cursor + 1].getTimestamp() < timestamp; steps++) {
+            if (steps == maxCursorSteps) {
+                cursor = find(timestamp);
+                break;
+            }
+
+            cursor++;
+        }
+
+        return cursor;
+    }
+
+    /**
+    * Returns the index of the last sample before a timestamp, 0 if there is none, by binary search
+    *
+    * @param timestamp time in microsecond since 1st January 1970
+    */
+    unsigned int find(uint64_t timestamp) {
+        typename std::vector<T>::iterator first = std::lower_bound(samples.begin(), samples.end(), timestamp, [](T & sample, uint64_t t) {
+            return sample.getTimestamp() < t;
+        });
+
+        return (first == samples.begin()) ? 0 : (first - samples.begin()) - 1;
+    }
+
+    /**
+    * Finds the two samples around a timestamp, moving the cursor
+    *
+    * @param timestamp time in microsecond since 1st January 1970
+    * @param before receives the last sample before the timestamp
+    * @param after receives the sample after it
+    * @return false if the timestamp is before the first sample or after the last one
+    */
+    bool getBracket(uint64_t timestamp, T * & before, T * & after) {
+        unsigned int index = seek(timestamp);
+
+        if (index + 1 >= samples.size() || samples[index].getTimestamp() > timestamp) {
+            return false;
+        }
+
+        before = &samples[index];
+        after = &samples[index + 1];
+
+        return true;
+    }
+
+private:
+
+    /**Number of samples the cursor walks over before a binary search*/
+    static const unsigned int maxCursorSteps = 8;
+
+    /**Samples*/
+    std::vector<T> samples;
+
+    /**Index returned by the last seek*/
+    unsigned int cursor;
+};
+
+#endif /* TIMESERIES_HPP */
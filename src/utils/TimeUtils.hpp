@@ -13,6 +13,7 @@
 #include <iomanip>
 #include <sstream>
 #include "Exception.hpp"
+#include "Stats.hpp"
 
 #ifdef _WIN32
 #define timegm _mkgmtime
@@ -41,6 +42,8 @@ public:
      * @param microseconds number of microseconds
      */
     static uint64_t build_time(int year, int month, int day, int hour, int minutes, int seconds, int millis, int microseconds) {
+        STATS_STAGE(STATS_TIME_CONVERSION);
+
         struct tm t;
 
         t.tm_year = year - 1900;
@@ -66,7 +69,8 @@ public:
      * @param timeInMilliseconds number of millisecond less than an day
      */
     static uint64_t build_time(int year, int month, int day, uint32_t timeInMilliseconds) {
-        
+        STATS_STAGE(STATS_TIME_CONVERSION);
+
         struct std::tm tm = {0};
         std::stringstream ssDate = convertDateTimeInfo2Stringstream(year, month, day, 0, 0, 0);
         ssDate >> std::get_time(&tm, "%Y-%m-%d %H:%M:%S");
@@ -89,7 +93,8 @@ public:
      * @param timeMicroseconds number of microsecond less than an minute
      */
     static uint64_t build_time(int year, int yday, int hour, int minutes, long timeInMicroSeconds) {
-        
+        STATS_STAGE(STATS_TIME_CONVERSION);
+
         int resultMonth, resultDayOfMonth;
         convertDayOfYear2YearMonthDay(year, yday, resultMonth, resultDayOfMonth);
         
@@ -0,0 +1,236 @@
+/*
+ * Copyright 2020 © Centre Interdisciplinaire de développement en Cartographie des Océans (CIDCO), Tous droits réservés
+ */
+
+#ifndef TIMESTAMPSORT_HPP
+#define TIMESTAMPSORT_HPP
+
+#include <cstdint>
+#include <vector>
+#include <utility>
+#include <algorithm>
+
+/*!
+ * \brief Stable sort of pings, positions or attitudes by timestamp
+ *
+ * Datagrams mostly come in time order, so the sorted runs of the timestamps are found first: a sorted
+ * vector is left alone and a few runs are merged. Otherwise the timestamps are sorted with an LSD radix
+ * sort of the time since the first timestamp, skipping the digits all timestamps share. Either way, only the (timestamp, index) pairs move while
+ * sorting, and each sample is then moved once to its place.
+ */
+class TimestampSort {
+public:
+
+    /**
+     * Sorts samples by timestamp, keeping the order of samples with the same timestamp
+     *
+     * @param samples the samples, of a type with a getTimestamp() method
+     */
+    template<typename T>
+    static void sort(std::vector<T> & samples) {
+        std::vector<unsigned int> order;
+
+        if (getOrder(getTimestamps(samples), order)) {
+            reorder(samples, order);
+        }
+    }
+
+    /**
+     * Sorts samples by timestamp, then samples with the same timestamp with a comparator
+     *
+     * @param samples the samples, of a type with a getTimestamp() method
+     * @param isBefore comparator of the samples, ordering them by timestamp first, such as Ping::sortByTimestamp
+     */
+    template<typename T, typename Comparator>
+    static void sort(std::vector<T> & samples, Comparator isBefore) {
+        std::vector<uint64_t> timestamps = getTimestamps(samples);
+        std::vector<unsigned int> order;
+        bool sorted = !getOrder(timestamps, order);
+
+        if (sorted) {
+            order.resize(samples.size());
+
+            for (unsigned int i = 0; i < order.size(); i++) {
+                order[i] = i;
+            }
+        }
+
+        auto isIndexBefore = [&samples, &isBefore](unsigned int i1, unsigned int i2) {
+            return isBefore(samples[i1], samples[i2]);
+        };
+
+        //only the samples sharing a timestamp need the comparator
+        for (unsigned int first = 0; first < order.size();) {
+            unsigned int last = first + 1;
+
+            while (last < order.size() && timestamps[order[last]] == timestamps[order[first]]) {
+                last++;
+            }
+
+            if (last - first > 1 && !std::is_sorted(order.begin() + first, order.begin() + last, isIndexBefore)) {
+                std::stable_sort(order.begin() + first, order.begin() + last, isIndexBefore);
+                sorted = false;
+            }
+
+            first = last;
+        }
+
+        if (!sorted) {
+            reorder(samples, order);
+        }
+    }
+
+    /**
+     * Computes the stable sorted order of timestamps
+     *
+     * @param timestamps the timestamps
+     * @param order receives the index of the timestamps, in sorted order
+     * @return false if the timestamps are already sorted, order is then left empty
+     */
+    static bool getOrder(const std::vector<uint64_t> & timestamps, std::vector<unsigned int> & order) {
+        order.clear();
+
+        //start of each sorted run, until there are too many to merge
+        std::vector<unsigned int> runs(1, 0);
+
+        for (unsigned int i = 1; i < timestamps.size() && runs.size() <= maxMergedRuns; i++) {
+            if (timestamps[i] < timestamps[i - 1]) {
+                runs.push_back(i);
+            }
+        }
+
+        if (runs.size() == 1) {
+            return false;
+        }
+
+        std::vector<Entry> entries(timestamps.size());
+
+        for (unsigned int i = 0; i < timestamps.size(); i++) {
+            entries[i] = Entry(timestamps[i], i);
+        }
+
+        if (runs.size() <= maxMergedRuns) {
+            mergeRuns(entries, runs);
+        }
+        else {
+            radixSort(entries);
+        }
+
+        order.resize(entries.size());
+
+        for (unsigned int i = 0; i < entries.size(); i++) {
+            order[i] = entries[i].second;
+        }
+
+        return true;
+    }
+
+private:
+
+    /**Returns the timestamps of samples*/
+    template<typename T>
+    static std::vector<uint64_t> getTimestamps(std::vector<T> & samples) {
+        std::vector<uint64_t> timestamps(samples.size());
+
+        for (unsigned int i = 0; i < samples.size(); i++) {
+            timestamps[i] = samples[i].getTimestamp();
+        }
+
+        return timestamps;
+    }
+
+    /**Moves each sample once, to its place in a sorted order*/
+    template<typename T>
+    static void reorder(std::vector<T> & samples, const std::vector<unsigned int> & order) {
+        std::vector<T> sorted;
+        sorted.reserve(samples.size());
+
+        for (unsigned int i = 0; i < order.size(); i++) {
+            sorted.push_back(std::move(samples[order[i]]));
+        }
+
+        samples.swap(sorted);
+    }
+
+    /**Timestamp and index of a sample*/
+    typedef std::pair<uint64_t, unsigned int> Entry;
+
+    /**Most sorted runs merged, more runs are radix sorted*/
+    static const unsigned int maxMergedRuns = 16;
+
+    /**Returns true if the timestamp of e1 is smaller, so merges keep the order of equal timestamps*/
+    static bool isEarlier(const Entry & e1, const Entry & e2) {
+        return e1.first < e2.first;
+    }
+
+    /**Merges sorted runs, given by their first entry, two by two until one is left*/
+    static void mergeRuns(std::vector<Entry> & entries, std::vector<unsigned int> runs) {
+        std::vector<Entry> merged(entries.size());
+        runs.push_back(entries.size());
+
+        while (runs.size() > 2) {
+            std::vector<unsigned int> mergedRuns;
+
+            //the last run is copied alone when the number of runs is odd
+            for (unsigned int r = 0; r + 1 < runs.size(); r += 2) {
+                unsigned int middle = runs[r + 1];
+                unsigned int last = (r + 2 < runs.size()) ? runs[r + 2] : middle;
+
+                std::merge(entries.begin() + runs[r], entries.begin() + middle, entries.begin() + middle, entries.begin() + last, merged.begin() + runs[r], &isEarlier);
+                mergedRuns.push_back(runs[r]);
+            }
+
+            mergedRuns.push_back(entries.size());
+            runs.swap(mergedRuns);
+            entries.swap(merged);
+        }
+    }
+
+    /**LSD radix sort on 11 bit digits of the time since the first timestamp, skipping the digits where all timestamps are the same*/
+    static void radixSort(std::vector<Entry> & entries) {
+        const unsigned int digitBits = 11;
+        const unsigned int nbBuckets = 1 << digitBits;
+
+        uint64_t first = entries[0].first;
+        uint64_t span = 0;
+
+        for (auto i = entries.begin(); i != entries.end(); i++) {
+            first = std::min(first, i->first);
+        }
+
+        for (auto i = entries.begin(); i != entries.end(); i++) {
+            span |= i->first - first;
+        }
+
+        std::vector<Entry> sorted(entries.size());
+        std::vector<unsigned int> count(nbBuckets);
+
+        for (unsigned int shift = 0; shift < 64 && (span >> shift) != 0; shift += digitBits) {
+            std::fill(count.begin(), count.end(), 0);
+
+            for (auto i = entries.begin(); i != entries.end(); i++) {
+                count[((i->first - first) >> shift) & (nbBuckets - 1)]++;
+            }
+
+            if (std::count(count.begin(), count.end(), (unsigned int) entries.size()) == 1) {
+                continue;
+            }
+
+            unsigned int offset = 0;
+
+            for (unsigned int digit = 0; digit < nbBuckets; digit++) {
+                unsigned int digitCount = count[digit];
+                count[digit] = offset;
+                offset += digitCount;
+            }
+
+            for (auto i = entries.begin(); i != entries.end(); i++) {
+                sorted[count[((i->first - first) >> shift) & (nbBuckets - 1)]++] = *i;
+            }
+
+            entries.swap(sorted);
+        }
+    }
+};
+
+#endif /* TIMESTAMPSORT_HPP */
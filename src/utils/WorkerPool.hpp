@@ -0,0 +1,165 @@
+/*
+* Copyright 2020 © Centre Interdisciplinaire de développement en Cartographie des Océans (CIDCO), Tous droits réservés
+*/
+
+#ifndef WORKERPOOL_HPP
+#define WORKERPOOL_HPP
+
+#include <cstdint>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <algorithm>
+
+/*!
+* \brief Threads kept alive between parallel jobs
+*
+* run() hands a job to the pool and waits for it: share i of the job runs on thread i, the calling thread
+* taking share 0. Engines that process a stream batch after batch thus start their threads once instead of
+* once per batch.
+*
+* A pool runs one job at a time and must be driven by a single thread.
+*/
+class WorkerPool {
+public:
+
+    /**
+    * Starts the threads
+    *
+    * @param nbThreads number of threads, the calling thread included. 0 to use every core
+    */
+    WorkerPool(unsigned int nbThreads) : nbThreads(nbThreads > 0 ? nbThreads : std::max(1u, std::thread::hardware_concurrency())), job(NULL), nbShares(0), nbPending(0), generation(0), stopping(false) {
+        for (unsigned int i = 1; i < this->nbThreads; i++) {
+            threads.push_back(std::thread(&WorkerPool::work, this, i));
+        }
+    }
+
+    /**Stops the threads*/
+    ~WorkerPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+
+        started.notify_all();
+
+        for (auto i = threads.begin(); i != threads.end(); i++) {
+            i->join();
+        }
+    }
+
+    /**Returns the number of threads, the calling thread included*/
+    unsigned int getNumberOfThreads() {
+        return nbThreads;
+    }
+
+    /**
+    * Runs a job and waits for all its shares to be done
+    *
+    * @param nbShares number of shares, at most the number of threads
+    * @param share the job, called with the index of each share
+    */
+    void run(unsigned int nbShares, const std::function<void(unsigned int)> & share) {
+        if (nbShares > nbThreads) {
+            nbShares = nbThreads;
+        }
+
+        if (nbShares == 0) {
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            job = &share;
+            this->nbShares = nbShares;
+            nbPending = nbShares - 1;
+            generation++;
+        }
+
+        if (nbShares > 1) {
+            started.notify_all();
+        }
+
+        share(0);
+
+        std::unique_lock<std::mutex> lock(mutex);
+        finished.wait(lock, [this]() {
+            return nbPending == 0;
+        });
+
+        job = NULL;
+    }
+
+private:
+
+    /**Loop of the thread running share index of each job*/
+    void work(unsigned int index) {
+        uint64_t seen = 0;
+
+        while (true) {
+            const std::function<void(unsigned int)> * share;
+
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                started.wait(lock, [this, seen]() {
+                    return stopping || generation != seen;
+                });
+
+                if (stopping) {
+                    return;
+                }
+
+                seen = generation;
+
+                if (index >= nbShares) {
+                    continue;
+                }
+
+                share = job;
+            }
+
+            (*share)(index);
+
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                nbPending--;
+            }
+
+            finished.notify_one();
+        }
+    }
+
+    /**Number of threads, the calling thread included*/
+    unsigned int nbThreads;
+
+    /**The threads, running shares 1 and up*/
+    std::vector<std::thread> threads;
+
+    /**The job being run*/
+    const std::function<void(unsigned int)> * job;
+
+    /**Number of shares of the job*/
+    unsigned int nbShares;
+
+    /**Number of shares, other than the calling thread's, not done yet*/
+    unsigned int nbPending;
+
+    /**Incremented for each job, so threads tell a new job from the last one*/
+    uint64_t generation;
+
+    /**True when the threads must end*/
+    bool stopping;
+
+    /**Guards the job*/
+    std::mutex mutex;
+
+    /**Signals a new job, or the end*/
+    std::condition_variable started;
+
+    /**Signals the end of a share*/
+    std::condition_variable finished;
+};
+
+#endif /* WORKERPOOL_HPP */
@@ -0,0 +1,97 @@
+/*
+* Copyright 2020 © Centre Interdisciplinaire de développement en Cartographie des Océans (CIDCO), Tous droits réservés
+*/
+
+#ifndef WATERCOLUMNRECORD_HPP
+#define WATERCOLUMNRECORD_HPP
+
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+/*!
+* \brief Water column record, viewed in place in its datagram
+*
+* The header of the record is decoded when the view is built. The samples of a beam are only decoded when
+* getAmplitudes() is called, so a handler looking at a few beams does not pay for the others. The view reads
+* the datagram of the parser: it is only valid during DatagramEventHandler::processWaterColumn().
+*
+* Amplitudes keep the scale of the format: dB for Kongsberg, linear magnitudes for S7k.
+*/
+class WaterColumnRecord {
+public:
+
+    /**Creates an empty record*/
+    WaterColumnRecord() :
+    timestamp(0),
+    pingNumber(0),
+    nbBeams(0),
+    soundSpeed(std::numeric_limits<double>::quiet_NaN()),
+    samplingFrequency(std::numeric_limits<double>::quiet_NaN()) {
+    }
+
+    /**Destroys the record*/
+    virtual ~WaterColumnRecord() {
+    }
+
+    /**Returns the timestamp of the ping (micro-second)*/
+    uint64_t getTimestamp() {
+        return timestamp;
+    }
+
+    /**Returns the ping number*/
+    uint32_t getPingNumber() {
+        return pingNumber;
+    }
+
+    /**Returns the number of beams in the record*/
+    unsigned int getNumberOfBeams() {
+        return nbBeams;
+    }
+
+    /**Returns the sound speed at the transducer (m/s), NaN if unknown*/
+    double getSoundSpeed() {
+        return soundSpeed;
+    }
+
+    /**Returns the sampling frequency (Hz), NaN if unknown*/
+    double getSamplingFrequency() {
+        return samplingFrequency;
+    }
+
+    /**Returns the beam angle (degrees), NaN if the record does not give it*/
+    virtual double getBeamAngle(unsigned int beam) = 0;
+
+    /**Returns the index of the first sample of a beam, counted from transmit time*/
+    virtual unsigned int getFirstSample(unsigned int beam) = 0;
+
+    /**Returns the number of samples of a beam*/
+    virtual unsigned int getNumberOfSamples(unsigned int beam) = 0;
+
+    /**
+    * Decodes the samples of a beam
+    *
+    * @param beam the beam
+    * @param amplitudes receives the amplitudes, resized to the number of samples of the beam
+    */
+    virtual void getAmplitudes(unsigned int beam, std::vector<float> & amplitudes) = 0;
+
+protected:
+
+    /**Timestamp of the ping (micro-second)*/
+    uint64_t timestamp;
+
+    /**Ping number*/
+    uint32_t pingNumber;
+
+    /**Number of beams in the record*/
+    unsigned int nbBeams;
+
+    /**Sound speed at the transducer (m/s)*/
+    double soundSpeed;
+
+    /**Sampling frequency (Hz)*/
+    double samplingFrequency;
+};
+
+#endif /* WATERCOLUMNRECORD_HPP */
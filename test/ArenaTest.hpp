@@ -0,0 +1,108 @@
+/*
+ * Copyright 2020 © Centre Interdisciplinaire de développement en Cartographie des Océans (CIDCO), Tous droits réservés
+ */
+
+/*
+ * File:   ArenaTest.hpp
+ */
+
+#ifndef ARENATEST_HPP
+#define ARENATEST_HPP
+
+#include "catch.hpp"
+#include <vector>
+#include "../src/utils/Arena.hpp"
+#include "../src/datagrams/DatagramEventHandler.hpp"
+#include "../src/datagrams/xtf/XtfParser.hpp"
+
+TEST_CASE("Arena allocations are aligned and memory is reused after a reset") {
+    Arena arena(1024);
+
+    void * first = arena.allocate(3, 1);
+    double * d = (double*) arena.allocate(sizeof (double), alignof(double));
+
+    REQUIRE(((uintptr_t) d % alignof(double)) == 0);
+    REQUIRE(arena.getNumberOfSlabs() == 1);
+
+    arena.reset();
+
+    REQUIRE(arena.getBytesUsed() == 0);
+    REQUIRE(arena.getCapacity() == 1024);
+    REQUIRE(arena.allocate(3, 1) == first);
+
+    //Larger than a slab: gets its own
+    arena.allocate(4096);
+    REQUIRE(arena.getNumberOfSlabs() == 2);
+    REQUIRE(arena.getCapacity() >= 1024 + 4096);
+
+    arena.release();
+    REQUIRE(arena.getNumberOfSlabs() == 0);
+}
+
+TEST_CASE("Arena destroys its objects in reverse order on reset") {
+    static std::vector<int> destroyed;
+
+    class Tracked {
+    public:
+        Tracked(int id) : id(id) {}
+        ~Tracked() { destroyed.push_back(id); }
+        int id;
+    };
+
+    destroyed.clear();
+
+    Arena arena;
+    Tracked * a = arena.create<Tracked>(1);
+    Tracked * b = arena.create<Tracked>(2);
+
+    REQUIRE(a->id == 1);
+    REQUIRE(b->id == 2);
+    REQUIRE(destroyed.size() == 0);
+
+    arena.reset();
+
+    REQUIRE(destroyed.size() == 2);
+    REQUIRE(destroyed[0] == 2);
+    REQUIRE(destroyed[1] == 1);
+}
+
+TEST_CASE("XTF sidescan pings carved from an arena") {
+
+    class SidescanCounter : public DatagramEventHandler {
+    public:
+        void processSidescanData(SidescanPing * ping) {
+            nbPings++;
+            nbSamples += ping->getNumberOfSamples();
+
+            if (arena) {
+                arena->reset();
+            } else {
+                delete ping;
+            }
+        }
+
+        unsigned int nbPings = 0;
+        unsigned long nbSamples = 0;
+    };
+
+    std::string file("test/data/xtf/Line-001-0856.sidescan.xtf");
+
+    SidescanCounter heapHandler;
+    XtfParser heapParser(heapHandler);
+    heapParser.parse(file);
+
+    Arena arena;
+    SidescanCounter arenaHandler;
+    arenaHandler.setArena(&arena);
+    XtfParser arenaParser(arenaHandler);
+    arenaParser.parse(file);
+
+    REQUIRE(heapHandler.nbPings > 0);
+    REQUIRE(arenaHandler.nbPings == heapHandler.nbPings);
+    REQUIRE(arenaHandler.nbSamples == heapHandler.nbSamples);
+
+    //Every ping was recycled into the same slab
+    REQUIRE(arena.getNumberOfSlabs() == 1);
+}
+
+#endif /* ARENATEST_HPP */
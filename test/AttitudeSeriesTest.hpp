@@ -0,0 +1,91 @@
+/*
+ * Copyright 2020 © Centre Interdisciplinaire de développement en Cartographie des Océans (CIDCO), Tous droits réservés
+ */
+
+/*
+ * File:   AttitudeSeriesTest.hpp
+ */
+
+#ifndef ATTITUDESERIESTEST_HPP
+#define ATTITUDESERIESTEST_HPP
+
+#include "catch.hpp"
+#include <vector>
+#include <Eigen/Dense>
+#include "../src/Attitude.hpp"
+#include "../src/math/AttitudeSeries.hpp"
+#include "../src/math/CoordinateTransform.hpp"
+
+TEST_CASE("Attitude series gives the rotation of each attitude") {
+    std::vector<Attitude> attitudes;
+    attitudes.push_back(Attitude(0, 3, -2, 10));
+    attitudes.push_back(Attitude(100, -45, 30, 359));
+    attitudes.push_back(Attitude(200, 170, -89, 181));
+
+    AttitudeSeries series;
+    series.add(attitudes);
+    REQUIRE(series.size() == 3);
+
+    for (unsigned int i = 0; i < attitudes.size(); i++) {
+        Eigen::Matrix3d expected, imu2ned;
+        CoordinateTransform::getDCM(expected, attitudes[i]);
+
+        series.getImu2Ned(imu2ned, i, attitudes[i].getTimestamp());
+        REQUIRE(imu2ned.isApprox(expected, 1e-12));
+
+        //the same lookup comes from the cache
+        series.getImu2Ned(imu2ned, i, attitudes[i].getTimestamp());
+        REQUIRE(imu2ned.isApprox(expected, 1e-12));
+
+        REQUIRE(series.getImu2Ned(imu2ned, attitudes[i].getTimestamp()));
+        REQUIRE(imu2ned.isApprox(expected, 1e-12));
+    }
+
+    Eigen::Matrix3d imu2ned;
+    REQUIRE_FALSE(series.getImu2Ned(imu2ned, 201));
+}
+
+TEST_CASE("Attitude series interpolates along the shortest arc") {
+    bool slerp[] = {false, true};
+
+    for (unsigned int s = 0; s < 2; s++) {
+        //heading through north
+        AttitudeSeries series(slerp[s]);
+        Attitude before(0, 0, 0, 350);
+        Attitude after(100, 0, 0, 20);
+        series.add(before);
+        series.add(after);
+
+        Eigen::Matrix3d imu2ned, expected;
+        Attitude halfway(50, 0, 0, 5);
+        CoordinateTransform::getDCM(expected, halfway);
+
+        REQUIRE(series.getImu2Ned(imu2ned, 50));
+        REQUIRE(imu2ned.isApprox(expected, 1e-12));
+
+        //a small roll and pitch change is interpolated close to the angles, within a hundredth of a degree
+        AttitudeSeries rolling(slerp[s]);
+        Attitude r1(0, 1, -1, 90);
+        Attitude r2(100, 3, 1, 90);
+        rolling.add(r1);
+        rolling.add(r2);
+
+        Attitude r(25, 1.5, -0.5, 90);
+        CoordinateTransform::getDCM(expected, r);
+        rolling.getImu2Ned(imu2ned, 0, 25);
+        REQUIRE(imu2ned.isApprox(expected, 1e-3));
+
+        //headings 180 degrees apart are not ambiguous with quaternions, and the rotation stays orthonormal
+        AttitudeSeries turning(slerp[s]);
+        Attitude t1(0, 0, 0, 0);
+        Attitude t2(100, 0, 0, 180);
+        turning.add(t1);
+        turning.add(t2);
+
+        turning.getImu2Ned(imu2ned, 0, 30);
+        REQUIRE((imu2ned * imu2ned.transpose()).isApprox(Eigen::Matrix3d::Identity(), 1e-12));
+        REQUIRE(imu2ned.determinant() == Approx(1));
+    }
+}
+
+#endif /* ATTITUDESERIESTEST_HPP */
@@ -12,6 +12,8 @@
 
 #include "catch.hpp"
 #include <Eigen/Dense>
+#include <vector>
+#include <cstdlib>
 #include "../src/Position.hpp"
 #include "../src/math/CartesianToGeodeticFukushima.hpp"
 #include "../src/math/CoordinateTransform.hpp"
@@ -237,5 +239,47 @@ TEST_CASE("test the ecef conversion to longitude latitude elevation")
     REQUIRE(abs(result.getEllipsoidalHeight()-(1-(a_wgs84*(std::sqrt(1-e2_wgs84)))))<1e-10);
 }
 
+TEST_CASE("Batch ecef conversion matches the conversion of each position")
+{
+    CartesianToGeodeticFukushima converter(2);
+    std::vector<double> x, y, z;
+
+    //more than a block of positions, all around the Earth, from the center to orbit
+    srand(42);
+
+    for (unsigned int i = 0; i < 1000; i++) {
+        Position p(0, (double) rand() / RAND_MAX * 180 - 90, (double) rand() / RAND_MAX * 360 - 180, (double) rand() / RAND_MAX * 20000 - 10000);
+        Eigen::Vector3d ecef;
+        CoordinateTransform::getPositionECEF(ecef, p);
+        x.push_back(ecef(0));
+        y.push_back(ecef(1));
+        z.push_back(ecef(2));
+    }
+
+    //center of the Earth, poles and equator
+    double specialX[] = {0, 0, 0, 6378137, -100, 0};
+    double specialY[] = {0, 0, 0, 0, 6378000, 0};
+    double specialZ[] = {0, 6356752, -6356000, 0, 0, 1};
+
+    for (unsigned int i = 0; i < 6; i++) {
+        x.insert(x.begin() + i * 150, specialX[i]);
+        y.insert(y.begin() + i * 150, specialY[i]);
+        z.insert(z.begin() + i * 150, specialZ[i]);
+    }
+
+    std::vector<double> longitudes(x.size()), latitudes(x.size()), heights(x.size());
+    converter.ecefToLongitudeLatitudeElevation(&x[0], &y[0], &z[0], x.size(), &longitudes[0], &latitudes[0], &heights[0]);
+
+    for (unsigned int i = 0; i < x.size(); i++) {
+        Eigen::Vector3d ecef(x[i], y[i], z[i]);
+        Position expected(0, 0, 0, 0);
+        converter.ecefToLongitudeLatitudeElevation(ecef, expected);
+
+        REQUIRE(longitudes[i] == expected.getLongitude());
+        REQUIRE(latitudes[i] == expected.getLatitude());
+        REQUIRE(heights[i] == expected.getEllipsoidalHeight());
+    }
+}
+
 #endif /* CARTESIANTOGEODETICCONVERSIONTEST_HPP */
 
@@ -0,0 +1,263 @@
+/*
+ * Copyright 2020 © Centre Interdisciplinaire de développement en Cartographie des Océans (CIDCO), Tous droits réservés
+ */
+
+/*
+ * File:   DtmGridTest.hpp
+ */
+
+#ifndef DTMGRIDTEST_HPP
+#define DTMGRIDTEST_HPP
+
+#include "catch.hpp"
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <thread>
+#include <vector>
+#include "../src/gridding/DtmGrid.hpp"
+#include "../src/gridding/DtmGridStore.hpp"
+#include "../src/gridding/DatagramGridder.hpp"
+#include "../src/svp/SvpNearestByTime.hpp"
+
+TEST_CASE("DTM grid cell statistics") {
+    DtmGrid grid(2.0);
+
+    double depths[] = {10.5, 12.0, 9.25, 11.0, 10.0};
+    double sum = 0;
+
+    for (unsigned int i = 0; i < 5; i++) {
+        grid.add(-3.9 + i * 0.1, 101.0, depths[i]);
+        sum += depths[i];
+    }
+
+    double mean = sum / 5;
+    double squares = 0;
+
+    for (unsigned int i = 0; i < 5; i++) {
+        squares += (depths[i] - mean) * (depths[i] - mean);
+    }
+
+    DtmCell * cell = grid.getCell(-2.1, 100.1);
+    REQUIRE(cell != NULL);
+    REQUIRE(cell->count == 5);
+    REQUIRE(cell->mean == Approx(mean));
+    REQUIRE(cell->min == Approx(9.25));
+    REQUIRE(cell->max == Approx(12.0));
+    REQUIRE(cell->getVariance() == Approx(squares / 4));
+    REQUIRE(cell->getStandardDeviation() == Approx(std::sqrt(squares / 4)));
+
+    //neighbouring cells stay empty
+    REQUIRE(grid.getCell(-1.9, 100.1) == NULL);
+    REQUIRE(grid.getCell(-2.1, 102.1) == NULL);
+    REQUIRE(grid.getNumberOfCells() == 1);
+
+    //a single sounding has no spread
+    grid.add(0.5, 0.5, 42);
+    REQUIRE(grid.getCell(0.5, 0.5)->getVariance() == 0);
+}
+
+TEST_CASE("DTM grid memory follows coverage") {
+    DtmGrid grid(1.0);
+
+    //two soundings kilometers apart only create two tiles
+    grid.add(0, 0, 10);
+    grid.add(-25000.0, 40000.0, 20);
+
+    REQUIRE(grid.getNumberOfTiles() == 2);
+    REQUIRE(grid.getNumberOfCells() == 2);
+
+    REQUIRE(grid.getCell(-25000.0, 40000.0)->mean == 20);
+    REQUIRE(grid.getCell(0, 0)->mean == 10);
+    REQUIRE(grid.getCell(-12000.0, 20000.0) == NULL);
+}
+
+TEST_CASE("Tiled grid frame indexes cells on both sides of the origin") {
+    typedef TiledGridFrame<4> Frame;
+
+    REQUIRE(Frame::getTileIndex(0) == 0);
+    REQUIRE(Frame::getTileIndex(3) == 0);
+    REQUIRE(Frame::getTileIndex(4) == 1);
+    REQUIRE(Frame::getTileIndex(-1) == -1);
+    REQUIRE(Frame::getTileIndex(-4) == -1);
+    REQUIRE(Frame::getTileIndex(-5) == -2);
+
+    //cell (-1, -1) is the north-east corner of tile (-1, -1)
+    REQUIRE(Frame::getCellOffset(-1, -1, -1, -1) == 15);
+    REQUIRE(Frame::getCellOffset(-1, -1, -4, -4) == 0);
+    REQUIRE(Frame::getTileKey(-1, 2) != Frame::getTileKey(2, -1));
+
+    Frame frame(2.0);
+    REQUIRE(frame.getCellColumn(-0.1) == -1);
+    REQUIRE(frame.getCellRow(3.9) == 1);
+
+    Position origin(0, 48.5, -68.5, 0);
+    frame.setOrigin(origin);
+
+    //a cell center comes back to the same cell
+    Position center(0, 0, 0, 0);
+    frame.cellToGeographic(-3, 5, center);
+
+    Eigen::Vector3d ecef, local;
+    CoordinateTransform::getPositionECEF(ecef, center);
+    frame.toLocal(ecef, local);
+
+    REQUIRE(local(0) == Approx(11.0).margin(1e-6));
+    REQUIRE(local(1) == Approx(-5.0).margin(1e-6));
+}
+
+TEST_CASE("Datagram gridder grids georeferenced soundings") {
+    GeoreferencingLGF lgf;
+    SvpNearestByTime svpStrategy;
+    DtmGrid grid(1.0);
+    DatagramGridder gridder(lgf, svpStrategy, grid);
+
+    Position centroid(0, 48.5, -68.5, 0);
+    lgf.setCentroid(centroid);
+
+    Eigen::Vector3d sounding(10.2, -5.7, 30.0);
+    gridder.processGeoreferencedPing(sounding, 0, 0, 0, 0);
+
+    sounding << 10.8, -5.1, 32.0;
+    gridder.processGeoreferencedPing(sounding, 0, 0, 0, 0);
+
+    REQUIRE(gridder.getNumberOfSoundings() == 2);
+    REQUIRE(grid.hasOrigin());
+
+    DtmCell * cell = grid.getCell(10.5, -5.5);
+    REQUIRE(cell != NULL);
+    REQUIRE(cell->count == 2);
+    REQUIRE(cell->mean == Approx(31.0));
+
+    //the cell center is written in geographic coordinates near the centroid
+    std::stringstream out;
+    grid.writeXyz(out);
+
+    double longitude, latitude, mean, min, max, stddev;
+    unsigned int count;
+    out >> longitude >> latitude >> count >> mean >> min >> max >> stddev;
+
+    REQUIRE(count == 2);
+    REQUIRE(longitude == Approx(-68.5).margin(0.001));
+    REQUIRE(latitude == Approx(48.5).margin(0.001));
+    REQUIRE(latitude > 48.5);
+    REQUIRE(longitude < -68.5);
+    REQUIRE(min == Approx(30.0));
+    REQUIRE(max == Approx(32.0));
+}
+
+/**Removes the files of a grid store left by a previous run*/
+static void removeDtmGridStore(std::string directory) {
+    std::ifstream index(directory + "/tiles.idx");
+    int column, row;
+
+    while (index >> column >> row) {
+        std::stringstream path;
+        path << directory << "/" << column << "_" << row << ".tile";
+        std::remove(path.str().c_str());
+    }
+
+    std::remove((directory + "/tiles.idx").c_str());
+    std::remove((directory + "/grid.meta").c_str());
+}
+
+TEST_CASE("DTM grid store keeps tiles on disk") {
+    std::string directory("build/test/dtm-grid-store");
+    removeDtmGridStore(directory);
+
+    Position origin(0, 48.5, -68.5, 0);
+
+    {
+        //a single mapped tile forces an eviction at every tile change
+        DtmGridStore store(directory, 0.5, 1);
+        store.setOrigin(origin);
+
+        store.add(1.2, 3.4, 10);
+        store.add(-5000.0, 2000.0, 20);
+        store.add(1.3, 3.3, 12);
+        store.add(-5000.1, 2000.1, 22);
+
+        REQUIRE(store.getNumberOfTiles() == 2);
+        REQUIRE(store.getNumberOfMappedTiles() == 1);
+
+        DtmCell cell;
+        REQUIRE(store.getCell(1.2, 3.4, cell));
+        REQUIRE(cell.count == 2);
+        REQUIRE(cell.mean == Approx(11));
+        REQUIRE_FALSE(store.getCell(10.0, 10.0, cell));
+        REQUIRE_FALSE(store.getCell(100000.0, 0, cell));
+    }
+
+    //reopening the store finds the origin and the cells
+    DtmGridStore store(directory, 0.5, 4);
+    REQUIRE(store.hasOrigin());
+    REQUIRE(store.getOrigin().getLatitude() == Approx(48.5));
+    REQUIRE(store.getNumberOfTiles() == 2);
+
+    DtmCell cell;
+    REQUIRE(store.getCell(-5000.0, 2000.0, cell));
+    REQUIRE(cell.count == 1);
+    REQUIRE(cell.mean == Approx(20));
+    REQUIRE(store.getCell(-5000.1, 2000.1, cell));
+    REQUIRE(cell.mean == Approx(22));
+
+    //a bounding box only brings back the cells inside it
+    DtmGrid extracted(0.5);
+    store.extract(-10.0, -10.0, 10.0, 10.0, extracted);
+
+    REQUIRE(extracted.hasOrigin());
+    REQUIRE(extracted.getNumberOfCells() == 1);
+    REQUIRE(extracted.getCell(1.2, 3.4)->count == 2);
+    REQUIRE(extracted.getCell(-5000.0, 2000.0) == NULL);
+
+    //the cell size of a store cannot change
+    REQUIRE_THROWS(DtmGridStore(directory, 1.0));
+
+    removeDtmGridStore(directory);
+}
+
+TEST_CASE("DTM grid store takes soundings from many threads") {
+    std::string directory("build/test/dtm-grid-store-threads");
+    removeDtmGridStore(directory);
+
+    DtmGridStore store(directory, 1.0, 2);
+
+    //every thread writes the same cells, spread over more tiles than are mapped
+    std::vector<std::thread> threads;
+
+    for (unsigned int t = 0; t < 4; t++) {
+        threads.push_back(std::thread([&store]() {
+            for (unsigned int i = 0; i < 1000; i++) {
+                store.add((i % 10) * 200.0, (i % 7) * 300.0, i % 5);
+            }
+        }));
+    }
+
+    for (auto i = threads.begin(); i != threads.end(); i++) {
+        i->join();
+    }
+
+    //each thread keeps its last tile pinned until the flush
+    REQUIRE(store.getNumberOfMappedTiles() <= 4);
+    store.flush();
+    REQUIRE(store.getNumberOfMappedTiles() <= 2);
+
+    DtmGrid extracted(1.0);
+    store.extract(-1.0, -1.0, 2000.0, 2000.0, extracted);
+
+    uint64_t total = 0;
+
+    for (auto i = extracted.getTiles().begin(); i != extracted.getTiles().end(); i++) {
+        for (auto cell = i->second->cells.begin(); cell != i->second->cells.end(); cell++) {
+            total += cell->count;
+        }
+    }
+
+    REQUIRE(total == 4000);
+    REQUIRE(store.getNumberOfMappedTiles() <= 2);
+
+    removeDtmGridStore(directory);
+}
+
+#endif /* DTMGRIDTEST_HPP */
@@ -754,5 +754,39 @@ TEST_CASE("Georeference LGF with position and perpendicular unit vector ping and
 }
 
 
+TEST_CASE("Georeference a sounding raytraced by the sonar in LGF and TRF"){
+    Position position(0, 48.4525, -68.5232, 15.401);
+    Attitude attitude(0, 0, 0, 90);
+    Eigen::Matrix3d imu2ned;
+    CoordinateTransform::getDCM(imu2ned, attitude);
+
+    //10 m forward and 2 m to starboard of the PRP of a ship heading east
+    Sounding sounding(0, 0, 90, 1.5, 10, 2, 20, 0, 0);
+
+    //the sonar already measured x and y from the PRP, only the height of the transducer is added
+    Eigen::Vector3d leverArm(1, 0, 0.5);
+
+    Eigen::Vector3d expectedNED(-2, 10, 20.5);
+
+    GeoreferencingLGF lgf;
+    lgf.setCentroid(position);
+
+    Eigen::Vector3d georefedLGF;
+    lgf.georeferenceSounding(georefedLGF, imu2ned, position, sounding, leverArm);
+    REQUIRE((georefedLGF - expectedNED).norm() < 1e-9);
+
+    GeoreferencingTRF trf;
+
+    Eigen::Vector3d georefedTRF;
+    trf.georeferenceSounding(georefedTRF, imu2ned, position, sounding, leverArm);
+
+    Eigen::Vector3d positionECEF;
+    CoordinateTransform::getPositionECEF(positionECEF, position);
+    Eigen::Matrix3d ned2ecef;
+    CoordinateTransform::ned2ecef(ned2ecef, position);
+    REQUIRE((ned2ecef.transpose() * (georefedTRF - positionECEF) - expectedNED).norm() < 1e-6);
+}
+
+
 #endif /* GEOREFERENCINGTEST_HPP */
 
@@ -0,0 +1,86 @@
+/*
+ * Copyright 2020 © Centre Interdisciplinaire de développement en Cartographie des Océans (CIDCO), Tous droits réservés
+ */
+
+/*
+ * File:   HullGridTest.hpp
+ */
+
+#ifndef HULLGRIDTEST_HPP
+#define HULLGRIDTEST_HPP
+
+#include "catch.hpp"
+#include <cstdlib>
+#include <cmath>
+#include <vector>
+#include "../src/geometry/HullGrid.hpp"
+
+TEST_CASE("Hull grid answers like the crossing test") {
+    srand(5);
+
+    //concave star shaped polygons, including the collinear and repeated vertices hulls may have
+    unsigned int nbVerticesTested[] = {3, 4, 50, 2000};
+
+    for (unsigned int p = 0; p < 4; p++) {
+        unsigned int nbVertices = nbVerticesTested[p];
+        std::vector<float> x, y;
+
+        for (unsigned int i = 0; i < nbVertices; i++) {
+            double angle = 2 * M_PI * i / nbVertices;
+            double radius = (nbVertices <= 4) ? 100 : 50 + rand() % 50;
+            x.push_back(1000 + radius * cos(angle) * 3);
+            y.push_back(-500 + radius * sin(angle));
+
+            if (i % 97 == 13 && nbVertices > 4) {
+                x.push_back(x.back());
+                y.push_back(y.back());
+            }
+        }
+
+        HullGrid grid(x, y);
+        REQUIRE(grid.getNumberOfBoundaryCells() < grid.getNumberOfCells());
+
+        std::vector<float> points;
+
+        for (unsigned int i = 0; i < 200000; i++) {
+            float px, py;
+
+            if (i % 10 == 0) {
+                //on a vertex, or on an edge
+                unsigned int v = rand() % x.size();
+                unsigned int w = (v + 1) % x.size();
+                double t = (i % 20 == 0) ? 0 : (double) rand() / RAND_MAX;
+                px = x[v] + (x[w] - x[v]) * t;
+                py = y[v] + (y[w] - y[v]) * t;
+            }
+            else {
+                px = 1000 + ((double) rand() / RAND_MAX - 0.5) * 700;
+                py = -500 + ((double) rand() / RAND_MAX - 0.5) * 250;
+            }
+
+            points.push_back(px);
+            points.push_back(py);
+
+            REQUIRE(grid.isInside(px, py) == HullGrid::isInPolygon(px, py, x, y));
+        }
+
+        //threads keep the order of the points
+        std::vector<uint64_t> serial, parallel;
+        grid.findPointsInside(&points[0], &points[1], points.size() / 2, 2 * sizeof(float), serial, 1);
+        grid.findPointsInside(&points[0], &points[1], points.size() / 2, 2 * sizeof(float), parallel, 4);
+
+        REQUIRE(serial.size() > 0);
+        REQUIRE(serial == parallel);
+
+        for (unsigned int i = 0; i < serial.size(); i++) {
+            REQUIRE(grid.isInside(points[2 * serial[i]], points[2 * serial[i] + 1]));
+        }
+    }
+
+    //no polygon, nothing inside
+    std::vector<float> none;
+    HullGrid empty(none, none);
+    REQUIRE_FALSE(empty.isInside(0, 0));
+}
+
+#endif /* HULLGRIDTEST_HPP */
@@ -0,0 +1,253 @@
+/*
+ * Copyright 2020 © Centre Interdisciplinaire de développement en Cartographie des Océans (CIDCO), Tous droits réservés
+ */
+
+/*
+ * File:   InputStreamTest.hpp
+ */
+
+#ifndef INPUTSTREAMTEST_HPP
+#define INPUTSTREAMTEST_HPP
+
+#include "catch.hpp"
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include <zlib.h>
+#include "../src/utils/InputStream.hpp"
+#include "../src/datagrams/DatagramParserFactory.hpp"
+
+/**Writes bytes to a gzip file, as several members if asked*/
+static void writeGzip(std::string filename, std::vector<unsigned char> & data, unsigned int nbMembers) {
+    FILE * file = fopen(filename.c_str(), "wb");
+    size_t memberSize = data.size() / nbMembers + 1;
+
+    for (size_t begin = 0; begin < data.size(); begin += memberSize) {
+        size_t size = std::min(memberSize, data.size() - begin);
+
+        z_stream stream;
+        memset(&stream, 0, sizeof (z_stream));
+        deflateInit2(&stream, 6, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY);
+
+        std::vector<unsigned char> compressed(deflateBound(&stream, size));
+        stream.next_in = &data[begin];
+        stream.avail_in = size;
+        stream.next_out = &compressed[0];
+        stream.avail_out = compressed.size();
+        deflate(&stream, Z_FINISH);
+
+        fwrite(&compressed[0], 1, compressed.size() - stream.avail_out, file);
+        deflateEnd(&stream);
+    }
+
+    fclose(file);
+}
+
+/**Reads a whole file*/
+static std::vector<unsigned char> readFile(std::string filename) {
+    std::vector<unsigned char> data;
+    FILE * file = fopen(filename.c_str(), "rb");
+    unsigned char buffer[65536];
+    size_t nbRead;
+
+    while ((nbRead = fread(buffer, 1, sizeof (buffer), file)) > 0) {
+        data.insert(data.end(), buffer, buffer + nbRead);
+    }
+
+    fclose(file);
+
+    return data;
+}
+
+TEST_CASE("A gzip file reads, skips and ends like the plain file") {
+    std::vector<unsigned char> data(3000000);
+
+    for (unsigned int i = 0; i < data.size(); i++) {
+        data[i] = (i * 7 + i / 1000) & 0xff;
+    }
+
+    std::string plainName = "build/test/inputstream.bin";
+    std::string gzipName = "build/test/inputstream.bin.gz";
+
+    FILE * plainFile = fopen(plainName.c_str(), "wb");
+    fwrite(&data[0], 1, data.size(), plainFile);
+    fclose(plainFile);
+
+    //several members, as pigz or bgzip write them
+    writeGzip(gzipName, data, 3);
+
+    InputStream * plain = InputStream::open(plainName);
+    InputStream * gzip = InputStream::open(gzipName);
+
+    REQUIRE(plain != NULL);
+    REQUIRE(gzip != NULL);
+    REQUIRE(dynamic_cast<FileInputStream *> (plain) != NULL);
+    REQUIRE(dynamic_cast<CompressedInputStream *> (gzip) != NULL);
+
+    //reads and skips of all sizes, across blocks and members
+    srand(7);
+    std::vector<unsigned char> expected(200000);
+    std::vector<unsigned char> actual(200000);
+
+    while (!plain->eof()) {
+        size_t n = rand() % expected.size();
+
+        if (rand() % 4 == 0) {
+            plain->skip(n);
+            gzip->skip(n);
+        } else {
+            size_t expectedRead = plain->read(&expected[0], n, 1);
+            size_t actualRead = gzip->read(&actual[0], n, 1);
+
+            REQUIRE(actualRead == expectedRead);
+
+            if (expectedRead == 1) {
+                REQUIRE(memcmp(&expected[0], &actual[0], n) == 0);
+            }
+        }
+
+        if (!plain->eof()) {
+            REQUIRE(gzip->tell() == plain->tell());
+        }
+    }
+
+    REQUIRE(gzip->eof());
+
+    delete plain;
+    delete gzip;
+
+    //a stream dropped before its end stops its thread
+    InputStream * dropped = InputStream::open(gzipName);
+    REQUIRE(dropped->read(&actual[0], 10, 1) == 1);
+    delete dropped;
+
+    remove(plainName.c_str());
+    remove(gzipName.c_str());
+}
+
+TEST_CASE("A plain file starting like gzip is not decompressed") {
+    //a little-endian datagram length of 0x18b1f, which starts with the gzip magic
+    std::vector<unsigned char> data(1000, 7);
+    data[0] = 0x1f;
+    data[1] = 0x8b;
+    data[2] = 0x01;
+    data[3] = 0x00;
+
+    std::string plainName = "build/test/gzipmagic.bin";
+    FILE * file = fopen(plainName.c_str(), "wb");
+    fwrite(&data[0], 1, data.size(), file);
+    fclose(file);
+
+    InputStream * plain = InputStream::open(plainName);
+    REQUIRE(dynamic_cast<FileInputStream *> (plain) != NULL);
+
+    std::vector<unsigned char> actual(data.size());
+    REQUIRE(plain->read(&actual[0], actual.size(), 1) == 1);
+    REQUIRE(actual == data);
+
+    delete plain;
+    remove(plainName.c_str());
+}
+
+TEST_CASE("A truncated gzip file is reported") {
+    std::vector<unsigned char> data(500000, 42);
+    std::string gzipName = "build/test/truncated.bin.gz";
+
+    writeGzip(gzipName, data, 1);
+
+    std::vector<unsigned char> compressed = readFile(gzipName);
+    FILE * file = fopen(gzipName.c_str(), "wb");
+    fwrite(&compressed[0], 1, compressed.size() / 2, file);
+    fclose(file);
+
+    InputStream * gzip = InputStream::open(gzipName);
+    std::vector<unsigned char> buffer(data.size());
+
+    REQUIRE_THROWS(gzip->read(&buffer[0], buffer.size(), 1));
+
+    delete gzip;
+    remove(gzipName.c_str());
+}
+
+#ifdef MBES_WITH_ZSTD
+
+TEST_CASE("A zstd file reads like the plain file") {
+    std::vector<unsigned char> data(2500000);
+
+    for (unsigned int i = 0; i < data.size(); i++) {
+        data[i] = (i * 13 + i / 777) & 0xff;
+    }
+
+    std::string zstdName = "build/test/inputstream.bin.zst";
+    FILE * file = fopen(zstdName.c_str(), "wb");
+
+    //two frames
+    size_t half = data.size() / 2;
+    size_t sizes[2] = {half, data.size() - half};
+
+    for (unsigned int i = 0; i < 2; i++) {
+        std::vector<unsigned char> compressed(ZSTD_compressBound(sizes[i]));
+        size_t compressedSize = ZSTD_compress(&compressed[0], compressed.size(), &data[i * half], sizes[i], 3);
+        fwrite(&compressed[0], 1, compressedSize, file);
+    }
+
+    fclose(file);
+
+    InputStream * zstd = InputStream::open(zstdName);
+    REQUIRE(dynamic_cast<CompressedInputStream *> (zstd) != NULL);
+
+    std::vector<unsigned char> actual(data.size());
+    zstd->skip(1000);
+    REQUIRE(zstd->read(&actual[0], data.size() - 1000, 1) == 1);
+    REQUIRE(memcmp(&actual[0], &data[1000], data.size() - 1000) == 0);
+    REQUIRE(zstd->read(&actual[0], 1, 1) == 0);
+    REQUIRE(zstd->eof());
+
+    delete zstd;
+    remove(zstdName.c_str());
+}
+
+#endif
+
+TEST_CASE("A gzip compressed datagram file parses like the plain file") {
+
+    class DatagramCounter : public DatagramEventHandler {
+    public:
+        std::map<int, unsigned int> tags;
+        unsigned int nbPings = 0;
+
+        void processDatagramTag(int id) {
+            tags[id]++;
+        }
+
+        void processPing(uint64_t microEpoch, long id, double beamAngle, double tiltAngle, double twoWayTravelTime, uint32_t quality, int32_t intensity) {
+            nbPings++;
+        }
+    };
+
+    std::string plainName = "test/data/all/0008_20160909_135801_Panopee.all";
+    std::string gzipName = "build/test/0008_20160909_135801_Panopee.all.gz";
+
+    std::vector<unsigned char> data = readFile(plainName);
+    writeGzip(gzipName, data, 1);
+
+    DatagramCounter plainCounter;
+    DatagramParser * plainParser = DatagramParserFactory::build(plainName, plainCounter);
+    plainParser->parse(plainName);
+
+    DatagramCounter gzipCounter;
+    DatagramParser * gzipParser = DatagramParserFactory::build(gzipName, gzipCounter);
+    REQUIRE(dynamic_cast<KongsbergParser *> (gzipParser) != NULL);
+    gzipParser->parse(gzipName);
+
+    REQUIRE(plainCounter.nbPings > 0);
+    REQUIRE(gzipCounter.nbPings == plainCounter.nbPings);
+    REQUIRE(gzipCounter.tags == plainCounter.tags);
+
+    delete plainParser;
+    delete gzipParser;
+    remove(gzipName.c_str());
+}
+
+#endif /* INPUTSTREAMTEST_HPP */
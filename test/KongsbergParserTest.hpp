@@ -13,6 +13,8 @@
 #include "catch.hpp"
 #include "../src/datagrams/DatagramEventHandler.hpp"
 #include "../src/datagrams/kongsberg/KongsbergParser.hpp"
+#include "../src/georeferencing/Raytracing.hpp"
+#include "../src/svp/SoundVelocityProfileFactory.hpp"
 #include <math.h>
 
 #pragma pack(1)
@@ -249,3 +251,331 @@ TEST_CASE("test Kongsberg parser decoding") {
     tester.testProcessAttitudeDatagram();
 
 }
+
+TEST_CASE("test the decoding of a raw range and beam 78 datagram into a swath") {
+
+    class SwathCounter : public DatagramEventHandler {
+    public:
+        void processPing(uint64_t microEpoch, long id, double beamAngle, double tiltAngle, double twoWayTravelTime, uint32_t quality, int32_t intensity) {
+            tiltAngles.push_back(tiltAngle);
+        }
+
+        std::vector<double> tiltAngles;
+    };
+
+    class RangeAndBeamTester : public KongsbergParser {
+    public:
+
+        RangeAndBeamTester(DatagramEventHandler & processor) : KongsbergParser(processor) {
+        }
+
+        void decode(unsigned char * datagram) {
+            KongsbergHeader hdr = {0};
+            hdr.date = 20160909;
+            hdr.time = 0;
+            processRawRangeAndBeam78(hdr, datagram);
+        }
+
+        SwathBatch & getSwath() {
+            return swath;
+        }
+    };
+
+    const unsigned int nbTx = 2;
+    const unsigned int nbRx = 3;
+    std::vector<unsigned char> datagram(sizeof (KongsbergRangeAndBeam78) + nbTx * sizeof (KongsbergRangeAndBeam78TxEntry) + nbRx * sizeof (KongsbergRangeAndBeam78RxEntry), 0);
+
+    KongsbergRangeAndBeam78 * header = (KongsbergRangeAndBeam78 *) & datagram[0];
+    header->surfaceSoundSpeed = 14850;
+    header->nbTxPackets = nbTx;
+    header->nbRxPackets = nbRx;
+
+    KongsbergRangeAndBeam78TxEntry * tx = (KongsbergRangeAndBeam78TxEntry *) (&datagram[0] + sizeof (KongsbergRangeAndBeam78));
+    tx[0].txSectorNumber = 0;
+    tx[0].tiltAngle = -150;
+    tx[1].txSectorNumber = 3;
+    tx[1].tiltAngle = 225;
+
+    KongsbergRangeAndBeam78RxEntry * rx = (KongsbergRangeAndBeam78RxEntry *) (&datagram[0] + sizeof (KongsbergRangeAndBeam78) + nbTx * sizeof (KongsbergRangeAndBeam78TxEntry));
+    rx[0].beamAngle = -6000;
+    rx[0].txSectorNumber = 3;
+    rx[0].twoWayTravelTime = 0.05;
+    rx[0].qualityFactor = 7;
+    rx[1].beamAngle = 100;
+    rx[1].txSectorNumber = 0;
+    rx[1].reflectivity = -200;
+    rx[2].beamAngle = 6000;
+    rx[2].txSectorNumber = 7; // not in the datagram
+
+    SwathCounter handler;
+    RangeAndBeamTester parser(handler);
+    parser.decode(&datagram[0]);
+
+    SwathBatch & swath = parser.getSwath();
+
+    REQUIRE(swath.size() == 2);
+    REQUIRE(std::abs(swath.getSurfaceSoundSpeed() - 1485.0) < 1e-9);
+    //Kongsberg beam angles are positive to port
+    REQUIRE(std::abs(swath.beamAngles[0] - 60.0) < 1e-9);
+    REQUIRE(std::abs(swath.tiltAngles[0] - 2.25) < 1e-9);
+    REQUIRE(std::abs(swath.twoWayTravelTimes[0] - 0.05) < 1e-6);
+    REQUIRE(swath.qualities[0] == 7);
+    REQUIRE(std::abs(swath.tiltAngles[1] + 1.5) < 1e-9);
+    REQUIRE(swath.intensities[1] == -100);
+
+    //the default handler hands each beam to processPing
+    REQUIRE(handler.tiltAngles.size() == 2);
+    REQUIRE(std::abs(handler.tiltAngles[1] + 1.5) < 1e-9);
+}
+
+TEST_CASE("test that a starboard beam of a raw range and beam 78 datagram is raytraced to starboard") {
+
+    class PingCollector : public DatagramEventHandler {
+    public:
+        void processPing(uint64_t microEpoch, long id, double beamAngle, double tiltAngle, double twoWayTravelTime, uint32_t quality, int32_t intensity) {
+            pings.push_back(Ping(microEpoch, id, quality, intensity, 1480.0, twoWayTravelTime, tiltAngle, beamAngle));
+        }
+
+        std::vector<Ping> pings;
+    };
+
+    class RangeAndBeamTester : public KongsbergParser {
+    public:
+
+        RangeAndBeamTester(DatagramEventHandler & processor) : KongsbergParser(processor) {
+        }
+
+        void decode(unsigned char * datagram) {
+            KongsbergHeader hdr = {0};
+            hdr.date = 20160909;
+            hdr.time = 0;
+            processRawRangeAndBeam78(hdr, datagram);
+        }
+    };
+
+    std::vector<unsigned char> datagram(sizeof (KongsbergRangeAndBeam78) + sizeof (KongsbergRangeAndBeam78TxEntry) + 2 * sizeof (KongsbergRangeAndBeam78RxEntry), 0);
+
+    KongsbergRangeAndBeam78 * header = (KongsbergRangeAndBeam78 *) & datagram[0];
+    header->surfaceSoundSpeed = 14800;
+    header->nbTxPackets = 1;
+    header->nbRxPackets = 2;
+
+    //Kongsberg beam angles are positive to port
+    KongsbergRangeAndBeam78RxEntry * rx = (KongsbergRangeAndBeam78RxEntry *) (&datagram[0] + sizeof (KongsbergRangeAndBeam78) + sizeof (KongsbergRangeAndBeam78TxEntry));
+    rx[0].beamAngle = -4500;
+    rx[0].twoWayTravelTime = 0.04;
+    rx[1].beamAngle = 4500;
+    rx[1].twoWayTravelTime = 0.04;
+
+    PingCollector handler;
+    RangeAndBeamTester parser(handler);
+    parser.decode(&datagram[0]);
+
+    REQUIRE(handler.pings.size() == 2);
+
+    SoundVelocityProfile * svp = SoundVelocityProfileFactory::buildFreshWaterModel();
+    Eigen::Matrix3d boresight = Eigen::Matrix3d::Identity();
+    Eigen::Matrix3d imu2ned = Eigen::Matrix3d::Identity();
+
+    Eigen::Vector3d starboard;
+    Raytracing::rayTrace(starboard, handler.pings[0], *svp, boresight, imu2ned);
+    Eigen::Vector3d port;
+    Raytracing::rayTrace(port, handler.pings[1], *svp, boresight, imu2ned);
+
+    //a ship heading north: starboard is east, the y of NED
+    REQUIRE(starboard(1) > 20);
+    REQUIRE(port(1) < -20);
+    REQUIRE(std::abs(starboard(2) - port(2)) < 1e-6);
+
+    delete svp;
+}
+
+TEST_CASE("test the decoding of an XYZ 88 datagram into soundings") {
+
+    class SoundingCounter : public DatagramEventHandler {
+    public:
+        void processSounding(uint64_t microEpoch, long id, double heading, double transducerDepth, double alongTrack, double acrossTrack, double depth, uint32_t quality, int32_t intensity) {
+            ids.push_back(id);
+            headings.push_back(heading);
+            transducerDepths.push_back(transducerDepth);
+            vectors.push_back(Eigen::Vector3d(alongTrack, acrossTrack, depth));
+            qualities.push_back(quality);
+            intensities.push_back(intensity);
+        }
+
+        std::vector<long> ids;
+        std::vector<double> headings;
+        std::vector<double> transducerDepths;
+        std::vector<Eigen::Vector3d> vectors;
+        std::vector<uint32_t> qualities;
+        std::vector<int32_t> intensities;
+    };
+
+    class XYZ88Tester : public KongsbergParser {
+    public:
+
+        XYZ88Tester(DatagramEventHandler & processor) : KongsbergParser(processor) {
+        }
+
+        void decode(unsigned char * datagram) {
+            KongsbergHeader hdr = {0};
+            hdr.date = 20160909;
+            hdr.time = 0;
+            processXYZ88(hdr, datagram);
+        }
+    };
+
+    const unsigned int nbBeams = 3;
+    std::vector<unsigned char> datagram(sizeof (KongsbergXYZ88) + nbBeams * sizeof (KongsbergXYZ88Entry), 0);
+
+    KongsbergXYZ88 * header = (KongsbergXYZ88 *) & datagram[0];
+    header->heading = 34471;
+    header->transducerDepth = 1.32;
+    header->nbBeams = nbBeams;
+
+    KongsbergXYZ88Entry * beams = (KongsbergXYZ88Entry *) (&datagram[0] + sizeof (KongsbergXYZ88));
+    beams[0].depth = 17.25;
+    beams[0].acrossTrack = -29.5;
+    beams[0].alongTrack = -0.25;
+    beams[0].qualityFactor = 17;
+    beams[0].reflectivity = -350;
+    beams[1].detectionInfo = 0x80; // invalid detection
+    beams[2].depth = 15.0;
+    beams[2].acrossTrack = 26.0;
+    beams[2].detectionInfo = 0x01;
+
+    SoundingCounter handler;
+    XYZ88Tester parser(handler);
+    parser.decode(&datagram[0]);
+
+    REQUIRE(handler.ids.size() == 2);
+    REQUIRE(handler.ids[0] == 0);
+    REQUIRE(handler.ids[1] == 2);
+    REQUIRE(std::abs(handler.headings[0] - 344.71) < 1e-9);
+    REQUIRE(std::abs(handler.transducerDepths[1] - 1.32) < 1e-6);
+    REQUIRE(handler.vectors[0].isApprox(Eigen::Vector3d(-0.25, -29.5, 17.25)));
+    REQUIRE(handler.vectors[1].isApprox(Eigen::Vector3d(0, 26.0, 15.0)));
+    REQUIRE(handler.qualities[0] == 17);
+    REQUIRE(handler.intensities[0] == -175);
+}
+
+TEST_CASE("test the Kongsberg water column datagrams, decoded on demand or skipped") {
+
+    class WaterColumnCounter : public DatagramEventHandler {
+    public:
+        WaterColumnCounter(bool wanted) : wanted(wanted) {
+        }
+
+        bool wantsWaterColumn() {
+            return wanted;
+        }
+
+        void processDatagramTag(int id) {
+            tags.push_back(id);
+        }
+
+        void processWaterColumn(WaterColumnRecord & record) {
+            KongsbergWaterColumnRecord & k = dynamic_cast<KongsbergWaterColumnRecord &> (record);
+
+            nbBeams.push_back(record.getNumberOfBeams());
+            pingNumbers.push_back(record.getPingNumber());
+            soundSpeed = record.getSoundSpeed();
+            samplingFrequency = record.getSamplingFrequency();
+            datagramNumber = k.getDatagramNumber();
+            beamAngle = record.getBeamAngle(1);
+            tiltAngle = k.getTiltAngle(1);
+            firstSample = record.getFirstSample(1);
+            record.getAmplitudes(1, amplitudes);
+        }
+
+        bool wanted;
+        std::vector<int> tags;
+        std::vector<unsigned int> nbBeams;
+        std::vector<uint32_t> pingNumbers;
+        double soundSpeed = 0, samplingFrequency = 0, beamAngle = 0, tiltAngle = 0;
+        unsigned int datagramNumber = 0, firstSample = 0;
+        std::vector<float> amplitudes;
+    };
+
+    //two beams of 2 and 3 samples
+    std::vector<unsigned char> content(sizeof (KongsbergWaterColumn) + sizeof (KongsbergWaterColumnTxEntry) + 2 * sizeof (KongsbergWaterColumnRxEntry) + 5, 0);
+
+    KongsbergWaterColumn * header = (KongsbergWaterColumn *) & content[0];
+    header->nbDatagrams = 3;
+    header->datagramNumber = 2;
+    header->nbTxSectors = 1;
+    header->totalNbBeams = 6;
+    header->nbBeams = 2;
+    header->soundSpeed = 14850;
+    header->samplingFrequency = 1234567;
+
+    KongsbergWaterColumnTxEntry * tx = (KongsbergWaterColumnTxEntry *) (&content[0] + sizeof (KongsbergWaterColumn));
+    tx->tiltAngle = -125;
+    tx->txSectorNumber = 4;
+
+    unsigned char * p = (unsigned char *) (tx + 1);
+    KongsbergWaterColumnRxEntry * rx = (KongsbergWaterColumnRxEntry *) p;
+    rx->nbSamples = 2;
+    rx->txSectorNumber = 4;
+    p += sizeof (KongsbergWaterColumnRxEntry) + 2;
+
+    rx = (KongsbergWaterColumnRxEntry *) p;
+    rx->beamAngle = -4550;
+    rx->startRangeSampleNumber = 12;
+    rx->nbSamples = 3;
+    rx->txSectorNumber = 4;
+    int8_t * samples = (int8_t *) (rx + 1);
+    samples[0] = -60;
+    samples[1] = -21;
+    samples[2] = 7;
+
+    //a file of two water column datagrams
+    std::string filename("build/test/watercolumn.all");
+    FILE * file = fopen(filename.c_str(), "wb");
+    REQUIRE(file != NULL);
+
+    for (uint16_t counter = 100; counter < 102; counter++) {
+        KongsbergHeader hdr = {0};
+        hdr.size = sizeof (KongsbergHeader) - sizeof (uint32_t) + content.size() + 3;
+        hdr.stx = STX;
+        hdr.type = 'k';
+        hdr.date = 20160909;
+        hdr.counter = counter;
+
+        unsigned char trailer[3] = {ETX, 0, 0};
+
+        fwrite(&hdr, sizeof (KongsbergHeader), 1, file);
+        fwrite(&content[0], content.size(), 1, file);
+        fwrite(trailer, sizeof (trailer), 1, file);
+    }
+
+    fclose(file);
+
+    WaterColumnCounter skipper(false);
+    KongsbergParser skipping(skipper);
+    skipping.parse(filename);
+
+    REQUIRE(skipper.tags.size() == 2);
+    REQUIRE(skipper.tags[1] == 'k');
+    REQUIRE(skipper.nbBeams.empty());
+
+    WaterColumnCounter reader(true);
+    KongsbergParser reading(reader);
+    reading.parse(filename);
+
+    remove(filename.c_str());
+
+    REQUIRE(reader.nbBeams.size() == 2);
+    REQUIRE(reader.nbBeams[0] == 2);
+    REQUIRE(reader.pingNumbers[1] == 101);
+    REQUIRE(reader.datagramNumber == 2);
+    REQUIRE(std::abs(reader.soundSpeed - 1485.0) < 1e-9);
+    REQUIRE(std::abs(reader.samplingFrequency - 12345.67) < 1e-9);
+    REQUIRE(std::abs(reader.beamAngle + 45.5) < 1e-9);
+    REQUIRE(std::abs(reader.tiltAngle + 1.25) < 1e-9);
+    REQUIRE(reader.firstSample == 12);
+    REQUIRE(reader.amplitudes.size() == 3);
+    REQUIRE(reader.amplitudes[0] == -30.0f);
+    REQUIRE(reader.amplitudes[1] == -10.5f);
+    REQUIRE(reader.amplitudes[2] == 3.5f);
+}
@@ -2,6 +2,7 @@
 #define NMEAUTILSTEST_HPP
 
 #include "catch.hpp"
+#include <cstring>
 #include "../src/utils/NmeaUtils.hpp"
 
 #define DOUBLE_PRECISION 0.0000000000001
@@ -41,6 +42,106 @@ TEST_CASE( "Extract height from invalid GGA") {
         REQUIRE(std::isnan(height));
 }
 
+TEST_CASE("Split an NMEA sentence in place and check its checksum") {
+        const char * gga = "$GPGGA,172814.0,3723.46587704,N,12202.26957864,W,2,6,1.2,18.893,M,-25.669,M,2.0,0031*4F\r\n";
+
+        NmeaSentence sentence(gga);
+        REQUIRE(sentence.getNumberOfFields() == 15);
+        REQUIRE(sentence.hasChecksum());
+        REQUIRE(sentence.isChecksumValid());
+        REQUIRE(sentence.findType("GGA") == 0);
+        REQUIRE(sentence.findType("GGK") == -1);
+        REQUIRE(sentence.getField(1) == gga + 7);
+        REQUIRE(sentence.getFieldLength(1) == 8);
+        REQUIRE(sentence.getChar(3) == 'N');
+        REQUIRE(sentence.getInt(7) == 6);
+        REQUIRE(std::isnan(sentence.getDouble(20)));
+
+        //one character changed
+        std::string corrupted(gga);
+        corrupted[20] = '4';
+        NmeaSentence wrong(corrupted.c_str());
+        REQUIRE(wrong.hasChecksum());
+        REQUIRE_FALSE(wrong.isChecksumValid());
+
+        NmeaGGA fix;
+        REQUIRE_FALSE(NmeaUtils::extractGGA(wrong, fix));
+
+        //the length bounds the sentence, which needs no null
+        NmeaSentence truncated(gga, 20);
+        REQUIRE(truncated.getNumberOfFields() == 3);
+        REQUIRE_FALSE(truncated.hasChecksum());
+        REQUIRE(truncated.getDouble(2) == 3723.0);
+}
 
-#endif
+TEST_CASE("Fields after the 32nd of an NMEA sentence are ignored") {
+        //40 fields, numbered from 0
+        std::string proprietary = "$PXXX";
+
+        for (unsigned int i = 1; i < 40; i++) {
+            proprietary += "," + std::to_string(i);
+        }
+
+        NmeaSentence sentence(proprietary.c_str());
+        REQUIRE(sentence.getNumberOfFields() == 32);
+        REQUIRE(sentence.getFieldLength(31) == 2);
+        REQUIRE(sentence.getDouble(31) == 31.0);
+        REQUIRE(sentence.startsWith(31, "31"));
+        REQUIRE_FALSE(sentence.startsWith(31, "31,"));
+        REQUIRE(std::isnan(sentence.getDouble(32)));
+}
+
+TEST_CASE("Extract GGA, GGK, GST and HDT sentences") {
+        NmeaSentence ggaSentence("$GPGGA,172814.0,3723.46587704,N,12202.26957864,W,2,6,1.2,18.893,M,-25.669,M,2.0,0031*4F");
+        NmeaGGA gga;
+        REQUIRE(NmeaUtils::extractGGA(ggaSentence, gga));
+        REQUIRE(gga.time == Approx(17 * 3600 + 28 * 60 + 14));
+        REQUIRE(gga.latitude == Approx(37 + 23.46587704 / 60));
+        REQUIRE(gga.longitude == Approx(-(122 + 2.26957864 / 60)));
+        REQUIRE(gga.quality == 2);
+        REQUIRE(gga.nbSatellites == 6);
+        REQUIRE(gga.hdop == 1.2);
+        REQUIRE(gga.orthometricHeight == 18.893);
+        REQUIRE(gga.geoidSeparation == -25.669);
+
+        //Trimble proprietary form
+        NmeaSentence ggkSentence("$PTNL,GGK,102939.00,051910,5000.97323841,S,00827.62010742,E,5,09,1.9,EHT150.790,M*6E");
+        NmeaGGK ggk;
+        REQUIRE(ggkSentence.findType("GGK") == 1);
+        REQUIRE(NmeaUtils::extractGGK(ggkSentence, ggk));
+        REQUIRE(ggk.latitude == Approx(-(50 + 0.97323841 / 60)));
+        REQUIRE(ggk.longitude == Approx(8 + 27.62010742 / 60));
+        REQUIRE(ggk.quality == 5);
+        REQUIRE(ggk.nbSatellites == 9);
+        REQUIRE(ggk.ellipsoidalHeight == 150.790);
+
+        NmeaSentence gstSentence("$GPGST,172814.0,0.006,0.023,0.020,273.6,0.023,0.020,0.031*6A");
+        NmeaGST gst;
+        REQUIRE(NmeaUtils::extractGST(gstSentence, gst));
+        REQUIRE(gst.rms == 0.006);
+        REQUIRE(gst.orientation == 273.6);
+        REQUIRE(gst.heightError == 0.031);
+
+        NmeaSentence hdtSentence("$HEHDT,274.07,T*19");
+        NmeaHDT hdt;
+        REQUIRE(NmeaUtils::extractHDT(hdtSentence, hdt));
+        REQUIRE(hdt.heading == 274.07);
+        REQUIRE_FALSE(NmeaUtils::extractGGA(hdtSentence, gga));
+}
+
+TEST_CASE("Parse NMEA numbers like strtod") {
+        const char * numbers[] = {"0", "-0.5", "+12.25", "4822.32065998", "00429.55086871", "-25.669", "123456789012345678", "1.5e3", "7."};
 
+        for (unsigned int i = 0; i < 9; i++) {
+                REQUIRE(NmeaUtils::parseDouble(numbers[i], numbers[i] + strlen(numbers[i])) == strtod(numbers[i], NULL));
+        }
+
+        const char * empty = "";
+        REQUIRE(std::isnan(NmeaUtils::parseDouble(empty, empty)));
+
+        const char * unit = "M";
+        REQUIRE(std::isnan(NmeaUtils::parseDouble(unit, unit + 1)));
+}
+
+
+#endif
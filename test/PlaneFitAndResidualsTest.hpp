@@ -12,6 +12,7 @@
 
 #include "catch.hpp"
 #include <cmath>
+#include <cstdlib>
 #include <Eigen/Dense>
 #include "../src/math/PlaneFitter.hpp"
 
@@ -96,6 +97,81 @@ TEST_CASE("plane fit and residual test") {
     REQUIRE(std::abs(residuals(0) - 1) < eps);
 }
 
+TEST_CASE("streaming plane fit matches the batch plane fit") {
+    //far from the origin, as projected coordinates are
+    int n = 10000;
+    Eigen::MatrixXd xyz(n, 3);
+    srand(8);
+
+    for (int i = 0; i < n; i++) {
+        double x = 300000 + 50.0 * rand() / RAND_MAX;
+        double y = 5000000 + 50.0 * rand() / RAND_MAX;
+        xyz(i, 0) = x;
+        xyz(i, 1) = y;
+        xyz(i, 2) = 0.05 * (x - 300000) - 0.02 * (y - 5000000) + 25 + 0.1 * ((double) rand() / RAND_MAX - 0.5);
+    }
+
+    Eigen::Vector4d batchPlane;
+    PlaneFitter::fitPlane(xyz, batchPlane);
+
+    //one accumulator, and four partial ones merged
+    PlaneFitAccumulator whole;
+    PlaneFitAccumulator parts[4];
+
+    for (int i = 0; i < n; i++) {
+        whole.add(xyz(i, 0), xyz(i, 1), xyz(i, 2));
+        parts[i * 4 / n].add(xyz(i, 0), xyz(i, 1), xyz(i, 2));
+    }
+
+    PlaneFitAccumulator merged;
+
+    for (int p = 0; p < 4; p++) {
+        merged.merge(parts[p]);
+    }
+
+    REQUIRE(merged.getCount() == (uint64_t) n);
+
+    Eigen::Vector4d wholePlane, mergedPlane;
+    REQUIRE(whole.fitPlane(wholePlane));
+    REQUIRE(merged.fitPlane(mergedPlane));
+
+    Eigen::Vector3d batchZform, wholeZform, mergedZform;
+    PlaneFitter::convertPlaneGeneralForm2Zform(batchPlane, batchZform);
+    PlaneFitter::convertPlaneGeneralForm2Zform(wholePlane, wholeZform);
+    PlaneFitter::convertPlaneGeneralForm2Zform(mergedPlane, mergedZform);
+
+    for (int k = 0; k < 2; k++) {
+        REQUIRE(wholeZform(k) == Approx(batchZform(k)).epsilon(1e-6));
+        REQUIRE(mergedZform(k) == Approx(batchZform(k)).epsilon(1e-6));
+    }
+
+    //the intercept at the middle of the cloud
+    REQUIRE(wholeZform.dot(Eigen::Vector3d(300025, 5000025, 1)) == Approx(batchZform.dot(Eigen::Vector3d(300025, 5000025, 1))).epsilon(1e-9));
+
+    //residual statistics from the moments, against the residuals themselves
+    Eigen::VectorXd residuals;
+    PlaneFitter::calculatePlaneResidualsFromMatrix(residuals, xyz, wholePlane);
+
+    double mean = residuals.mean();
+    double variance = (residuals.array() - mean).square().sum() / (n - 1);
+
+    REQUIRE(std::abs(whole.getResidualMean(wholePlane)) < 1e-6);
+    REQUIRE(whole.getResidualMean(wholePlane) == Approx(mean).margin(1e-6));
+    REQUIRE(whole.getResidualStandardDeviation(wholePlane) == Approx(std::sqrt(variance)).epsilon(1e-6));
+    REQUIRE(merged.getResidualStandardDeviation(wholePlane) == Approx(std::sqrt(variance)).epsilon(1e-6));
+
+    //points along a line do not define a plane
+    PlaneFitAccumulator line;
+
+    for (int i = 0; i < 10; i++) {
+        line.add(i, 2 * i, 3);
+    }
+
+    Eigen::Vector4d linePlane;
+    REQUIRE_FALSE(line.fitPlane(linePlane));
+    REQUIRE_FALSE(PlaneFitAccumulator().fitPlane(linePlane));
+}
+
 
 #endif /* PLANEFITANDRESIDUALSTEST_HPP */
 
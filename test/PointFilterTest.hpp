@@ -0,0 +1,211 @@
+/*
+ * Copyright 2020 © Centre Interdisciplinaire de développement en Cartographie des Océans (CIDCO), Tous droits réservés
+ */
+
+/*
+ * File:   PointFilterTest.hpp
+ */
+
+#ifndef POINTFILTERTEST_HPP
+#define POINTFILTERTEST_HPP
+
+#include "catch.hpp"
+#include <cstdlib>
+#include <vector>
+#include "../src/filter/PointBatch.hpp"
+#include "../src/filter/PointMask.hpp"
+#include "../src/filter/PointFilterChain.hpp"
+#include "../src/filter/QualityFilter.hpp"
+#include "../src/filter/IntensityFilter.hpp"
+#include "../src/filter/InsanePositionFilter.hpp"
+#include "../src/filter/SpatialOutlierFilter.hpp"
+
+/**A filter only answering one point at a time, counting the points it is asked about*/
+class EvenTimestampFilter : public PointFilter {
+public:
+
+    bool filterPoint(uint64_t microEpoch, double x, double y, double z, uint32_t quality, uint32_t intensity) {
+        nbCalls++;
+        return microEpoch % 2 == 0;
+    }
+
+    unsigned int nbCalls = 0;
+};
+
+TEST_CASE("Batch point filters agree with per point filters") {
+    PointBatch batch;
+    srand(3);
+
+    //not a multiple of 64, so the last word of the mask is partial
+    for (unsigned int i = 0; i < 1000; i++) {
+        double x = (rand() % 10 == 0) ? 2e8 : rand() % 1000;
+        double z = (rand() % 20 == 0) ? -3e8 : -(rand() % 100);
+        batch.add(i, x, rand() % 1000, z, rand() % 12, rand() % 12);
+    }
+
+    QualityFilter quality(6);
+    IntensityFilter intensity(4);
+    InsanePositionFilter insane;
+    EvenTimestampFilter even;
+
+    PointFilter * filters[] = {&quality, &intensity, &insane, &even};
+
+    for (unsigned int f = 0; f < 4; f++) {
+        PointMask mask;
+        mask.reset(batch.size());
+        filters[f]->filterBatch(batch, mask);
+
+        unsigned int nbRejected = 0;
+
+        for (unsigned int i = 0; i < batch.size(); i++) {
+            bool expected = filters[f]->filterPoint(batch.microEpochs[i], batch.x[i], batch.y[i], batch.z[i], batch.quality[i], batch.intensity[i]);
+            REQUIRE(mask.isRejected(i) == expected);
+            nbRejected += expected ? 1 : 0;
+        }
+
+        REQUIRE(mask.getNumberOfRejected() == nbRejected);
+    }
+
+    //a chain rejects what any of its filters rejects
+    PointFilterChain chain;
+    chain.add(&insane);
+    chain.add(&quality);
+    chain.add(&intensity);
+
+    PointMask mask;
+    mask.reset(batch.size());
+    chain.filterBatch(batch, mask);
+
+    for (unsigned int i = 0; i < batch.size(); i++) {
+        REQUIRE(mask.isRejected(i) == chain.filterPoint(batch.microEpochs[i], batch.x[i], batch.y[i], batch.z[i], batch.quality[i], batch.intensity[i]));
+    }
+}
+
+TEST_CASE("Point filter chain short-circuits per batch") {
+    PointBatch batch;
+
+    for (unsigned int i = 0; i < 100; i++) {
+        batch.add(i, 0, 0, 0, i % 2, 5);
+    }
+
+    QualityFilter quality(1);
+    IntensityFilter intensity(10);
+    EvenTimestampFilter even;
+
+    //the adapter does not ask about points already rejected
+    PointFilterChain chain;
+    chain.add(&quality);
+    chain.add(&even);
+
+    PointMask mask;
+    mask.reset(batch.size());
+    chain.filterBatch(batch, mask);
+
+    REQUIRE(even.nbCalls == 50);
+    REQUIRE(mask.getNumberOfRejected() == 50);
+    REQUIRE_FALSE(mask.allRejected());
+
+    //once every point is rejected, the next filters are skipped
+    PointFilterChain nested;
+    nested.add(&intensity);
+    nested.add(&chain);
+
+    even.nbCalls = 0;
+    mask.reset(batch.size());
+    nested.filterBatch(batch, mask);
+
+    REQUIRE(mask.allRejected());
+    REQUIRE(mask.getNumberOfRejected() == 100);
+    REQUIRE(even.nbCalls == 0);
+}
+
+/**Adds a noisy sloped seafloor to a batch, with a spike every 97 points*/
+static void addSlopedSwath(PointBatch & batch, unsigned int firstPing, unsigned int nbPings, std::vector<bool> & spikes) {
+    for (unsigned int ping = firstPing; ping < firstPing + nbPings; ping++) {
+        for (unsigned int beam = 0; beam < 100; beam++) {
+            double x = beam * 0.2;
+            double y = ping * 0.5;
+            double z = 20 + 0.3 * x - 0.1 * y + ((double) rand() / RAND_MAX - 0.5) * 0.1;
+            bool spike = (batch.size() + spikes.size()) % 97 == 50;
+
+            if (spike) {
+                z += (rand() % 2) ? 5 : -5;
+            }
+
+            spikes.push_back(spike);
+            batch.add(ping, x, y, z, 0, 0);
+        }
+    }
+}
+
+TEST_CASE("Spatial outlier filter removes spikes") {
+    srand(11);
+
+    PointBatch batch;
+    std::vector<bool> spikes;
+    addSlopedSwath(batch, 0, 40, spikes);
+
+    OutlierSurface surfaces[] = {SURFACE_MEDIAN, SURFACE_PLANE};
+
+    for (unsigned int s = 0; s < 2; s++) {
+        unsigned int nbThreads[] = {1, 4};
+        PointMask masks[2];
+
+        for (unsigned int t = 0; t < 2; t++) {
+            SpatialOutlierFilter filter(2.0, 4.0, surfaces[s], 5, 20000, nbThreads[t]);
+            masks[t].reset(batch.size());
+            filter.filterBatch(batch, masks[t]);
+        }
+
+        unsigned int nbFalseRejections = 0;
+
+        for (unsigned int i = 0; i < batch.size(); i++) {
+            //threads do not change the result
+            REQUIRE(masks[0].isRejected(i) == masks[1].isRejected(i));
+
+            if (spikes[i]) {
+                REQUIRE(masks[0].isRejected(i));
+            }
+            else if (masks[0].isRejected(i)) {
+                nbFalseRejections++;
+            }
+        }
+
+        //the slope across a cell is larger than the noise: only the plane follows it
+        if (surfaces[s] == SURFACE_PLANE) {
+            REQUIRE(nbFalseRejections < batch.size() / 200);
+        }
+    }
+
+    //points already rejected are not judged again
+    SpatialOutlierFilter filter(2.0);
+    PointMask mask;
+    mask.reset(batch.size());
+    mask.reject(0);
+    filter.filterBatch(batch, mask);
+    REQUIRE(mask.isRejected(0));
+}
+
+TEST_CASE("Spatial outlier filter keeps context across batches") {
+    srand(12);
+
+    //a single point per batch is judged against the window of the points accepted before it
+    SpatialOutlierFilter filter(2.0, 3.0, SURFACE_PLANE);
+
+    PointBatch batch;
+    std::vector<bool> spikes;
+    addSlopedSwath(batch, 0, 10, spikes);
+
+    PointMask mask;
+    mask.reset(batch.size());
+    filter.filterBatch(batch, mask);
+
+    REQUIRE(filter.filterPoint(0, 1.1, 2.1, 20 + 0.3 * 1.1 - 0.1 * 2.1 + 5, 0, 0));
+    REQUIRE_FALSE(filter.filterPoint(0, 1.1, 2.1, 20 + 0.3 * 1.1 - 0.1 * 2.1, 0, 0));
+
+    //a new filter has no context, and too few points to judge
+    SpatialOutlierFilter empty(2.0, 3.0, SURFACE_PLANE);
+    REQUIRE_FALSE(empty.filterPoint(0, 1.1, 2.1, 1000, 0, 0));
+}
+
+#endif /* POINTFILTERTEST_HPP */
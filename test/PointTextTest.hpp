@@ -0,0 +1,153 @@
+/*
+ * Copyright 2020 © Centre Interdisciplinaire de développement en Cartographie des Océans (CIDCO), Tous droits réservés
+ */
+
+/*
+ * File:   PointTextTest.hpp
+ */
+
+#ifndef POINTTEXTTEST_HPP
+#define POINTTEXTTEST_HPP
+
+#include "catch.hpp"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include "../src/utils/PointTextReader.hpp"
+#include "../src/utils/PointTextWriter.hpp"
+
+TEST_CASE("Point text numbers parse like sscanf") {
+    const char * numbers[] = {
+        "0", "-0", "1", "-1.5", "+2.25", ".5", "5.", "123456.789012", "-6378137.123456789",
+        "1e5", "1E-5", "2.5e+3", "0.000000000000000000000000001", "12345678901234567890.5",
+        "3.14159265358979323846", "1e300", "4.9e-324", "inf", "-nan", "0x1p3", "48.123456789"
+    };
+
+    for (unsigned int i = 0; i < sizeof(numbers) / sizeof(numbers[0]); i++) {
+        const char * text = numbers[i];
+        const char * p = text;
+        double value;
+        double expected;
+
+        REQUIRE(sscanf(text, "%lf", &expected) == 1);
+        REQUIRE(PointTextReader::parseDouble(p, text + strlen(text), value));
+        REQUIRE(p == text + strlen(text));
+
+        if (expected == expected) {
+            REQUIRE(memcmp(&value, &expected, sizeof(double)) == 0);
+        }
+        else {
+            REQUIRE(value != value);
+        }
+    }
+
+    //random decimals round exactly as strtod does
+    srand(42);
+
+    for (unsigned int i = 0; i < 10000; i++) {
+        char text[64];
+        snprintf(text, sizeof(text), "%.*f", rand() % 10, (rand() - RAND_MAX / 2) / 97.0);
+
+        const char * p = text;
+        double value;
+        REQUIRE(PointTextReader::parseDouble(p, text + strlen(text), value));
+        REQUIRE(value == strtod(text, NULL));
+    }
+
+    const char * invalid = "  abc";
+    const char * p = invalid;
+    double value;
+    REQUIRE_FALSE(PointTextReader::parseDouble(p, invalid + strlen(invalid), value));
+
+    int64_t integer;
+    const char * integers = " -12 7.5";
+    p = integers;
+    REQUIRE(PointTextReader::parseInteger(p, integers + strlen(integers), integer));
+    REQUIRE(integer == -12);
+    REQUIRE(PointTextReader::parseInteger(p, integers + strlen(integers), integer));
+    REQUIRE(integer == 7);
+    REQUIRE_FALSE(PointTextReader::parseInteger(p, integers + strlen(integers), integer));
+}
+
+TEST_CASE("Point text reader reads lines across blocks") {
+    FILE * file = tmpfile();
+    REQUIRE(file != NULL);
+
+    fputs("1.5 2.5 3.5 7 9\n", file);
+    fputs("not a point\n", file);
+    fputs("  -10.25\t20 30 8 10 extra\r\n", file);
+    fputs("40.123456789012 50 60 1 2\n", file);
+    fputs("0\n", file);
+    fputs("70 80 90 3 4\n", file);
+    rewind(file);
+
+    //a tiny buffer splits lines and has to grow
+    PointTextReader reader(file, 8);
+    PointBatch batch;
+
+    REQUIRE(reader.read(batch, 2));
+    REQUIRE(batch.size() == 2);
+    REQUIRE(batch.x[0] == 1.5);
+    REQUIRE(batch.intensity[0] == 9);
+    REQUIRE(batch.x[1] == -10.25);
+    REQUIRE(batch.quality[1] == 8);
+
+    REQUIRE(reader.read(batch, 2));
+    REQUIRE(batch.size() == 1);
+    REQUIRE(batch.x[0] == 40.123456789012);
+    REQUIRE(batch.z[0] == 60);
+
+    //the line holding "0" ends the input
+    REQUIRE_FALSE(reader.read(batch, 2));
+    REQUIRE(reader.getNumberOfLines() == 5);
+
+    fclose(file);
+}
+
+TEST_CASE("Point text writer formats like printf") {
+    srand(7);
+
+    double values[] = {0.0, -0.0, 0.5, -0.0000004, 0.0000005, 0.0000015, 1.0000005, 9999999.9999995, 1e7, -1e12, 6378137.123456789, 1e300};
+
+    for (unsigned int i = 0; i < 100000 + sizeof(values) / sizeof(values[0]); i++) {
+        double value;
+
+        if (i < sizeof(values) / sizeof(values[0])) {
+            value = values[i];
+        }
+        else {
+            value = ((double) rand() / RAND_MAX - 0.5) * pow(10.0, rand() % 16 - 6);
+        }
+
+        char expected[400];
+        snprintf(expected, sizeof(expected), "%.6lf", value);
+
+        char written[400];
+        char * end = PointTextWriter::appendFixed(written, value);
+        *end = 0;
+
+        REQUIRE(std::string(written) == std::string(expected));
+    }
+
+    FILE * file = tmpfile();
+    REQUIRE(file != NULL);
+
+    {
+        PointTextWriter writer(file, 16);
+        writer.write(1.5, -2.25, 3, 7, 4294967295u);
+        writer.write(4, 5, 6, 1, 2);
+    }
+
+    rewind(file);
+
+    char line[128];
+    REQUIRE(fgets(line, sizeof(line), file) != NULL);
+    REQUIRE(std::string(line) == "1.500000 -2.250000 3.000000 7 -1\n");
+    REQUIRE(fgets(line, sizeof(line), file) != NULL);
+    REQUIRE(std::string(line) == "4.000000 5.000000 6.000000 1 2\n");
+
+    fclose(file);
+}
+
+#endif /* POINTTEXTTEST_HPP */
@@ -154,3 +154,261 @@ TEST_CASE("test S7k file that has 1012 and 1013 packets for attitude") {
     
     REQUIRE(handler.getNumberOfAttitudes() == 1102);
 }
+
+TEST_CASE("S7k sonar settings are matched by ping number and only kept for a bounded number of pings") {
+    S7kSonarSettingsTable table(4);
+
+    S7kSonarSettings settings;
+    memset(&settings, 0, sizeof (S7kSonarSettings));
+
+    for (uint32_t pingNumber = 10; pingNumber < 16; pingNumber++) {
+        settings.sequentialNumber = pingNumber;
+        settings.soundVelocity = 1400 + pingNumber;
+        table.add(settings, 0);
+    }
+
+    //pings 10 and 11 were overwritten by 14 and 15
+    REQUIRE(table.getCapacity() == 4);
+    REQUIRE(table.size() == 4);
+
+    REQUIRE(table.find(10, 0) == NULL);
+    REQUIRE(table.find(11, 0) == NULL);
+
+    S7kSonarSettings * found = table.find(13, 0);
+    REQUIRE(found != NULL);
+    REQUIRE(found->sequentialNumber == 13);
+    REQUIRE(found->soundVelocity == 1413);
+
+    //left for the other records of the ping
+    REQUIRE(table.find(13, 0) == found);
+    REQUIRE(table.size() == 4);
+}
+
+TEST_CASE("S7k sonar settings of the heads of a multi-head system share ping numbers") {
+    S7kSonarSettingsTable table(4);
+
+    S7kDataRecordFrame drf;
+    memset(&drf, 0, sizeof (drf));
+    drf.DeviceIdentifier = 7125;
+
+    S7kSonarSettings settings;
+    memset(&settings, 0, sizeof (S7kSonarSettings));
+    settings.sequentialNumber = 20;
+
+    drf.SystemEnumerator = 0;
+    uint64_t port = S7kSonarSettingsTable::getDevice(drf);
+    settings.soundVelocity = 1480;
+    table.add(settings, port);
+
+    drf.SystemEnumerator = 1;
+    uint64_t starboard = S7kSonarSettingsTable::getDevice(drf);
+    settings.soundVelocity = 1490;
+    table.add(settings, starboard);
+
+    REQUIRE(port != starboard);
+    REQUIRE(table.size() == 2);
+    REQUIRE(table.find(20, port)->soundVelocity == 1480);
+    REQUIRE(table.find(20, starboard)->soundVelocity == 1490);
+
+    //the next use of the slot evicts both heads
+    settings.sequentialNumber = 24;
+    table.add(settings, port);
+
+    REQUIRE(table.size() == 1);
+    REQUIRE(table.find(20, port) == NULL);
+    REQUIRE(table.find(20, starboard) == NULL);
+    REQUIRE(table.find(24, port) != NULL);
+}
+
+TEST_CASE("test the S7k water column records, decoded on demand or skipped") {
+
+    class WaterColumnCounter : public DatagramEventHandler {
+    public:
+        WaterColumnCounter(bool wanted) : wanted(wanted) {
+        }
+
+        bool wantsWaterColumn() {
+            return wanted;
+        }
+
+        void processDatagramTag(int id) {
+            tags.push_back(id);
+        }
+
+        void processWaterColumn(WaterColumnRecord & record) {
+            pingNumbers.push_back(record.getPingNumber());
+            nbBeams.push_back(record.getNumberOfBeams());
+            nbSamples.push_back(record.getNumberOfSamples(1));
+
+            std::vector<float> a;
+            record.getAmplitudes(1, a);
+            amplitudes.push_back(a);
+        }
+
+        bool wanted;
+        std::vector<int> tags;
+        std::vector<uint32_t> pingNumbers;
+        std::vector<unsigned int> nbBeams, nbSamples;
+        std::vector<std::vector<float> > amplitudes;
+    };
+
+    //7018: 2 beams of 3 samples, stored sample by sample
+    std::vector<unsigned char> beamformed(sizeof (S7kBeamformedRTH) + 6 * sizeof (S7kBeamformedSample), 0);
+    S7kBeamformedRTH * rth = (S7kBeamformedRTH *) & beamformed[0];
+    rth->pingNumber = 42;
+    rth->nbBeams = 2;
+    rth->nbSamples = 3;
+    S7kBeamformedSample * samples = (S7kBeamformedSample *) (&beamformed[0] + sizeof (S7kBeamformedRTH));
+
+    for (unsigned int i = 0; i < 6; i++) {
+        samples[i].amplitude = 10 * i;
+    }
+
+    //7042: 2 beams of 8 bit magnitudes with a segment number, of 1 and 2 samples
+    std::vector<unsigned char> compressed(sizeof (S7kCompressedWaterColumnRTH) + 2 * 7 + 3, 0);
+    S7kCompressedWaterColumnRTH * crth = (S7kCompressedWaterColumnRTH *) & compressed[0];
+    crth->pingNumber = 43;
+    crth->nbBeams = 2;
+    crth->flags = S7K_WC_MAGNITUDE_ONLY | S7K_WC_8_BITS | S7K_WC_SEGMENT_NUMBERS;
+    unsigned char * p = &compressed[0] + sizeof (S7kCompressedWaterColumnRTH);
+    uint32_t one = 1, two = 2;
+    memcpy(p + 3, &one, 4);
+    p[7] = 200;
+    p += 8;
+    p[0] = 1; //beam number
+    memcpy(p + 3, &two, 4);
+    p[7] = 15;
+    p[8] = 16;
+
+    std::string filename("build/test/watercolumn.s7k");
+    FILE * file = fopen(filename.c_str(), "wb");
+    REQUIRE(file != NULL);
+
+    std::vector<unsigned char> * records[2] = {&beamformed, &compressed};
+    uint32_t types[2] = {7018, 7042};
+
+    for (unsigned int i = 0; i < 2; i++) {
+        S7kDataRecordFrame drf;
+        memset(&drf, 0, sizeof (drf));
+        drf.SyncPattern = SYNC_PATTERN;
+        drf.Size = sizeof (S7kDataRecordFrame) + records[i]->size() + sizeof (uint32_t);
+        drf.RecordTypeIdentifier = types[i];
+        drf.Timestamp.Year = 2020;
+        drf.Timestamp.Day = 1;
+
+        uint32_t checksum = 0;
+
+        fwrite(&drf, sizeof (drf), 1, file);
+        fwrite(&(*records[i])[0], records[i]->size(), 1, file);
+        fwrite(&checksum, sizeof (checksum), 1, file);
+    }
+
+    fclose(file);
+
+    WaterColumnCounter skipper(false);
+    S7kParser skipping(skipper);
+    skipping.parse(filename, true);
+
+    REQUIRE(skipper.tags.size() == 2);
+    REQUIRE(skipper.tags[1] == 7042);
+    REQUIRE(skipper.pingNumbers.empty());
+
+    WaterColumnCounter reader(true);
+    S7kParser reading(reader);
+    reading.parse(filename, true);
+
+    remove(filename.c_str());
+
+    REQUIRE(reader.pingNumbers.size() == 2);
+    REQUIRE(reader.pingNumbers[0] == 42);
+    REQUIRE(reader.nbBeams[0] == 2);
+    REQUIRE(reader.nbSamples[0] == 3);
+    REQUIRE(reader.amplitudes[0] == std::vector<float>({10, 30, 50}));
+
+    REQUIRE(reader.pingNumbers[1] == 43);
+    REQUIRE(reader.nbBeams[1] == 2);
+    REQUIRE(reader.nbSamples[1] == 2);
+    REQUIRE(reader.amplitudes[1] == std::vector<float>({15, 16}));
+}
+
+TEST_CASE("S7k water column records recorded after the detections of their ping get its settings") {
+
+    class Recorder : public DatagramEventHandler {
+    public:
+
+        bool wantsWaterColumn() {
+            return true;
+        }
+
+        void processPing(uint64_t microEpoch, long id, double beamAngle, double tiltAngle, double twoWayTravelTime, uint32_t quality, int32_t intensity) {
+            nbPings++;
+        }
+
+        void processWaterColumn(WaterColumnRecord & record) {
+            soundSpeeds.push_back(record.getSoundSpeed());
+            samplingFrequencies.push_back(record.getSamplingFrequency());
+        }
+
+        unsigned int nbPings = 0;
+        std::vector<double> soundSpeeds, samplingFrequencies;
+    };
+
+    //7000
+    std::vector<unsigned char> settingsRecord(sizeof (S7kSonarSettings), 0);
+    S7kSonarSettings * settings = (S7kSonarSettings *) & settingsRecord[0];
+    settings->sequentialNumber = 42;
+    settings->sampleRate = 34000;
+    settings->soundVelocity = 1485;
+
+    //7027 with one detection
+    std::vector<unsigned char> detections(sizeof (S7kRawDetectionDataRTH) + sizeof (S7kRawDetectionDataRD), 0);
+    S7kRawDetectionDataRTH * swath = (S7kRawDetectionDataRTH *) & detections[0];
+    swath->pingNumber = 42;
+    swath->numberOfDetectionPoints = 1;
+    swath->dataFieldSize = sizeof (S7kRawDetectionDataRD);
+    swath->samplingRate = 34000;
+
+    //7018 with one beam of one sample
+    std::vector<unsigned char> beamformed(sizeof (S7kBeamformedRTH) + sizeof (S7kBeamformedSample), 0);
+    S7kBeamformedRTH * rth = (S7kBeamformedRTH *) & beamformed[0];
+    rth->pingNumber = 42;
+    rth->nbBeams = 1;
+    rth->nbSamples = 1;
+
+    std::string filename("build/test/settingsorder.s7k");
+    FILE * file = fopen(filename.c_str(), "wb");
+    REQUIRE(file != NULL);
+
+    std::vector<unsigned char> * records[3] = {&settingsRecord, &detections, &beamformed};
+    uint32_t types[3] = {7000, 7027, 7018};
+
+    for (unsigned int i = 0; i < 3; i++) {
+        S7kDataRecordFrame drf;
+        memset(&drf, 0, sizeof (drf));
+        drf.SyncPattern = SYNC_PATTERN;
+        drf.Size = sizeof (S7kDataRecordFrame) + records[i]->size() + sizeof (uint32_t);
+        drf.RecordTypeIdentifier = types[i];
+        drf.DeviceIdentifier = 7125;
+        drf.Timestamp.Year = 2020;
+        drf.Timestamp.Day = 1;
+
+        uint32_t checksum = 0;
+
+        fwrite(&drf, sizeof (drf), 1, file);
+        fwrite(&(*records[i])[0], records[i]->size(), 1, file);
+        fwrite(&checksum, sizeof (checksum), 1, file);
+    }
+
+    fclose(file);
+
+    Recorder recorder;
+    S7kParser parser(recorder);
+    parser.parse(filename, true);
+
+    remove(filename.c_str());
+
+    REQUIRE(recorder.nbPings == 1);
+    REQUIRE(recorder.soundSpeeds.size() == 1);
+    REQUIRE(recorder.soundSpeeds[0] == 1485);
+    REQUIRE(recorder.samplingFrequencies[0] == 34000);
+}
@@ -54,5 +54,56 @@ TEST_CASE("Georeferencing Side Scan No LeverArm No Layback test") {
     REQUIRE(std::abs(objectPosition.getEllipsoidalHeight() - objectHeight) < heightTrashold);
 }
 
+TEST_CASE("Georeferencing a whole side scan ping") {
+    Position antenna(0, 48.5, -68.5, 10.0);
+    Eigen::Vector3d leverArm(1, 2, 3);
+
+    double heading = 30;
+    double layback = 25;
+    double spacing = 0.1;
+
+    SideScanSamplePositions positions;
+    SideScanGeoreferencing::georeferenceSideScanPing(antenna, leverArm, layback, heading, spacing, 300, 200, positions, true);
+
+    REQUIRE(positions.size() == 500);
+    REQUIRE(positions.nbPortSamples == 300);
+    REQUIRE(positions.hasGeodetic());
+
+    //every sample agrees with the single point georeferencing
+    Eigen::Vector3d antennaEcef;
+    CoordinateTransform::getPositionECEF(antennaEcef, antenna);
+
+    Eigen::Matrix3d ned2ecef;
+    CoordinateTransform::ned2ecef(ned2ecef, antenna);
+
+    double ch = cos(heading * D2R);
+    double sh = sin(heading * D2R);
+    Eigen::Vector3d laybackEcef = ned2ecef * Eigen::Vector3d(-layback * ch, -layback * sh, 0);
+
+    unsigned int samples[] = {0, 150, 299, 300, 420, 499};
+
+    for (unsigned int k = 0; k < 6; k++) {
+        unsigned int i = samples[k];
+        double distance = (i < 300) ? -(double) i * spacing : (double) (i - 300) * spacing;
+        Eigen::Vector3d sideDistanceEcef = ned2ecef * Eigen::Vector3d(-sh * distance, ch * distance, 0);
+
+        Position expected(0, 0, 0, 0);
+        SideScanGeoreferencing::georeferenceSideScanEcef(antennaEcef, leverArm, laybackEcef, sideDistanceEcef, expected);
+
+        REQUIRE(positions.latitudes[i] == Approx(expected.getLatitude()).epsilon(1e-12));
+        REQUIRE(positions.longitudes[i] == Approx(expected.getLongitude()).epsilon(1e-12));
+        REQUIRE(positions.heights[i] == Approx(expected.getEllipsoidalHeight()).margin(1e-6));
+    }
+
+    //the far port sample is 29.9 m to port of the towfish
+    Eigen::Vector3d port(positions.x[299] - positions.x[0], positions.y[299] - positions.y[0], positions.z[299] - positions.z[0]);
+    REQUIRE(port.norm() == Approx(29.9));
+
+    //geodetic coordinates are optional
+    SideScanGeoreferencing::georeferenceSideScanPing(antenna, leverArm, layback, heading, spacing, 10, 0, positions);
+    REQUIRE(positions.size() == 10);
+    REQUIRE_FALSE(positions.hasGeodetic());
+}
+
 #endif /* SIDESCANGEOREFERENCINGTEST_HPP */
 
@@ -0,0 +1,158 @@
+/*
+ * Copyright 2020 © Centre Interdisciplinaire de développement en Cartographie des Océans (CIDCO), Tous droits réservés
+ */
+
+/*
+ * File:   SidescanMosaicTest.hpp
+ */
+
+#ifndef SIDESCANMOSAICTEST_HPP
+#define SIDESCANMOSAICTEST_HPP
+
+#include "catch.hpp"
+#include <vector>
+#include <limits>
+#include "../src/sidescan/SidescanMosaic.hpp"
+#include "../src/sidescan/SidescanMosaicker.hpp"
+#include "../src/datagrams/xtf/XtfParser.hpp"
+
+TEST_CASE("Sidescan mosaic blending") {
+    double value;
+
+    SidescanMosaic last(1.0, BLEND_LAST);
+    SidescanMosaic max(1.0, BLEND_MAX);
+    SidescanMosaic average(1.0, BLEND_AVERAGE);
+
+    float samples[] = {4, 10, 1};
+
+    for (unsigned int i = 0; i < 3; i++) {
+        last.add(-0.5, -300.2, samples[i]);
+        max.add(-0.5, -300.2, samples[i]);
+        average.add(-0.5, -300.2, samples[i]);
+    }
+
+    REQUIRE(last.getValue(-0.1, -300.9, value));
+    REQUIRE(value == 1);
+
+    REQUIRE(max.getValue(-0.1, -300.9, value));
+    REQUIRE(value == 10);
+
+    REQUIRE(average.getValue(-0.1, -300.9, value));
+    REQUIRE(value == Approx(5));
+
+    //neighbouring cells stay empty
+    REQUIRE_FALSE(average.getValue(0.5, -300.9, value));
+    REQUIRE_FALSE(average.getValue(-0.1, -299.9, value));
+    REQUIRE_FALSE(average.getValue(1000, 1000, value));
+
+    REQUIRE(average.getNumberOfTiles() == 1);
+}
+
+TEST_CASE("Sidescan pings are laid out across track") {
+    SidescanMosaic mosaic(1.0, BLEND_LAST);
+    SidescanMosaicker mosaicker(mosaic, 2, 3);
+
+    //heading north, port to the west and starboard to the east, towfish 10.5 m behind
+    for (int channel = 0; channel < 2; channel++) {
+        SidescanPing * ping = new SidescanPing();
+        ping->setChannelNumber(channel);
+        ping->setPosition(new Position(0, 48.5, -68.5, 0));
+        ping->setAttitude(new Attitude(0, 0, 0, 0));
+        ping->setDistancePerSample(1.25);
+        ping->setLayback(10.5);
+
+        std::vector<uint16_t> samples;
+        for (unsigned int i = 0; i < 50; i++) {
+            samples.push_back((channel + 1) * 100 + i);
+        }
+        ping->setSamples(std::move(samples));
+
+        mosaicker.processSidescanData(ping);
+    }
+
+    mosaicker.flush();
+
+    REQUIRE(mosaicker.getNumberOfPings() == 2);
+    REQUIRE(mosaicker.getNumberOfSamples() == 100);
+
+    double value;
+    REQUIRE(mosaic.getValue(-10.5, 12.5, value));
+    REQUIRE(value == 210);
+    REQUIRE(mosaic.getValue(-10.5, -37.5, value));
+    REQUIRE(value == 130);
+    REQUIRE_FALSE(mosaic.getValue(0.5, 12.5, value));
+}
+
+TEST_CASE("Sidescan zero samples are mosaicked, missing ones are not") {
+    SidescanMosaic mosaic(1.0, BLEND_LAST);
+    SidescanMosaicker mosaicker(mosaic, 2, 1);
+
+    //one ping per batch, so every ping goes through the workers again
+    for (unsigned int p = 0; p < 3; p++) {
+        SidescanPing * ping = new SidescanPing();
+        ping->setChannelNumber(1);
+        ping->setPosition(new Position(0, 48.5, -68.5, 0));
+        ping->setAttitude(new Attitude(0, 0, 0, 0));
+        ping->setDistancePerSample(1.25);
+        ping->setLayback(0.5);
+
+        std::vector<float> samples(10, 0);
+        samples[5] = std::numeric_limits<float>::quiet_NaN();
+        ping->setSamples(std::move(samples));
+
+        mosaicker.processSidescanData(ping);
+    }
+
+    mosaicker.flush();
+
+    REQUIRE(mosaicker.getNumberOfPings() == 3);
+    REQUIRE(mosaicker.getNumberOfSamples() == 27);
+
+    double value;
+    REQUIRE(mosaic.getValue(-0.5, 1.5, value));
+    REQUIRE(value == 0);
+    REQUIRE(mosaic.getValue(-0.5, 5.5, value));
+    REQUIRE_FALSE(mosaic.getValue(-0.5, 6.5, value));
+}
+
+TEST_CASE("Sidescan mosaic does not depend on the number of threads") {
+
+    class MosaicBuilder {
+    public:
+        MosaicBuilder(unsigned int nbThreads) : mosaic(0.5, BLEND_LAST), mosaicker(mosaic, nbThreads, 100) {
+            std::string file("test/data/xtf/Line-001-0856.sidescan.xtf");
+            XtfParser parser(mosaicker);
+            parser.parse(file);
+            mosaicker.flush();
+        }
+
+        SidescanMosaic mosaic;
+        SidescanMosaicker mosaicker;
+    };
+
+    MosaicBuilder single(1);
+    MosaicBuilder parallel(4);
+
+    REQUIRE(single.mosaicker.getNumberOfPings() > 0);
+    REQUIRE(parallel.mosaicker.getNumberOfSamples() == single.mosaicker.getNumberOfSamples());
+    REQUIRE(parallel.mosaic.getNumberOfTiles() == single.mosaic.getNumberOfTiles());
+
+    bool identical = true;
+
+    for (unsigned int shard = 0; shard < SidescanMosaic::NB_SHARDS; shard++) {
+        auto & tiles = single.mosaic.getShardTiles(shard);
+        auto & otherTiles = parallel.mosaic.getShardTiles(shard);
+
+        for (auto i = tiles.begin(); i != tiles.end(); i++) {
+            auto other = otherTiles.find(i->first);
+
+            if (other == otherTiles.end() || other->second->values != i->second->values || other->second->counts != i->second->counts) {
+                identical = false;
+            }
+        }
+    }
+
+    REQUIRE(identical);
+}
+
+#endif /* SIDESCANMOSAICTEST_HPP */
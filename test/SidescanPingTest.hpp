@@ -75,10 +75,54 @@ TEST_CASE("SidescanPing test") {
     
     REQUIRE(ping.getTimestamp() == testTimestamp);
     
+    //samples are copied into the ping, unless moved
+    REQUIRE(testSampleVector.size() == 2);
+    
+    ping.setSamples(std::move(testSampleVector));
+    REQUIRE(ping.getNumberOfSamples() == 2);
+    REQUIRE(testSampleVector.size() == 0);
+    
     //delete position;
     //delete attitude;
 }
 
+TEST_CASE("SidescanPing typed samples") {
+    SidescanPing ping;
+    
+    std::vector<uint16_t> samples;
+    samples.push_back(12);
+    samples.push_back(65000);
+    
+    ping.setSamples(std::move(samples));
+    
+    REQUIRE(samples.size() == 0);
+    REQUIRE(ping.getSampleType() == SAMPLE_UINT16);
+    REQUIRE(ping.getNumberOfSamples() == 2);
+    REQUIRE(ping.getSample(1) == 65000);
+    REQUIRE(ping.getTypedSamples<uint16_t>()[0] == 12);
+    REQUIRE(ping.getSamplesMemory() < 2 * sizeof(double));
+    
+    //wrong type
+    REQUIRE_THROWS(ping.getTypedSamples<float>());
+    
+    //widening to double, in a copy
+    std::vector<double> widened;
+    ping.copySamples(widened);
+    REQUIRE(ping.getSampleType() == SAMPLE_UINT16);
+    REQUIRE(widened.size() == 2);
+    REQUIRE(widened[1] == 65000.0);
+    
+    //widening to double, for good
+    REQUIRE(ping.getSamples().size() == 2);
+    REQUIRE(ping.getSamples()[1] == 65000.0);
+    REQUIRE(ping.getSampleType() == SAMPLE_DOUBLE);
+    REQUIRE_THROWS(ping.getTypedSamples<uint16_t>());
+    
+    std::vector<float> & floats = ping.allocateSamples<float>(3);
+    REQUIRE(floats.size() == 3);
+    REQUIRE(ping.getSampleType() == SAMPLE_FLOAT);
+    REQUIRE(ping.getNumberOfSamples() == 3);
+}
 
 #endif /* SIDESCANPINGTEST_HPP */
 
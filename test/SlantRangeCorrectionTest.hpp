@@ -0,0 +1,76 @@
+/*
+ * Copyright 2020 © Centre Interdisciplinaire de développement en Cartographie des Océans (CIDCO), Tous droits réservés
+ */
+
+/*
+ * File:   SlantRangeCorrectionTest.hpp
+ */
+
+#ifndef SLANTRANGECORRECTIONTEST_HPP
+#define SLANTRANGECORRECTIONTEST_HPP
+
+#include "catch.hpp"
+#include <vector>
+#include "../src/math/SlantRangeCorrection.hpp"
+
+TEST_CASE("Slant range remap fills every ground range bin") {
+    std::vector<uint16_t> samples(100, 500);
+    std::vector<uint16_t> out;
+
+    SlantRangeCorrection::correct(samples, 50, 0, 30, out);
+
+    //sin(30) * 100 bins
+    REQUIRE(out.size() == 50);
+
+    for (unsigned int i = 0; i < out.size(); i++) {
+        REQUIRE(out[i] == 500);
+    }
+}
+
+TEST_CASE("Slant range remap interpolates between slant range samples") {
+    std::vector<double> samples;
+
+    for (unsigned int i = 0; i < 10; i++) {
+        samples.push_back(i * 10.0);
+    }
+
+    SlantRangeRemapPlan plan(10, 30);
+    std::vector<double> out;
+    plan.apply(samples.data(), out);
+
+    REQUIRE(plan.getNumberOfBins() == 5);
+    REQUIRE(out[0] == Approx(0));
+    REQUIRE(out[1] == Approx(20));
+    REQUIRE(out[4] == Approx(80));
+
+    //integers are rounded: bin 1 falls halfway between samples 1 and 2
+    std::vector<uint8_t> bytes;
+    bytes.push_back(0);
+    bytes.push_back(1);
+    bytes.push_back(2);
+    std::vector<uint8_t> byteOut;
+    SlantRangeRemapPlan(3, asin(2.0 / 3.0) * 180 / M_PI).apply(bytes.data(), byteOut);
+    REQUIRE(byteOut.size() == 2);
+    REQUIRE(byteOut[1] == 2);
+}
+
+TEST_CASE("Slant range plans are reused for the same geometry") {
+    SlantRangeCorrection correction;
+
+    std::vector<float> samples(200, 1.0f);
+    std::vector<float> out;
+
+    correction.apply(samples, 80, 0, 45, out);
+    correction.apply(samples, 75, 0.01, 45, out);
+    REQUIRE(correction.getNumberOfPlans() == 1);
+
+    correction.apply(samples, 80, 5, 45, out);
+    REQUIRE(correction.getNumberOfPlans() == 2);
+
+    std::vector<float> other(100, 1.0f);
+    correction.apply(other, 80, 0, 45, out);
+    REQUIRE(correction.getNumberOfPlans() == 3);
+    REQUIRE(out.size() == 71);
+}
+
+#endif /* SLANTRANGECORRECTIONTEST_HPP */
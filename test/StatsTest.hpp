@@ -0,0 +1,153 @@
+/*
+ * Copyright 2020 © Centre Interdisciplinaire de développement en Cartographie des Océans (CIDCO), Tous droits réservés
+ */
+
+/*
+ * File:   StatsTest.hpp
+ */
+
+#ifndef STATSTEST_HPP
+#define STATSTEST_HPP
+
+#include "catch.hpp"
+#include <thread>
+#include <sstream>
+#include <string>
+#include "../src/utils/Stats.hpp"
+#include "../src/datagrams/DatagramParserFactory.hpp"
+
+/**Spins for a while, so that a stage takes measurable time*/
+static void spin(uint64_t nanoseconds) {
+    uint64_t start = Stats::now();
+
+    while (Stats::now() - start < nanoseconds) {
+    }
+}
+
+TEST_CASE("Nested stage timers count their time once") {
+    Stats::enable();
+    Stats::reset();
+
+    {
+        STATS_STAGE(STATS_GEOREFERENCING);
+        spin(1000000);
+
+        {
+            STATS_STAGE(STATS_RAYTRACING);
+            spin(10000000);
+        }
+
+        STATS_COUNT(STATS_PINGS, 3);
+    }
+
+    double georeferencing = Stats::getTime(STATS_GEOREFERENCING);
+    double raytracing = Stats::getTime(STATS_RAYTRACING);
+
+    Stats::disable();
+
+    REQUIRE(Stats::getCalls(STATS_GEOREFERENCING) == 1);
+    REQUIRE(Stats::getCalls(STATS_RAYTRACING) == 1);
+    REQUIRE(raytracing >= 0.01);
+    REQUIRE(georeferencing >= 0.001);
+    REQUIRE(georeferencing < 0.009);
+    REQUIRE(Stats::getCount(STATS_PINGS) == 3);
+
+    //nothing is collected while disabled
+    {
+        STATS_STAGE(STATS_OUTPUT);
+        STATS_COUNT(STATS_PINGS, 1);
+    }
+
+    REQUIRE(Stats::getCalls(STATS_OUTPUT) == 0);
+    REQUIRE(Stats::getCount(STATS_PINGS) == 3);
+}
+
+TEST_CASE("Stage timers of threads add up") {
+    Stats::enable();
+    Stats::reset();
+
+    std::vector<std::thread> workers;
+
+    for (unsigned int i = 0; i < 3; i++) {
+        workers.push_back(std::thread([]() {
+            STATS_STAGE(STATS_INTERPOLATION);
+            STATS_COUNT(STATS_POINTS_WRITTEN, 10);
+        }));
+    }
+
+    for (unsigned int i = 0; i < workers.size(); i++) {
+        workers[i].join();
+    }
+
+    Stats::disable();
+
+    REQUIRE(Stats::getCalls(STATS_INTERPOLATION) == 3);
+    REQUIRE(Stats::getCount(STATS_POINTS_WRITTEN) == 30);
+}
+
+TEST_CASE("Parsing a file counts its datagrams, bytes and stages") {
+    std::string fileName = "test/data/all/0008_20160909_135801_Panopee.all";
+
+    class TagCounter : public DatagramEventHandler {
+    public:
+        std::map<int, uint64_t> tags;
+
+        void processDatagramTag(int tag) {
+            tags[tag]++;
+        }
+    };
+
+    TagCounter counter;
+    DatagramParser * parser = DatagramParserFactory::build(fileName, counter);
+
+    Stats::enable();
+    Stats::reset();
+    parser->parse(fileName);
+    Stats::disable();
+
+    uint64_t nbDatagrams = 0;
+
+    for (std::map<int, uint64_t>::iterator i = counter.tags.begin(); i != counter.tags.end(); i++) {
+        REQUIRE(Stats::getDatagramCount(i->first) == i->second);
+        nbDatagrams += i->second;
+    }
+
+    REQUIRE(Stats::getCount(STATS_DATAGRAMS) == nbDatagrams);
+
+    FILE * file = fopen(fileName.c_str(), "rb");
+    fseek(file, 0, SEEK_END);
+    uint64_t fileSize = ftell(file);
+    fclose(file);
+
+    REQUIRE(Stats::getCount(STATS_BYTES_READ) + Stats::getCount(STATS_BYTES_SKIPPED) == fileSize);
+    REQUIRE(Stats::getCalls(STATS_PARSING) == 1);
+    REQUIRE(Stats::getCalls(STATS_TIME_CONVERSION) > 0);
+
+    //the summary and the JSON name the datagrams
+    std::ostringstream summary;
+    Stats::print(summary);
+    REQUIRE(summary.str().find("time conversion") != std::string::npos);
+    REQUIRE(summary.str().find(parser->getName('P')) != std::string::npos);
+
+    std::ostringstream json;
+    Stats::writeJson(json);
+    REQUIRE(json.str().find("\"datagrams\": " + std::to_string(nbDatagrams)) != std::string::npos);
+    REQUIRE(json.str().find("\"name\": \"" + parser->getName('P') + "\"") != std::string::npos);
+
+    delete parser;
+}
+
+TEST_CASE("The --stats option is taken out of the arguments") {
+    char tool[] = "tool";
+    char option[] = "-x";
+    char value[] = "1.5";
+    char file[] = "file.all";
+    char * argv[] = {tool, option, value, file, NULL};
+    int argc = 4;
+
+    REQUIRE_FALSE(Stats::parseArguments(argc, argv));
+    REQUIRE(argc == 4);
+    REQUIRE(std::string(argv[3]) == "file.all");
+}
+
+#endif /* STATSTEST_HPP */
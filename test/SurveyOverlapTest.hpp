@@ -0,0 +1,131 @@
+/*
+ * Copyright 2020 © Centre Interdisciplinaire de développement en Cartographie des Océans (CIDCO), Tous droits réservés
+ */
+
+/*
+ * File:   SurveyOverlapTest.hpp
+ */
+
+#ifndef SURVEYOVERLAPTEST_HPP
+#define SURVEYOVERLAPTEST_HPP
+
+#include "catch.hpp"
+#include <vector>
+#include <sstream>
+#include "../src/geometry/SurveyOverlap.hpp"
+
+/**Adds a grid of points to a line, in two batches so the hull is merged*/
+static void addGridOfPoints(SurveyOverlap & survey, unsigned int line, double x0, double y0, unsigned int nbColumns, unsigned int nbRows, bool count) {
+    std::vector<double> x, y;
+
+    for (unsigned int row = 0; row < nbRows; row++) {
+        for (unsigned int column = 0; column < nbColumns; column++) {
+            x.push_back(x0 + column);
+            y.push_back(y0 + row);
+        }
+    }
+
+    unsigned int half = x.size() / 2;
+
+    if (count) {
+        survey.countPoints(line, &x[0], &y[0], half);
+        survey.countPoints(line, &x[half], &y[half], x.size() - half);
+    }
+    else {
+        survey.addPoints(line, &x[0], &y[0], half);
+        survey.addPoints(line, &x[half], &y[half], x.size() - half);
+        survey.closeLine(line);
+    }
+}
+
+/**Adds the points of a triangle (x0, y0), (x0 + size * dx, y0), (x0, y0 + size * dy) to a line*/
+static void addTriangleOfPoints(SurveyOverlap & survey, unsigned int line, double x0, double y0, double dx, double dy, unsigned int size) {
+    std::vector<double> x, y;
+
+    for (unsigned int i = 0; i <= size; i++) {
+        for (unsigned int j = 0; i + j <= size; j++) {
+            x.push_back(x0 + i * dx);
+            y.push_back(y0 + j * dy);
+        }
+    }
+
+    survey.addPoints(line, &x[0], &y[0], x.size());
+}
+
+TEST_CASE("Survey overlap finds the overlapping pairs of lines") {
+    unsigned int nbThreads[] = {1, 3};
+
+    for (unsigned int t = 0; t < 2; t++) {
+        SurveyOverlap survey(nbThreads[t]);
+
+        //projected coordinates, far from the origin
+        survey.setOrigin(300000, 5000000);
+
+        unsigned int a = survey.addLine("a");
+        unsigned int b = survey.addLine("b");
+        unsigned int c = survey.addLine("c");
+        unsigned int d = survey.addLine("d");
+        unsigned int e = survey.addLine("e");
+
+        //b overlaps the upper half of a, c is far away
+        addGridOfPoints(survey, a, 300000.5, 5000000.5, 100, 20, false);
+        addGridOfPoints(survey, b, 300000.25, 5000010.25, 100, 20, false);
+        addGridOfPoints(survey, c, 301000, 5000000, 50, 50, false);
+
+        //d and e have overlapping bounding boxes, but their hulls are apart
+        addTriangleOfPoints(survey, d, 302000, 5000000, 1, 1, 100);
+        addTriangleOfPoints(survey, e, 302100, 5000100, -1, -1, 40);
+
+        survey.findOverlaps();
+
+        REQUIRE(survey.getNumberOfLines() == 5);
+        REQUIRE(survey.getNumberOfPoints(a) == 2000);
+        REQUIRE(survey.getHullArea(a) == Approx(99 * 19));
+        REQUIRE(survey.getNumberOfCandidatePairs() == 2);
+        REQUIRE(survey.getOverlaps().size() == 1);
+        REQUIRE(survey.hasOverlap(a));
+        REQUIRE_FALSE(survey.hasOverlap(c));
+        REQUIRE_FALSE(survey.hasOverlap(d));
+
+        addGridOfPoints(survey, a, 300000.5, 5000000.5, 100, 20, true);
+        addGridOfPoints(survey, b, 300000.25, 5000010.25, 100, 20, true);
+
+        const LineOverlap & overlap = survey.getOverlaps()[0];
+        REQUIRE(overlap.line1 == a);
+        REQUIRE(overlap.line2 == b);
+        REQUIRE(overlap.area == Approx(98.75 * 9.25));
+
+        //a: columns 1 to 99 of its 10 upper rows are strictly inside the hull of b, and the reverse
+        REQUIRE(overlap.nbPoints1 == 990);
+        REQUIRE(overlap.nbPoints2 == 990);
+
+        std::ostringstream report;
+        survey.writeReport(report);
+        REQUIRE(report.str() == "a b 913.438 990 990\n");
+    }
+}
+
+TEST_CASE("Survey overlap of lines of three points given clockwise") {
+    SurveyOverlap survey(1);
+
+    unsigned int a = survey.addLine("a");
+    unsigned int b = survey.addLine("b");
+
+    double ax[] = {0, 0, 10};
+    double ay[] = {0, 10, 0};
+    double bx[] = {0, 0, 10};
+    double by[] = {0, 10, 10};
+
+    survey.addPoints(a, ax, ay, 3);
+    survey.closeLine(a);
+    survey.addPoints(b, bx, by, 3);
+    survey.closeLine(b);
+
+    survey.findOverlaps();
+
+    REQUIRE(survey.getHullArea(a) == Approx(50));
+    REQUIRE(survey.getOverlaps().size() == 1);
+    REQUIRE(survey.getOverlaps()[0].area == Approx(25));
+}
+
+#endif /* SURVEYOVERLAPTEST_HPP */
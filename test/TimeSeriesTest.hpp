@@ -0,0 +1,148 @@
+/*
+ * Copyright 2020 © Centre Interdisciplinaire de développement en Cartographie des Océans (CIDCO), Tous droits réservés
+ */
+
+/*
+ * File:   TimeSeriesTest.hpp
+ */
+
+#ifndef TIMESERIESTEST_HPP
+#define TIMESERIESTEST_HPP
+
+#include "catch.hpp"
+#include <cstdlib>
+#include <vector>
+#include <algorithm>
+#include "../src/Position.hpp"
+#include "../src/utils/TimeSeries.hpp"
+#include "../src/utils/TimestampSort.hpp"
+
+/**Index of the last position before a timestamp, 0 if there is none, by walking the series*/
+static unsigned int lastPositionBefore(TimeSeries<Position> & series, uint64_t timestamp) {
+    unsigned int index = 0;
+
+    while (index + 1 < series.size() && series[index + 1].getTimestamp() < timestamp) {
+        index++;
+    }
+
+    return index;
+}
+
+TEST_CASE("Time series lookups find the last sample before a timestamp") {
+    srand(7);
+
+    TimeSeries<Position> series;
+
+    //irregular timestamps, added out of order, with a few duplicates
+    for (unsigned int i = 0; i < 500; i++) {
+        uint64_t timestamp = 1000 + (rand() % 100000);
+        series.push_back(Position(timestamp, 45, -70, i));
+
+        if (i % 50 == 0) {
+            series.push_back(Position(timestamp, 45, -70, i));
+        }
+    }
+
+    series.sort();
+    REQUIRE(series.size() == 510);
+
+    for (unsigned int i = 1; i < series.size(); i++) {
+        REQUIRE(series.getTimestamp(i - 1) <= series.getTimestamp(i));
+    }
+
+    //increasing timestamps, with small and large steps
+    for (uint64_t timestamp = 0; timestamp < 102000; timestamp += 1 + (rand() % 2000)) {
+        REQUIRE(series.seek(timestamp) == lastPositionBefore(series, timestamp));
+    }
+
+    //random timestamps, and sample timestamps
+    for (unsigned int i = 0; i < 2000; i++) {
+        uint64_t timestamp = (i % 2) ? rand() % 102000 : series.getTimestamp(rand() % series.size());
+        unsigned int expected = lastPositionBefore(series, timestamp);
+
+        REQUIRE(series.find(timestamp) == expected);
+        REQUIRE(series.seek(timestamp) == expected);
+    }
+}
+
+TEST_CASE("Time series brackets a timestamp for interpolation") {
+    TimeSeries<Position> series;
+    Position * before;
+    Position * after;
+
+    REQUIRE_FALSE(series.getBracket(10, before, after));
+
+    series.push_back(Position(100, 0, 0, 0));
+    REQUIRE_FALSE(series.getBracket(100, before, after));
+
+    series.push_back(Position(200, 0, 0, 1));
+    series.push_back(Position(300, 0, 0, 2));
+
+    REQUIRE_FALSE(series.getBracket(99, before, after));
+    REQUIRE_FALSE(series.getBracket(301, before, after));
+
+    REQUIRE(series.getBracket(100, before, after));
+    REQUIRE(before->getTimestamp() == 100);
+    REQUIRE(after->getTimestamp() == 200);
+
+    REQUIRE(series.getBracket(250, before, after));
+    REQUIRE(before->getTimestamp() == 200);
+    REQUIRE(after->getTimestamp() == 300);
+
+    REQUIRE(series.getBracket(300, before, after));
+    REQUIRE(before->getTimestamp() == 200);
+
+    //backward
+    REQUIRE(series.getBracket(150, before, after));
+    REQUIRE(before->getTimestamp() == 100);
+}
+
+TEST_CASE("Timestamp sort is stable for sorted, nearly sorted and shuffled samples") {
+    srand(11);
+
+    //sorted, two runs, many runs, and random
+    unsigned int nbRuns[] = {1, 2, 16, 17, 0};
+
+    for (unsigned int test = 0; test < 5; test++) {
+        std::vector<Position> positions;
+
+        for (unsigned int i = 0; i < 20000; i++) {
+            uint64_t timestamp;
+
+            if (nbRuns[test] == 0) {
+                timestamp = ((uint64_t) rand() << 20) + rand() % 1000;
+            }
+            else {
+                //runs overlapping in time, with repeated timestamps
+                unsigned int run = i * nbRuns[test] / 20000;
+                timestamp = 1600000000000000ULL + (i - run * 20000 / nbRuns[test]) / 2 * 1000 + run * 300;
+            }
+
+            //the height keeps the original order
+            positions.push_back(Position(timestamp, 0, 0, i));
+        }
+
+        std::vector<Position> expected(positions);
+        std::stable_sort(expected.begin(), expected.end(), [](Position p1, Position p2) {
+            return p1.getTimestamp() < p2.getTimestamp();
+        });
+
+        std::vector<uint64_t> timestamps;
+
+        for (auto i = positions.begin(); i != positions.end(); i++) {
+            timestamps.push_back(i->getTimestamp());
+        }
+
+        std::vector<unsigned int> order;
+        REQUIRE(TimestampSort::getOrder(timestamps, order) == (nbRuns[test] != 1));
+
+        TimestampSort::sort(positions);
+
+        for (unsigned int i = 0; i < positions.size(); i++) {
+            REQUIRE(positions[i].getTimestamp() == expected[i].getTimestamp());
+            REQUIRE(positions[i].getEllipsoidalHeight() == expected[i].getEllipsoidalHeight());
+        }
+    }
+}
+
+#endif /* TIMESERIESTEST_HPP */
@@ -0,0 +1,55 @@
+/*
+ * Copyright 2020 © Centre Interdisciplinaire de développement en Cartographie des Océans (CIDCO), Tous droits réservés
+ */
+
+/*
+ * File:   WorkerPoolTest.hpp
+ */
+
+#ifndef WORKERPOOLTEST_HPP
+#define WORKERPOOLTEST_HPP
+
+#include "catch.hpp"
+#include <vector>
+#include <thread>
+#include "../src/utils/WorkerPool.hpp"
+
+TEST_CASE("A worker pool runs every share of many jobs on its own threads") {
+    WorkerPool pool(4);
+
+    REQUIRE(pool.getNumberOfThreads() == 4);
+
+    std::vector<unsigned int> runs(4, 0);
+    std::vector<std::thread::id> threads(4);
+
+    for (unsigned int job = 0; job < 100; job++) {
+        //fewer shares than threads leaves the others idle
+        unsigned int nbShares = 1 + job % 4;
+
+        pool.run(nbShares, [&runs, &threads](unsigned int share) {
+            runs[share]++;
+            threads[share] = std::this_thread::get_id();
+        });
+    }
+
+    REQUIRE(runs[0] == 100);
+    REQUIRE(runs[1] == 75);
+    REQUIRE(runs[2] == 50);
+    REQUIRE(runs[3] == 25);
+
+    //the calling thread takes the first share
+    REQUIRE(threads[0] == std::this_thread::get_id());
+    REQUIRE(threads[1] != threads[0]);
+
+    //shares beyond the number of threads are dropped
+    unsigned int nbRuns = 0;
+    pool.run(10, [&nbRuns](unsigned int share) {
+        if (share == 0) nbRuns++;
+    });
+    REQUIRE(nbRuns == 1);
+
+    WorkerPool every(0);
+    REQUIRE(every.getNumberOfThreads() >= 1);
+}
+
+#endif /* WORKERPOOLTEST_HPP */
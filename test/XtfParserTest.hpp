@@ -124,4 +124,77 @@ TEST_CASE ("test the XTF parser with a valid datagram")
         excep = error->what();
         REQUIRE(false);
     }
-}
\ No newline at end of file
+}
+TEST_CASE("test the XTF sidescan sample decoders")
+{
+    SidescanPing ping;
+
+    uint8_t bytes[] = {0, 127, 255};
+    XtfSampleDecoders::getDecoder(8, 1)(bytes, 3, ping);
+    REQUIRE(ping.getSampleType() == SAMPLE_UINT8);
+    REQUIRE(ping.getSample(0) == 0);
+    REQUIRE(ping.getSample(1) == 127);
+    REQUIRE(ping.getSample(2) == 255);
+
+    uint16_t shorts[] = {1, 1000, 65535};
+    XtfSampleDecoders::getDecoder(0, 2)(shorts, 3, ping);
+    REQUIRE(ping.getSampleType() == SAMPLE_UINT16);
+    REQUIRE(ping.getSample(2) == 65535);
+    XtfSampleDecoders::getDecoder(3, 2)(shorts, 3, ping);
+    REQUIRE(ping.getSample(1) == 1000);
+
+    uint32_t ints[] = {0, 70000, 4000000000u};
+    XtfSampleDecoders::getDecoder(2, 4)(ints, 3, ping);
+    REQUIRE(ping.getSampleType() == SAMPLE_UINT32);
+    REQUIRE(ping.getSample(2) == 4000000000.0);
+
+    float floats[] = {-1.5f, 0.25f, 1e6f};
+    XtfSampleDecoders::getDecoder(5, 4)(floats, 3, ping);
+    REQUIRE(ping.getSampleType() == SAMPLE_FLOAT);
+    REQUIRE(ping.getSample(0) == -1.5);
+    REQUIRE(ping.getSample(2) == 1e6);
+
+    //IBM floats
+    uint32_t ibm[] = {0x42640000, 0xC276A000, 0x00000000};
+    XtfSampleDecoders::getDecoder(1, 4)(ibm, 3, ping);
+    REQUIRE(ping.getSampleType() == SAMPLE_FLOAT);
+    REQUIRE(ping.getSample(0) == 100.0);
+    REQUIRE(ping.getSample(1) == -118.625);
+    REQUIRE(ping.getSample(2) == 0.0);
+    REQUIRE(XtfSampleDecoders::ibmFloatToDouble(0x42640000) == 100.0);
+
+    //unsupported formats
+    REQUIRE(XtfSampleDecoders::getDecoder(0, 3) == NULL);
+    REQUIRE(XtfSampleDecoders::getDecoder(4, 4) == NULL);
+}
+
+TEST_CASE("test that XTF sidescan samples keep their native width")
+{
+    class SampleCounter : public DatagramEventHandler {
+    public:
+        void processSidescanData(SidescanPing * ping) {
+            nbSamples += ping->getNumberOfSamples();
+            memory += ping->getSamplesMemory();
+
+            if (ping->getSampleType() == SAMPLE_DOUBLE) {
+                nbDoublePings++;
+            }
+
+            delete ping;
+        }
+
+        unsigned long nbSamples = 0;
+        unsigned long memory = 0;
+        unsigned int nbDoublePings = 0;
+    };
+
+    SampleCounter counter;
+    XtfParser parser(counter);
+    std::string file("test/data/xtf/plane-sidescan2d.xtf");
+    parser.parse(file);
+
+    REQUIRE(counter.nbSamples > 0);
+    REQUIRE(counter.nbDoublePings == 0);
+    //16 bit samples: a quarter of the memory doubles would take
+    REQUIRE(counter.memory <= counter.nbSamples * sizeof (double) / 4);
+}
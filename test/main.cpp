@@ -28,4 +28,17 @@
 #include "BoundingBoxTest.hpp"
 #include "RayTracerAppTest.hpp"
 #include "VerticalHorizontalRayTracingBiais.hpp"
+#include "ArenaTest.hpp"
 
+#include "SidescanMosaicTest.hpp"
+#include "SlantRangeCorrectionTest.hpp"
+#include "DtmGridTest.hpp"
+#include "PointTextTest.hpp"
+#include "PointFilterTest.hpp"
+#include "HullGridTest.hpp"
+#include "SurveyOverlapTest.hpp"
+#include "AttitudeSeriesTest.hpp"
+#include "TimeSeriesTest.hpp"
+#include "InputStreamTest.hpp"
+#include "StatsTest.hpp"
+#include "WorkerPoolTest.hpp"